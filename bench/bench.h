@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "world.h"
+
+// общие помощники для замеров
+
+class BenchTimer {
+private:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// все замеры прогона; пишется в JSON, чтобы сравнивать версии между собой
+class BenchReport {
+public:
+    struct Result {
+        std::string group;    // factory, fight, observer, ...
+        std::string name;     // вариант внутри группы
+        size_t npcs;          // размер мира
+        size_t items;         // сколько операций (NPC, пар, событий) в замере
+        double seconds;
+    };
+
+    void add(std::string group, std::string name, size_t npcs, size_t items, double seconds) {
+        results.push_back({std::move(group), std::move(name), npcs, items, seconds});
+    }
+
+    // meta - пары ключ/значение верхнего уровня (seed, simd, ...), значения строками
+    bool writeJson(const std::string& file_name, const std::vector<std::pair<std::string, std::string>>& meta) const {
+        std::ofstream file(file_name);
+        if (!file.is_open()) return false;
+        file << "{\n";
+        for (const auto& [key, value] : meta) {
+            file << "  \"" << key << "\": \"" << value << "\",\n";
+        }
+        file << "  \"results\": [";
+        char line[512];
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            double rate = r.seconds > 0 ? r.items / r.seconds : 0;
+            std::snprintf(line, sizeof(line),
+                          "%s\n    {\"group\": \"%s\", \"name\": \"%s\", \"npcs\": %zu, \"items\": %zu, "
+                          "\"seconds\": %.6f, \"items_per_second\": %.1f}",
+                          i ? "," : "", r.group.c_str(), r.name.c_str(), r.npcs, r.items, r.seconds, rate);
+            file << line;
+        }
+        file << "\n  ]\n}\n";
+        return static_cast<bool>(file);
+    }
+
+private:
+    std::vector<Result> results;
+};
+
+// глушит std::cout на время замера: "Saved/Loaded N NPC" у saveNPC/loadNPC и строки
+// TextObserver. Бой сам ничего не печатает - только через FightTrace, а он в замерах выключен
+class SilenceCout {
+private:
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    NullBuffer null;
+    std::streambuf* old;
+
+public:
+    SilenceCout() : old(std::cout.rdbuf(&null)) {}
+    ~SilenceCout() { std::cout.rdbuf(old); }
+};
+
+// детерминированный мир: те же seed и размер - те же NPC
+inline set_t makeBenchWorld(size_t count, unsigned seed) {
+    set_t world;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> rnd_type(0, 2);
+    std::uniform_int_distribution<> rnd_coord(0, 500);
+    static const char* names[] = {"Toad", "Dragon", "Knight"};
+    for (size_t i = 0; i < count; ++i) {
+        int t = rnd_type(gen);
+        int x = rnd_coord(gen);
+        int y = rnd_coord(gen);
+        world.insert(createNPC(static_cast<NpcType>(t), generateName(names[t], static_cast<int>(i)), x, y));
+    }
+    return world;
+}
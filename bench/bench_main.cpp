@@ -0,0 +1,705 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "battle.h"
+#include "factory.h"
+#include "npcArena.h"
+#include "observer.h"
+#include "npcWorld.h"
+#include "rangeKernel.h"
+#include "rangeSweep.h"
+#include "simulation.h"
+#include "variantWorld.h"
+#include "worldFile.h"
+#include "worldGenerator.h"
+#include "worldJournal.h"
+#include "worldSnapshot.h"
+#include "world.h"
+
+// все миры строятся от одного seed: те же параметры - те же NPC и те же убитые
+static unsigned benchSeed = 42;
+
+// раунд fight() на сетке против полного перебора, от 1k до 1M NPC
+static void benchFightScaling(BenchReport& report, size_t maxCount, size_t bruteLimit) {
+    const size_t range = 20;
+    std::printf("%-10s %-14s %-14s %-8s\n", "npcs", "grid, s", "brute, s", "killed");
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        set_t world = makeBenchWorld(count, benchSeed);
+        double gridTime;
+        size_t killed;
+        {
+            BenchTimer timer;
+            killed = fight(world, range).size();
+            gridTime = timer.seconds();
+        }
+        report.add("fight_scaling", "grid", count, count, gridTime);
+
+        if (count <= bruteLimit) {
+            set_t copy = makeBenchWorld(count, benchSeed);
+            BenchTimer timer;
+            fightBruteForce(copy, range);
+            double bruteTime = timer.seconds();
+            report.add("fight_scaling", "brute_force", count, count, bruteTime);
+            std::printf("%-10zu %-14.4f %-14.4f %-8zu\n", count, gridTime, bruteTime, killed);
+        } else {
+            std::printf("%-10zu %-14.4f %-14s %-8zu\n", count, gridTime, "-", killed);
+        }
+        std::fflush(stdout);
+    }
+}
+
+// тот же раунд на структуре массивов NpcWorld и на значениях VariantWorld
+static void benchNpcWorld(BenchReport& report, size_t maxCount) {
+    const size_t range = 20;
+    std::printf("%-10s %-14s %-14s %-14s %-8s\n", "npcs", "set_t, s", "NpcWorld, s", "variant, s", "B/npc");
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        set_t npcs = makeBenchWorld(count, benchSeed);
+        NpcWorld world = NpcWorld::fromSet(npcs);
+        VariantWorld values = VariantWorld::fromSet(npcs);
+
+        double setTime;
+        {
+            BenchTimer timer;
+            fight(npcs, range);
+            setTime = timer.seconds();
+        }
+        BenchTimer timer;
+        fight(world, range);
+        double worldTime = timer.seconds();
+        BenchTimer variantTimer;
+        fight(values, range);
+        double variantTime = variantTimer.seconds();
+        report.add("npc_world", "set_t", count, count, setTime);
+        report.add("npc_world", "NpcWorld", count, count, worldTime);
+        report.add("npc_world", "VariantWorld", count, count, variantTime);
+
+        std::printf("%-10zu %-14.4f %-14.4f %-14.4f %-8.1f\n", count, setTime, worldTime, variantTime,
+                    static_cast<double>(world.memoryUsage()) / count);
+        std::fflush(stdout);
+    }
+}
+
+// один нападающий против блока защитников: NPC::distance против rangeMask
+static void benchRangeKernel(BenchReport& report) {
+    const size_t count = 1 << 16;
+    const int rounds = 200;
+    const size_t range = 50;
+    set_t npcs = makeBenchWorld(count, benchSeed);
+    std::vector<std::shared_ptr<NPC>> objects(npcs.begin(), npcs.end());
+    std::vector<int> xs, ys;
+    for (const auto& n : objects) {
+        xs.push_back(n->getX());
+        ys.push_back(n->getY());
+    }
+    std::vector<uint8_t> mask(count);
+    const double pairs = static_cast<double>(count) * rounds;
+
+    size_t hits = 0;
+    BenchTimer timer;
+    for (int r = 0; r < rounds; ++r) {
+        const auto& attacker = objects[static_cast<size_t>(r)];
+        for (const auto& defender : objects) {
+            hits += attacker->distance(defender) <= range;
+        }
+    }
+    double seconds = timer.seconds();
+    std::printf("%-16s %10.1f Mpairs/s  (hits %zu)\n", "NPC::distance", pairs / seconds / 1e6, hits);
+    report.add("distance", "NPC::distance", count, static_cast<size_t>(pairs), seconds);
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (!simdLevelSupported(level)) continue;
+        hits = 0;
+        BenchTimer levelTimer;
+        for (int r = 0; r < rounds; ++r) {
+            hits += rangeMask(level, xs[static_cast<size_t>(r)], ys[static_cast<size_t>(r)], xs.data(), ys.data(),
+                              count, static_cast<long long>(range * range), mask.data());
+        }
+        seconds = levelTimer.seconds();
+        std::printf("%-16s %10.1f Mpairs/s  (hits %zu)\n", simdLevelName(level), pairs / seconds / 1e6, hits);
+        report.add("distance", std::string("rangeMask_") + simdLevelName(level), count, static_cast<size_t>(pairs), seconds);
+    }
+}
+
+// параллельный двухфазный раунд на 1..32 потоках (не больше числа ядер)
+static void benchParallelBattle(BenchReport& report, size_t count, size_t maxThreads) {
+    const size_t range = 20;
+    NpcWorld base = NpcWorld::fromSet(makeBenchWorld(count, benchSeed));
+    // наблюдатель почти бесплатный - видна стоимость доставки событий через очередь
+    class CountingObserver : public IFFightObserver {
+    public:
+        size_t events = 0;
+        void onFight(const std::shared_ptr<NPC>&, const std::shared_ptr<NPC>&, bool) override { ++events; }
+    };
+    std::printf("%-10s %-14s %-10s %-8s %-14s %-10s\n", "threads", "round, s", "speedup", "killed", "observed, s", "events");
+
+    double single = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        NpcWorld world = base;
+        Battle battle(BattleOptions{BattleMode::Parallel, threads});
+        BenchTimer timer;
+        size_t killed = battle.round(world, range).size();
+        double seconds = timer.seconds();
+        if (threads == 1) single = seconds;
+
+        NpcWorld observedWorld = base;
+        auto observer = std::make_shared<CountingObserver>();
+        BenchTimer observedTimer;
+        battle.round(observedWorld, range, observer);
+        double observed = observedTimer.seconds();
+
+        report.add("parallel_battle", "threads_" + std::to_string(threads), count, count, seconds);
+        report.add("parallel_battle", "observed_threads_" + std::to_string(threads), count, observer->events, observed);
+        std::printf("%-10zu %-14.4f %-10.2f %-8zu %-14.4f %-10zu\n", threads, seconds, single / seconds, killed, observed,
+                    observer->events);
+        std::fflush(stdout);
+    }
+}
+
+// текстовый формат против двоичного
+static void benchSaveLoad(BenchReport& report, size_t count, size_t maxThreads) {
+    NpcWorld world = NpcWorld::fromSet(makeBenchWorld(count, benchSeed));
+    const std::string text = "bench_world.txt";
+    const std::string binary = "bench_world.bin";
+    double saveText, loadLegacy, loadText, saveBinary, loadBinary;
+    {
+        SilenceCout silence;
+        BenchTimer timer;
+        saveNPC(world, text);
+        saveText = timer.seconds();
+    }
+    {
+        // прежний загрузчик: getline + istringstream на каждую строку
+        NpcWorld loaded;
+        BenchTimer timer;
+        std::ifstream is(text);
+        std::string line;
+        while (std::getline(is, line)) {
+            std::istringstream stream(line);
+            NpcType type;
+            std::string name;
+            int x, y;
+            if (NPCFactory::parse(stream, type, name, x, y)) loaded.add(type, name, x, y);
+        }
+        loadLegacy = timer.seconds();
+    }
+    {
+        SilenceCout silence;
+        NpcWorld loaded;
+        BenchTimer timer;
+        loadNPC(text, loaded);
+        loadText = timer.seconds();
+    }
+    {
+        BenchTimer timer;
+        WorldFile::saveBinary(world, binary);
+        saveBinary = timer.seconds();
+    }
+    {
+        BenchTimer timer;
+        NpcWorld loaded = WorldFile::loadBinary(binary);
+        loadBinary = timer.seconds();
+    }
+    // журнал: полный снимок один раз, дальше только изменения - 1000 убитых
+    double journalCompact, journalCommit, journalOpen;
+    size_t roundKills;
+    {
+        WorldJournal journal(binary);
+        BenchTimer compactTimer;
+        journal.compact(world);
+        journalCompact = compactTimer.seconds();
+
+        std::vector<size_t> killed;
+        for (size_t i = 0; i < count; i += std::max<size_t>(1, count / 1000)) killed.push_back(i);
+        roundKills = killed.size();
+        BenchTimer commitTimer;
+        journal.kill(killed);
+        journal.commit();
+        journalCommit = commitTimer.seconds();
+
+        NpcWorld recovered;
+        BenchTimer openTimer;
+        WorldJournal(binary).open(recovered);
+        journalOpen = openTimer.seconds();
+        std::remove((binary + ".journal").c_str());
+    }
+    std::vector<std::pair<size_t, TextLoadStats>> parallelLoads;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        NpcWorld loaded;
+        TextLoadStats stats;
+        WorldFile::loadTextParallel(text, loaded, pool, &stats);
+        parallelLoads.emplace_back(threads, stats);
+    }
+    std::remove(text.c_str());
+    std::remove(binary.c_str());
+    report.add("world_file", "load_istream", count, count, loadLegacy);
+    report.add("world_file", "save_text", count, count, saveText);
+    report.add("world_file", "load_text", count, count, loadText);
+    report.add("world_file", "save_binary", count, count, saveBinary);
+    report.add("world_file", "load_binary", count, count, loadBinary);
+    report.add("world_file", "journal_compact", count, count, journalCompact);
+    report.add("world_file", "journal_commit_kills", count, roundKills, journalCommit);
+    report.add("world_file", "journal_open", count, count, journalOpen);
+    for (const auto& [threads, stats] : parallelLoads) {
+        report.add("world_file", "load_text_threads_" + std::to_string(threads), count, stats.lines, stats.seconds);
+    }
+
+    std::printf("%-10s %-12s %-12s\n", "format", "save, s", "load, s");
+    std::printf("%-10s %-12s %-12.4f\n", "istream", "-", loadLegacy);
+    std::printf("%-10s %-12.4f %-12.4f\n", "text", saveText, loadText);
+    std::printf("%-10s %-12.4f %-12.4f\n", "binary", saveBinary, loadBinary);
+    std::printf("%-10s %-12.4f %-12.4f  compact %.4f s, commit of %zu kills\n", "journal", journalCommit, journalOpen,
+                journalCompact, roundKills);
+
+    std::printf("\nparallel text load\n%-8s %-10s %-12s %-10s\n", "threads", "load, s", "lines/s", "MB/s");
+    for (const auto& [threads, stats] : parallelLoads) {
+        std::printf("%-8zu %-10.4f %-12.0f %-10.1f\n", threads, stats.seconds, stats.linesPerSecond(), stats.megabytesPerSecond());
+    }
+}
+
+// NPCFactory::create в куче и в арене, NPCFactory::save в память
+static void benchFactory(BenchReport& report, size_t maxCount) {
+    std::printf("%-10s %-14s %-14s %-14s\n", "npcs", "create, s", "arena, s", "save, s");
+    static const char* names[] = {"Toad", "Dragon", "Knight"};
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        std::mt19937 gen(benchSeed);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        std::vector<std::string> npcNames(count);
+        std::vector<int> coords(count * 2);
+        for (size_t i = 0; i < count; ++i) {
+            npcNames[i] = generateName(names[i % 3], static_cast<int>(i));
+            coords[2 * i] = rnd_coord(gen);
+            coords[2 * i + 1] = rnd_coord(gen);
+        }
+
+        std::vector<std::shared_ptr<NPC>> npcs;
+        npcs.reserve(count);
+        BenchTimer heapTimer;
+        for (size_t i = 0; i < count; ++i) {
+            npcs.push_back(NPCFactory::create(static_cast<NpcType>(i % 3), npcNames[i], coords[2 * i], coords[2 * i + 1]));
+        }
+        double heapTime = heapTimer.seconds();
+
+        double arenaTime;
+        {
+            NpcArena arena;
+            std::vector<std::shared_ptr<NPC>> arenaNpcs;
+            arenaNpcs.reserve(count);
+            BenchTimer arenaTimer;
+            for (size_t i = 0; i < count; ++i) {
+                arenaNpcs.push_back(NPCFactory::create(static_cast<NpcType>(i % 3), npcNames[i], coords[2 * i], coords[2 * i + 1], arena));
+            }
+            arenaTime = arenaTimer.seconds();
+        }
+
+        std::ostringstream out;
+        BenchTimer saveTimer;
+        for (const auto& npc : npcs) {
+            NPCFactory::save(npc, out);
+        }
+        double saveTime = saveTimer.seconds();
+
+        report.add("factory", "create", count, count, heapTime);
+        report.add("factory", "create_arena", count, count, arenaTime);
+        report.add("factory", "save", count, count, saveTime);
+        std::printf("%-10zu %-14.4f %-14.4f %-14.4f\n", count, heapTime, arenaTime, saveTime);
+        std::fflush(stdout);
+    }
+}
+
+// saveNPC/loadNPC для set_t
+static void benchSetSaveLoad(BenchReport& report, size_t maxCount) {
+    const std::string file = "bench_set.txt";
+    std::printf("%-10s %-14s %-14s\n", "npcs", "saveNPC, s", "loadNPC, s");
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        set_t world = makeBenchWorld(count, benchSeed);
+        double saveTime, loadTime;
+        {
+            SilenceCout silence;
+            BenchTimer timer;
+            saveNPC(world, file);
+            saveTime = timer.seconds();
+        }
+        {
+            SilenceCout silence;
+            BenchTimer timer;
+            set_t loaded = loadNPC(file);
+            loadTime = timer.seconds();
+        }
+        report.add("set_file", "saveNPC", count, count, saveTime);
+        report.add("set_file", "loadNPC", count, count, loadTime);
+        std::printf("%-10zu %-14.4f %-14.4f\n", count, saveTime, loadTime);
+        std::fflush(stdout);
+    }
+    std::remove(file.c_str());
+}
+
+// шаги дистанции как в редакторе: 20, 35, ... 95, убитые убираются между шагами
+static void benchRangeSteps(BenchReport& report, size_t maxCount) {
+    std::printf("%-10s %-8s %-14s %-10s %-10s\n", "npcs", "range", "fight, s", "killed", "alive");
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        set_t world = makeBenchWorld(count, benchSeed);
+        for (size_t range = 20; range <= 100 && !world.empty(); range += 15) {
+            const size_t before = world.size();
+            set_t dead;
+            BenchTimer timer;
+            dead = fight(world, range);
+            double seconds = timer.seconds();
+            for (const auto& d : dead) world.erase(d);
+
+            report.add("fight_range", "range_" + std::to_string(range), count, before, seconds);
+            std::printf("%-10zu %-8zu %-14.4f %-10zu %-10zu\n", count, range, seconds, dead.size(), world.size());
+            std::fflush(stdout);
+        }
+    }
+}
+
+// все шаги дистанции: fight() на каждом шаге против одного прохода RangeSweep
+static void benchRangeSweep(BenchReport& report, size_t maxCount) {
+    const std::vector<size_t> ranges = {20, 35, 50, 65, 80, 95};
+    std::printf("%-10s %-14s %-14s %-8s\n", "npcs", "steps, s", "sweep, s", "killed");
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        NpcWorld base = NpcWorld::fromSet(makeBenchWorld(count, benchSeed));
+
+        NpcWorld world = base;
+        size_t killed = 0;
+        BenchTimer stepsTimer;
+        for (size_t range : ranges) {
+            killed += fight(world, range).size();
+        }
+        double stepsTime = stepsTimer.seconds();
+
+        BenchTimer sweepTimer;
+        RangeSweepResult sweep = RangeSweep::run(base, ranges);
+        double sweepTime = sweepTimer.seconds();
+
+        report.add("range_sweep", "fight_per_step", count, count, stepsTime);
+        report.add("range_sweep", "sweep", count, count, sweepTime);
+        std::printf("%-10zu %-14.4f %-14.4f %-8zu\n", count, stepsTime, sweepTime, killed);
+        std::fflush(stdout);
+    }
+}
+
+// один и тот же поток событий через каждого наблюдателя
+static void benchObservers(BenchReport& report, size_t events) {
+    set_t npcs = makeBenchWorld(1000, benchSeed);
+    std::vector<std::shared_ptr<NPC>> objects(npcs.begin(), npcs.end());
+    auto feed = [&](IFFightObserver& observer) {
+        for (size_t i = 0; i < events; ++i) {
+            observer.onFight(objects[i % objects.size()], objects[(i * 7 + 1) % objects.size()], i % 3 == 0);
+        }
+    };
+
+    std::printf("%-20s %-12s %-14s\n", "observer", "seconds", "events/s");
+    auto print = [&](const char* name, double seconds) {
+        report.add("observer", name, objects.size(), events, seconds);
+        std::printf("%-20s %-12.4f %-14.0f\n", name, seconds, events / seconds);
+        std::fflush(stdout);
+    };
+    {
+        TextObserver observer;
+        double seconds;
+        {
+            SilenceCout silence;
+            BenchTimer timer;
+            feed(observer);
+            seconds = timer.seconds();
+        }
+        print("TextObserver", seconds);
+    }
+    {
+        BenchTimer timer;
+        {
+            FileObserver observer("bench_observer.txt");
+            feed(observer);
+        }
+        print("FileObserver", timer.seconds());
+    }
+    {
+        // с дописыванием очереди в деструкторе - честное время до последнего байта на диске
+        BenchTimer timer;
+        {
+            AsyncFileObserver observer("bench_observer.txt");
+            feed(observer);
+        }
+        print("AsyncFileObserver", timer.seconds());
+    }
+    std::remove("bench_observer.txt");
+}
+
+// огромная разреженная карта: координаты по всему +-1e9, радиус 1e6 -
+// у нападающего в среднем около одного соседа, поиск идет через rangeMaskWide
+static void benchLargeMap(BenchReport& report, size_t maxCount, size_t maxThreads) {
+    const int far = 1000000000;
+    const WorldBounds bounds{-far, -far, far, far};
+    const size_t range = 1000000;
+    const std::string text = "bench_large.txt";
+    const std::string binary = "bench_large.bin";
+    ThreadPool pool(maxThreads);
+    std::printf("%-10s %-12s %-12s %-14s %-14s %-8s\n", "npcs", "fight, s", "battle, s", "load text, s", "load bin, s", "killed");
+    for (size_t count = 1000; count <= maxCount; count *= 10) {
+        std::mt19937 gen(benchSeed);
+        std::uniform_int_distribution<int> coord(-far, far);
+        std::uniform_int_distribution<int> kind(0, NPC_TYPE_COUNT - 1);
+        NpcWorld world(bounds);
+        world.reserve(count, count * 8);
+        for (size_t i = 0; i < count; ++i) {
+            world.add(static_cast<NpcType>(kind(gen)), "npc_" + std::to_string(i), coord(gen), coord(gen));
+        }
+        {
+            SilenceCout silence;
+            saveNPC(world, text);
+        }
+        WorldFile::saveBinary(world, binary);
+
+        NpcWorld sequential = world;
+        BenchTimer fightTimer;
+        size_t killed = fight(sequential, range).size();
+        double fightTime = fightTimer.seconds();
+
+        NpcWorld parallel = world;
+        Battle battle(BattleOptions{BattleMode::Parallel, maxThreads});
+        BenchTimer battleTimer;
+        battle.round(parallel, range);
+        double battleTime = battleTimer.seconds();
+
+        NpcWorld fromText;
+        BenchTimer textTimer;
+        WorldFile::loadTextParallel(text, fromText, pool);
+        double textTime = textTimer.seconds();
+
+        BenchTimer binaryTimer;
+        NpcWorld fromBinary = WorldFile::loadBinary(binary);
+        double binaryTime = binaryTimer.seconds();
+
+        report.add("large_map", "fight", count, count, fightTime);
+        report.add("large_map", "parallel_battle", count, count, battleTime);
+        report.add("large_map", "load_text_parallel", count, count, textTime);
+        report.add("large_map", "load_binary", count, count, binaryTime);
+        std::printf("%-10zu %-12.4f %-12.4f %-14.4f %-14.4f %-8zu\n", count, fightTime, battleTime, textTime, binaryTime, killed);
+        std::fflush(stdout);
+    }
+    std::remove(text.c_str());
+    std::remove(binary.c_str());
+}
+
+// тики Simulation: движение, поправка сетки, бой. Плотность как у 100k на карте
+// 10000x10000 - у каждого около одного соседа в радиусе, бои идут каждый тик
+// steady - одни драконы: дракон с драконом - ничья, число NPC не меняется, и
+// ticks/s - это цена тика при полном населении. mixed - три типа: мир вымирает
+// (на плотной карте половина в первом же тике), alive - сколько осталось к концу
+static void benchSimulation(BenchReport& report, size_t maxCount, size_t maxThreads) {
+    const size_t ticks = 120;
+    std::printf("%-10s %-8s %-8s %-10s %-10s %-10s %-10s %-10s %-8s %-8s\n", "npcs", "mix", "threads", "ticks/s", "move, ms",
+                "grid, ms", "fight, ms", "rebuilds", "killed", "alive");
+    for (size_t count = 10000; count <= std::min<size_t>(maxCount, 1000000); count *= 10) {
+        const int side = static_cast<int>(std::sqrt(static_cast<double>(count) * 1000.0));
+        const WorldBounds bounds{0, 0, side, side};
+        for (bool steady : {true, false}) {
+            for (size_t threads : {size_t{1}, maxThreads}) {
+                std::mt19937 gen(benchSeed);
+                std::uniform_int_distribution<int> coord(0, side);
+                std::uniform_int_distribution<int> kind(0, NPC_TYPE_COUNT - 1);
+                NpcWorld world(bounds);
+                world.reserve(count, count * 8);
+                for (size_t i = 0; i < count; ++i) {
+                    NpcType type = steady ? NpcType::Dragon : static_cast<NpcType>(kind(gen));
+                    world.add(type, "npc_" + std::to_string(i), coord(gen), coord(gen));
+                }
+                SimulationOptions options;
+                options.threads = threads;
+                options.seed = benchSeed;
+                Simulation simulation(world, options);
+                simulation.run(ticks);
+                const SimulationStats& stats = simulation.getStats();
+                const char* mix = steady ? "steady" : "mixed";
+                const std::string variant = std::string(mix) + "_threads_" + std::to_string(threads);
+                report.add("simulation", variant, count, ticks, stats.seconds());
+                std::printf("%-10zu %-8s %-8zu %-10.1f %-10.3f %-10.3f %-10.3f %-10llu %-8llu %-8zu\n", count, mix, threads,
+                            stats.ticksPerSecond(), stats.moveSeconds * 1000 / ticks, stats.gridSeconds * 1000 / ticks,
+                            stats.fightSeconds * 1000 / ticks, static_cast<unsigned long long>(stats.gridRebuilds),
+                            static_cast<unsigned long long>(stats.kills), world.aliveCount());
+                std::fflush(stdout);
+                if (threads == maxThreads) break;
+            }
+        }
+    }
+}
+
+// что-если по снимкам: бой на нескольких дистанциях с откатом к началу против
+// прежнего пути через текстовый файл. Снимки делят неизмененные куски
+static void benchSnapshots(BenchReport& report, size_t count) {
+    NpcWorld world = NpcWorld::fromSet(makeBenchWorld(count, benchSeed));
+    const std::string text = "bench_snapshot.txt";
+
+    BenchTimer firstTimer;
+    WorldSnapshot start = world.snapshot();
+    double first = firstTimer.seconds();
+
+    BenchTimer sameTimer;
+    WorldSnapshot unchanged = world.snapshot();
+    double same = sameTimer.seconds();
+
+    world.move(0, world.getX(0), world.getY(0));
+    BenchTimer moveTimer;
+    WorldSnapshot moved = world.snapshot();
+    double oneMove = moveTimer.seconds();
+
+    double textRoundTrip;
+    {
+        SilenceCout silence;
+        BenchTimer timer;
+        saveNPC(world, text);
+        NpcWorld loaded;
+        loadNPC(text, loaded);
+        textRoundTrip = timer.seconds();
+    }
+    std::remove(text.c_str());
+
+    std::printf("%-22s %-12s %-14s\n", "operation", "time, s", "new memory, KB");
+    std::printf("%-22s %-12.6f %-14.1f\n", "first snapshot", first, start.memoryUsage() / 1024.0);
+    std::printf("%-22s %-12.6f %-14.1f\n", "snapshot, no changes", same, unchanged.changedBytes(start) / 1024.0);
+    std::printf("%-22s %-12.6f %-14.1f\n", "snapshot, one move", oneMove, moved.changedBytes(unchanged) / 1024.0);
+    std::printf("%-22s %-12.6f %-14s\n", "text save+load", textRoundTrip, "-");
+    report.add("snapshot", "first", count, count, first);
+    report.add("snapshot", "unchanged", count, count, same);
+    report.add("snapshot", "one_move", count, 1, oneMove);
+    report.add("snapshot", "text_round_trip", count, count, textRoundTrip);
+
+    for (size_t range : {5, 20, 50}) {
+        world.restore(moved);
+        BenchTimer fightTimer;
+        size_t killed = fight(world, range).size();
+        double fightTime = fightTimer.seconds();
+        BenchTimer snapshotTimer;
+        WorldSnapshot after = world.snapshot();
+        double snapshotTime = snapshotTimer.seconds();
+        BenchTimer restoreTimer;
+        world.restore(moved);
+        double restoreTime = restoreTimer.seconds();
+        std::printf("range %-3zu killed %-8zu fight %.4f s, snapshot %.6f s (+%.1f KB), restore %.6f s\n", range, killed,
+                    fightTime, snapshotTime, after.changedBytes(moved) / 1024.0, restoreTime);
+        report.add("snapshot", "after_fight_range_" + std::to_string(range), count, count, snapshotTime);
+        report.add("snapshot", "restore_range_" + std::to_string(range), count, count, restoreTime);
+    }
+}
+
+static void benchGenerator(BenchReport& report, size_t count, size_t maxThreads) {
+    const std::string text = "bench_generated.txt";
+    // старый путь - по одному объекту NPC на set_t, для сравнения не больше 1M
+    const size_t legacyCount = std::min<size_t>(count, 1000000);
+    BenchTimer legacyTimer;
+    NpcWorld legacy = NpcWorld::fromSet(makeBenchWorld(legacyCount, benchSeed));
+    double legacyTime = legacyTimer.seconds();
+    std::printf("makeBenchWorld + fromSet, %zu NPC: %.3f s (%.0f NPC/s)\n", legacyCount, legacyTime,
+                legacyCount / legacyTime);
+    report.add("generator", "make_bench_world", legacyCount, legacyCount, legacyTime);
+
+    std::printf("%-12s %-8s %-12s %-14s %-12s\n", "layout", "threads", "world, s", "NPC/s", "file, s");
+    const std::pair<SpawnLayout, const char*> layouts[] = {
+        {SpawnLayout::Uniform, "uniform"}, {SpawnLayout::Clustered, "clustered"}, {SpawnLayout::SingleCell, "single_cell"}};
+    for (const auto& [layout, name] : layouts) {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            WorldGeneratorOptions options;
+            options.count = count;
+            options.seed = benchSeed;
+            options.layout = layout;
+            options.threads = threads;
+            options.bounds = WorldBounds{0, 0, 99999, 99999};
+            WorldGenerator generator(options);
+
+            BenchTimer worldTimer;
+            NpcWorld world = generator.generate();
+            double worldTime = worldTimer.seconds();
+            BenchTimer fileTimer;
+            generator.generateToFile(text);
+            double fileTime = fileTimer.seconds();
+
+            std::printf("%-12s %-8zu %-12.3f %-14.0f %-12.3f\n", name, threads, worldTime, count / worldTime, fileTime);
+            report.add("generator", std::string(name) + "_world_threads_" + std::to_string(threads), count, count, worldTime);
+            report.add("generator", std::string(name) + "_file_threads_" + std::to_string(threads), count, count, fileTime);
+        }
+    }
+    std::remove(text.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxCount = 1000000;
+    size_t bruteLimit = 10000;
+    size_t maxThreads = std::min<size_t>(32, std::max(1u, std::thread::hardware_concurrency()));
+    size_t observerEvents = 200000;
+    size_t generatedCount = 10000000;
+    std::string jsonFile = "bench_results.json";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--max") == 0) maxCount = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::strcmp(argv[i], "--brute-max") == 0) bruteLimit = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::strcmp(argv[i], "--threads") == 0) maxThreads = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::strcmp(argv[i], "--seed") == 0) benchSeed = static_cast<unsigned>(std::strtoul(argv[i + 1], nullptr, 10));
+        if (std::strcmp(argv[i], "--events") == 0) observerEvents = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::strcmp(argv[i], "--generate") == 0) generatedCount = std::strtoull(argv[i + 1], nullptr, 10);
+        if (std::strcmp(argv[i], "--json") == 0) jsonFile = argv[i + 1];
+    }
+
+    BenchReport report;
+    std::printf("NPCFactory create/save\n");
+    benchFactory(report, maxCount);
+    std::printf("\nsaveNPC/loadNPC, set_t\n");
+    benchSetSaveLoad(report, maxCount);
+    std::printf("\nfight() scaling, range 20\n");
+    benchFightScaling(report, maxCount, bruteLimit);
+    std::printf("\nfight() range steps\n");
+    benchRangeSteps(report, maxCount);
+    std::printf("\nall range steps, NpcWorld\n");
+    benchRangeSweep(report, maxCount);
+    std::printf("\nset_t vs NpcWorld vs VariantWorld, range 20\n");
+    benchNpcWorld(report, maxCount);
+    std::printf("\nrange test kernel, 64k defenders, range 50\n");
+    benchRangeKernel(report);
+    std::printf("\nobservers, %zu events\n", observerEvents);
+    benchObservers(report, observerEvents);
+    std::printf("\nsave/load, %zu NPC\n", maxCount);
+    benchSaveLoad(report, maxCount, maxThreads);
+
+    std::printf("\nsnapshots, %zu NPC\n", maxCount);
+    benchSnapshots(report, maxCount);
+
+    std::printf("\nlarge sparse map +-1e9, range 1e6\n");
+    benchLargeMap(report, maxCount, maxThreads);
+
+    std::printf("\nworld generator, %zu NPC, map 0-99999\n", generatedCount);
+    benchGenerator(report, generatedCount, maxThreads);
+
+    std::printf("\nsimulation ticks, range 20, %zu ticks\n", size_t{120});
+    benchSimulation(report, maxCount, maxThreads);
+
+    // одновременные удары проверяют все пары в радиусе, 1M на плотной карте - минуты
+    size_t parallelCount = std::min<size_t>(maxCount, 100000);
+    std::printf("\nparallel battle round, %zu NPC, range 20\n", parallelCount);
+    benchParallelBattle(report, parallelCount, maxThreads);
+
+    std::vector<std::pair<std::string, std::string>> meta = {
+        {"benchmark", "dungeon_bench"},
+        {"seed", std::to_string(benchSeed)},
+        {"max_npcs", std::to_string(maxCount)},
+        {"simd", simdLevelName(detectSimdLevel())},
+        {"threads", std::to_string(maxThreads)},
+    };
+    if (!report.writeJson(jsonFile, meta)) {
+        std::fprintf(stderr, "can't write %s\n", jsonFile.c_str());
+        return 1;
+    }
+    std::printf("\nresults: %s\n", jsonFile.c_str());
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "fightEventQueue.h"
+#include "npcWorld.h"
+#include "observer.h"
+#include "spatialGrid.h"
+#include "threadPool.h"
+
+enum class BattleMode {
+    // как fight(NpcWorld&): нападающие по порядку индексов, убитый сразу выбывает
+    Sequential,
+    // два этапа: все живые на начало раунда нападают одновременно, потом фиксация
+    Parallel
+};
+
+struct BattleOptions {
+    BattleMode mode = BattleMode::Parallel;
+    size_t threads = 0;          // 0 - по числу ядер
+    size_t chunkSize = 1024;     // нападающих на одну задачу пула
+};
+
+// Раунд боя с переиспользуемыми буферами и пулом потоков.
+//
+// Parallel: этап 1 - потоки разбирают куски нападающих и публикуют предложенные бои
+// в FightEventQueue, кусок - отдельный поток событий; состояние мира не меняется, все
+// живые на начало раунда и нападают, и защищаются. Этап 2 идет одновременно в одном
+// потоке-читателе: события фиксируются в порядке кусков, т.е. по возрастанию индекса
+// нападающего, и только он вызывает наблюдателя - тому не нужна потокобезопасность.
+// Защитник гибнет от первого победившего нападающего с наименьшим индексом, бои с уже
+// убитым защитником пропускаются.
+// Результат и порядок событий наблюдателя не зависят от числа потоков.
+// Отличие от Sequential: нападающий, убитый в этом же раунде, все равно успевает ударить.
+// Без наблюдателя и без FightTrace бои не записываются, этап 1 только отмечает убитых
+// флагами. Трассу, как и наблюдателя, вызывает только читатель, в том же порядке.
+// Исключение наблюдателя прерывает раунд, как в Sequential: убитые до него
+// остаются убитыми, само исключение выходит из round()
+class Battle {
+private:
+    BattleOptions options;
+    std::unique_ptr<ThreadPool> pool;
+    SpatialGrid grid;
+    std::vector<std::atomic<uint8_t>> doomed;      // убитые за раунд, в мир переносятся в конце
+    FightEventQueue events;                        // бои этапа 1 для наблюдателя
+    FightEventSequencer sequencer;
+
+    void parallelRound(NpcWorld& world, size_t range, std::vector<size_t>& killed, const std::shared_ptr<IFFightObserver>& observer);
+    // этапы 1 и 2 с фиксацией событий по порядку - для наблюдателя (может быть nullptr) и трассы
+    void orderedRound(NpcWorld& world, size_t range, const SpatialGrid& cells, std::vector<size_t>& killed,
+                      IFFightObserver* observer);
+    // этап 1 без наблюдателя: убитые флагами, потом в world и killed по возрастанию
+    void resolve(NpcWorld& world, size_t range, const SpatialGrid& cells, std::vector<size_t>& killed);
+
+public:
+    explicit Battle(const BattleOptions& options = BattleOptions());
+
+    const BattleOptions& getOptions() const { return options; }
+    size_t threadCount() const { return pool ? pool->size() : 1; }
+
+    // Sequential - убитые в порядке гибели, Parallel - по возрастанию индекса
+    std::vector<size_t> round(NpcWorld& world, size_t range, const std::shared_ptr<IFFightObserver>& observer = nullptr);
+    // убитые в killed (старое содержимое стирается). Без наблюдателя и после первого
+    // раунда на мире того же размера память не выделяется вовсе
+    void round(NpcWorld& world, size_t range, std::vector<size_t>& killed, const std::shared_ptr<IFFightObserver>& observer = nullptr);
+    // Parallel без наблюдателя по сетке вызывающего - она уже описывает текущие
+    // позиции мира (Simulation поправляет ее на месте). В Sequential - runtime_error
+    void round(NpcWorld& world, size_t range, const SpatialGrid& grid, std::vector<size_t>& killed);
+
+    // пул режима Parallel, в Sequential - nullptr
+    ThreadPool* threadPool() { return pool.get(); }
+};
\ No newline at end of file
@@ -2,23 +2,37 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <iostream>
 
 #include "npc.h"
+#include "npcArena.h"
+#include "worldBounds.h"
 
-enum class NpcType {
-    Toad,
-    Dragon, 
-    Knight
-};
+// имя типа в файлах сохранения и логах
+const char* npcTypeName(NpcType type);
+bool parseNpcType(std::string_view name, NpcType& type);
 
 // создание + загрузка
 class NPCFactory {
 public:
     // нпс создан
-    static std::shared_ptr<NPC> create(NpcType type, const std::string& name, int x, int y);
+    static std::shared_ptr<NPC> create(NpcType type, std::string_view name, int x, int y);
+    // с проверкой по границам своего мира, а не WorldBounds::current()
+    static std::shared_ptr<NPC> create(NpcType type, std::string_view name, int x, int y, const WorldBounds& bounds);
+    // то же в памяти арены
+    static std::shared_ptr<NPC> create(NpcType type, std::string_view name, int x, int y, NpcArena& arena);
     // из файла
     static std::shared_ptr<NPC> create(std::istream& is);
+    // разбор строки "тип имя x y" без создания объекта
+    static bool parse(std::istream& is, NpcType& type, std::string& name, int& x, int& y);
+    // то же по строке в памяти, без потоков и выделений: принимает и отвергает
+    // ровно то же, что operator>>; name указывает внутрь line
+    static bool parse(std::string_view line, NpcType& type, std::string_view& name, int& x, int& y);
     // в файл
     static void save(const std::shared_ptr<NPC>& npc, std::ostream& os);
+    // строка "#bounds minX minY maxX maxY" в начале текстового файла. Пишется только для
+    // границ не по умолчанию; старые загрузчики пропускают ее как строку неизвестного типа
+    static void saveBounds(const WorldBounds& bounds, std::ostream& os);
+    static bool parseBounds(std::string_view line, WorldBounds& bounds);
 };
\ No newline at end of file
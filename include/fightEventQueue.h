@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Сжатое событие боя: индексы NPC в мире вместо объектов.
+// sequence = (номер потока << 32) | номер события в потоке
+struct FightEvent {
+    uint64_t sequence;
+    uint32_t attacker;
+    uint32_t defender;
+    bool success;
+    bool endOfStream;   // последнее сообщение потока, attacker/defender не заданы
+
+    uint32_t stream() const { return static_cast<uint32_t>(sequence >> 32); }
+    uint32_t position() const { return static_cast<uint32_t>(sequence); }
+};
+
+// Ограниченная очередь без блокировок: много писателей, один читатель.
+// Кольцо слотов, у каждого счетчик хода (схема Вьюкова): писатель занимает
+// позицию через CAS на head, читатель ничего не делит с писателями, кроме слотов
+class FightEventQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> turn;
+        FightEvent event;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};   // писатели
+    alignas(64) size_t tail = 0;               // только читатель
+
+public:
+    // емкость округляется вверх до степени двойки
+    explicit FightEventQueue(size_t capacity = 4096);
+
+    FightEventQueue(const FightEventQueue&) = delete;
+    FightEventQueue& operator=(const FightEventQueue&) = delete;
+
+    // false - очередь полна
+    bool tryPush(const FightEvent& event);
+    // ждет места, уступая процессор
+    void push(const FightEvent& event);
+    // только из потока-читателя; false - очередь пуста
+    bool tryPop(FightEvent& event);
+
+    size_t capacity() const { return mask + 1; }
+};
+
+// Писатель одного потока событий. Поток ведет один писатель за раз,
+// поэтому внутри потока события приходят к читателю по порядку
+class FightEventStream {
+private:
+    FightEventQueue& queue;
+    uint64_t base;
+    uint32_t count = 0;
+
+public:
+    FightEventStream(FightEventQueue& queue, uint32_t stream) : queue(queue), base(uint64_t{stream} << 32) {}
+
+    void publish(uint32_t attacker, uint32_t defender, bool success) {
+        queue.push({base | count++, attacker, defender, success, false});
+    }
+    // обязательно в конце, иначе следующие потоки не будут выданы
+    void close() { queue.push({base | count, 0, 0, false, true}); }
+};
+
+// Читатель: выдает события в порядке sequence независимо от того, в каком
+// порядке потоки писали в очередь. События потоков впереди текущего ждут в буферах.
+// Буферы не ограничены: пока текущий поток не закрыт, в них может скопиться все,
+// что успели опубликовать потоки дальше него (в худшем случае - почти все события
+// раунда). Очередь ограничивает только то, что еще не дошло до читателя
+class FightEventSequencer {
+private:
+    std::vector<std::vector<FightEvent>> waiting;
+    std::vector<uint8_t> ended;
+    uint32_t current = 0;
+    uint32_t streams = 0;
+
+    template <class Fn>
+    void advance(Fn& fn) {
+        for (++current; current < streams; ++current) {
+            for (const FightEvent& event : waiting[current]) fn(event);
+            waiting[current].clear();
+            if (!ended[current]) break;
+        }
+    }
+
+public:
+    // потоки 0..streams-1; буферы прошлых раундов переиспользуются
+    void reset(uint32_t streamCount) {
+        if (waiting.size() < streamCount) waiting.resize(streamCount);
+        for (uint32_t s = 0; s < streamCount; ++s) waiting[s].clear();
+        ended.assign(streamCount, 0);
+        streams = streamCount;
+        current = 0;
+    }
+
+    bool finished() const { return current >= streams; }
+
+    // fn(const FightEvent&) для каждого события, которое теперь можно выдать
+    template <class Fn>
+    void accept(const FightEvent& event, Fn&& fn) {
+        const uint32_t stream = event.stream();
+        if (stream != current) {
+            if (event.endOfStream) {
+                ended[stream] = 1;
+            } else {
+                waiting[stream].push_back(event);
+            }
+            return;
+        }
+        if (!event.endOfStream) {
+            fn(event);
+            return;
+        }
+        advance(fn);
+    }
+
+    // читает очередь, пока все потоки не закрыты или не запрошена остановка
+    template <class Fn>
+    void drain(FightEventQueue& queue, Fn&& fn, std::stop_token stop = {});
+};
+
+template <class Fn>
+void FightEventSequencer::drain(FightEventQueue& queue, Fn&& fn, std::stop_token stop) {
+    FightEvent event;
+    size_t idle = 0;
+    while (!finished() && !stop.stop_requested()) {
+        if (queue.tryPop(event)) {
+            accept(event, fn);
+            idle = 0;
+        } else if (++idle > 64) {
+            std::this_thread::yield();
+        }
+    }
+}
\ No newline at end of file
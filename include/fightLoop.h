@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+#include "spatialGrid.h"
+
+// Общий цикл последовательного раунда для всех контейнеров: нападающие по
+// возрастанию индекса, защитники - точки сетки в радиусе, убитый сразу выбывает.
+// Контейнер подключается через Round с методами:
+//   bool alive(size_t i)
+//   bool duel(size_t a, size_t d)              - исход и метрика пары
+//   bool observed()                            - есть ли наблюдатель
+//   void observe(size_t a, size_t d, bool win) - вызов наблюдателя
+//   void kill(size_t d)                        - гибель и запись в убитые
+// candidates == nullptr - защитники в порядке ячеек сетки; иначе в этом буфере
+// они сортируются по индексу, и наблюдатель видит ту же последовательность,
+// что при полном переборе
+template <class Round>
+void runFightLoop(const SpatialGrid& grid, const int* xs, const int* ys, size_t count, size_t range,
+                  Round& round, std::vector<uint32_t>* candidates = nullptr) {
+    for (size_t a = 0; a < count; ++a) {
+        if (!round.alive(a)) continue;
+
+        auto visit = [&](uint32_t d) {
+            if (d == a || !round.alive(d)) return;
+            bool victory = round.duel(a, d);
+            if (round.observed()) {
+                DUNGEON_METRIC_TIMER(ObserverCall);
+                round.observe(a, d, victory);
+            }
+            if (victory) {
+                round.kill(d);
+                DUNGEON_METRIC_ADD(Kills, 1);
+            }
+        };
+
+        if (!candidates) {
+            grid.forEachInRange(xs[a], ys[a], range, visit);
+            continue;
+        }
+        candidates->clear();
+        grid.forEachInRange(xs[a], ys[a], range, [&](uint32_t d) { candidates->push_back(d); });
+        std::sort(candidates->begin(), candidates->end());
+        for (uint32_t d : *candidates) visit(d);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "npc.h"
+
+// исход для нападающего
+enum class FightOutcome : unsigned char {
+    Draw,
+    Win,    // защитник убит
+    Lose    // защитник сильнее, но в раунде никто не гибнет
+};
+
+const char* fightOutcomeName(FightOutcome outcome);
+
+// таблица тип x тип, индекс - [нападающий][защитник]
+class FightRules {
+private:
+    std::array<FightOutcome, NPC_TYPE_COUNT * NPC_TYPE_COUNT> table{};
+
+    static constexpr size_t index(NpcType attacker, NpcType defender) {
+        return static_cast<size_t>(attacker) * NPC_TYPE_COUNT + static_cast<size_t>(defender);
+    }
+
+public:
+    constexpr FightRules() = default;
+
+    constexpr FightRules& set(NpcType attacker, NpcType defender, FightOutcome outcome) {
+        table[index(attacker, defender)] = outcome;
+        return *this;
+    }
+
+    constexpr FightOutcome resolve(NpcType attacker, NpcType defender) const {
+        return table[index(attacker, defender)];
+    }
+
+    constexpr bool kills(NpcType attacker, NpcType defender) const {
+        return resolve(attacker, defender) == FightOutcome::Win;
+    }
+
+    constexpr bool operator==(const FightRules&) const = default;
+
+    // строки "Нападающий Защитник win|lose|draw", # - комментарий,
+    // неупомянутые пары - ничья. Ошибка формата - runtime_error
+    static FightRules load(std::istream& is);
+    static FightRules loadFile(const std::string& file_name);
+    void save(std::ostream& os) const;
+
+    // таблица, по которой считаются бои; по умолчанию - правила варианта 13
+    static const FightRules& current();
+    // не вызывать во время боя
+    static void install(const FightRules& rules);
+};
+
+// жаба ест всех, дракон бьет рыцаря, рыцарь бьет дракона
+constexpr FightRules defaultFightRules = FightRules()
+    .set(NpcType::Toad, NpcType::Toad, FightOutcome::Win)
+    .set(NpcType::Toad, NpcType::Dragon, FightOutcome::Win)
+    .set(NpcType::Toad, NpcType::Knight, FightOutcome::Win)
+    .set(NpcType::Dragon, NpcType::Toad, FightOutcome::Lose)
+    .set(NpcType::Dragon, NpcType::Dragon, FightOutcome::Draw)
+    .set(NpcType::Dragon, NpcType::Knight, FightOutcome::Win)
+    .set(NpcType::Knight, NpcType::Toad, FightOutcome::Lose)
+    .set(NpcType::Knight, NpcType::Dragon, FightOutcome::Win)
+    .set(NpcType::Knight, NpcType::Knight, FightOutcome::Draw);
+
+static_assert(defaultFightRules.kills(NpcType::Toad, NpcType::Dragon));
+static_assert(!defaultFightRules.kills(NpcType::Dragon, NpcType::Toad));
+static_assert(defaultFightRules.kills(NpcType::Knight, NpcType::Dragon));
\ No newline at end of file
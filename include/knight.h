@@ -5,7 +5,7 @@
 
 class Knight : public NPC, public std::enable_shared_from_this<Knight> {
 public:
-    Knight(const std::string& name, int x, int y);
+    Knight(std::string_view name, int x, int y, const WorldBounds& bounds = WorldBounds::current());
     
     bool accept(const std::shared_ptr<FightVisitor>& attacker) override;
     
@@ -13,5 +13,5 @@ public:
     bool fight(const std::shared_ptr<Dragon>& other) override;
     bool fight(const std::shared_ptr<Knight>& other) override;
     
-    std::string getType() const override { return "Knight"; }
+    std::string_view getType() const override { return "Knight"; }
 };
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#include "npc.h"
+
+// DUNGEON_METRICS=0 (опция CMake) - макросы ниже пустые, в бою не остается ни одной инструкции
+#ifndef DUNGEON_METRICS
+#define DUNGEON_METRICS 0
+#endif
+
+enum class MetricCounter {
+    PairsExamined,   // пары, проверенные на дистанцию
+    PairsInRange,    // из них в радиусе боя
+    Kills,
+    Rounds
+};
+constexpr size_t METRIC_COUNTER_COUNT = 4;
+
+enum class MetricHistogram {
+    ObserverCall,    // один onFight
+    Round            // раунд боя целиком
+};
+constexpr size_t METRIC_HISTOGRAM_COUNT = 2;
+
+const char* metricCounterName(MetricCounter counter);
+const char* metricHistogramName(MetricHistogram histogram);
+
+// задержки по корзинам-степеням двойки наносекунд
+struct LatencyHistogram {
+    static constexpr size_t BUCKETS = 48;
+
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+
+    static size_t bucketOf(uint64_t ns);
+    double meanNs() const { return count ? static_cast<double>(totalNs) / count : 0; }
+    // верхняя граница корзины, в которую попал q-квантиль (0 < q <= 1)
+    uint64_t percentileNs(double q) const;
+};
+
+// сумма по всем потокам на момент снимка
+struct MetricsSnapshot {
+    std::array<uint64_t, METRIC_COUNTER_COUNT> counters{};
+    // [нападающий][защитник]; в Parallel - все пары в радиусе, живые в начале
+    // раунда, включая уже обреченных защитников: счет не зависит от потоков
+    std::array<std::array<uint64_t, NPC_TYPE_COUNT>, NPC_TYPE_COUNT> fights{};
+    std::array<LatencyHistogram, METRIC_HISTOGRAM_COUNT> histograms{};
+    size_t threads = 0;
+
+    uint64_t counter(MetricCounter c) const { return counters[static_cast<size_t>(c)]; }
+    const LatencyHistogram& histogram(MetricHistogram h) const { return histograms[static_cast<size_t>(h)]; }
+    uint64_t fightCount() const;
+};
+
+// сводка для редактора
+std::ostream& operator<<(std::ostream& os, const MetricsSnapshot& snapshot);
+
+// Счетчики у каждого потока свои: запись - обычный store без блокировок и
+// без общей строки кэша, snapshot() складывает блоки всех потоков.
+// reset() и snapshot() вызывать между раундами, не во время боя
+class Metrics {
+public:
+    static constexpr bool enabled = DUNGEON_METRICS != 0;
+
+    struct ThreadBlock {
+        std::array<std::atomic<uint64_t>, METRIC_COUNTER_COUNT> counters{};
+        std::array<std::atomic<uint64_t>, NPC_TYPE_COUNT * NPC_TYPE_COUNT> fights{};
+        struct Histogram {
+            std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> buckets{};
+            std::atomic<uint64_t> count{0}, totalNs{0}, maxNs{0};
+        };
+        std::array<Histogram, METRIC_HISTOGRAM_COUNT> histograms{};
+        std::atomic<bool> inUse{false};
+    };
+
+    static void add(MetricCounter counter, uint64_t n = 1) {
+        bump(local().counters[static_cast<size_t>(counter)], n);
+    }
+    static void fight(NpcType attacker, NpcType defender) {
+        bump(local().fights[static_cast<size_t>(attacker) * NPC_TYPE_COUNT + static_cast<size_t>(defender)], 1);
+    }
+    static void record(MetricHistogram histogram, uint64_t ns);
+
+    // заранее завести блок текущего потока, чтобы первый замер в бою не выделял память
+    static void attachThread() { local(); }
+
+    static MetricsSnapshot snapshot();
+    static void reset();
+
+private:
+    // пишет только поток-владелец, атомарность нужна лишь для чтения из snapshot()
+    static void bump(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // блок потока берется из общего реестра при первом обращении и возвращается
+    // туда при выходе потока (с накопленными значениями). Указатель - тривиальный
+    // thread_local, на горячем пути нет проверки инициализации
+    inline static thread_local ThreadBlock* cached = nullptr;
+    static ThreadBlock* acquire();
+
+    static ThreadBlock& local() {
+        if (!cached) cached = acquire();
+        return *cached;
+    }
+};
+
+// время жизни объекта - в гистограмму
+class MetricsTimer {
+private:
+    MetricHistogram histogram;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    explicit MetricsTimer(MetricHistogram histogram) : histogram(histogram) {}
+    ~MetricsTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        Metrics::record(histogram, static_cast<uint64_t>(ns));
+    }
+
+    MetricsTimer(const MetricsTimer&) = delete;
+    MetricsTimer& operator=(const MetricsTimer&) = delete;
+};
+
+#define DUNGEON_METRIC_CONCAT_(a, b) a##b
+#define DUNGEON_METRIC_CONCAT(a, b) DUNGEON_METRIC_CONCAT_(a, b)
+
+#if DUNGEON_METRICS
+#define DUNGEON_METRIC_ADD(counter, n) Metrics::add(MetricCounter::counter, (n))
+#define DUNGEON_METRIC_FIGHT(attacker, defender) Metrics::fight((attacker), (defender))
+#define DUNGEON_METRIC_TIMER(histogram) \
+    MetricsTimer DUNGEON_METRIC_CONCAT(metricsTimer, __LINE__)(MetricHistogram::histogram)
+#else
+#define DUNGEON_METRIC_ADD(counter, n) static_cast<void>(0)
+#define DUNGEON_METRIC_FIGHT(attacker, defender) static_cast<void>(0)
+#define DUNGEON_METRIC_TIMER(histogram) static_cast<void>(0)
+#endif
\ No newline at end of file
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
+
+#include "stringPool.h"
+#include "worldBounds.h"
 
 class FightVisitor;
 class IFightObserver;
@@ -11,14 +16,24 @@ class Toad;
 class Dragon;
 class Knight;
 
+enum class NpcType {
+    Toad,
+    Dragon, 
+    Knight
+};
+
+constexpr size_t NPC_TYPE_COUNT = 3;
+
 class NPC {
 protected:
-    std::string name;
+    PooledName name;  // ссылка на строку в StringPool::global()
     int x, y;
     bool alive;
+    NpcType kind;
 
 public:
-    NPC(const std::string& name, int x, int y);
+    // координаты проверяются по bounds - границам мира, которому принадлежит NPC
+    NPC(NpcType kind, std::string_view name, int x, int y, const WorldBounds& bounds = WorldBounds::current());
     virtual ~NPC() = default;
 
     virtual bool accept(const std::shared_ptr<FightVisitor>& attacker) = 0;
@@ -27,15 +42,28 @@ public:
     virtual bool fight(const std::shared_ptr<Dragon>& other) = 0;
     virtual bool fight(const std::shared_ptr<Knight>& other) = 0;
 
-    std::string getName() const { return name; }
+    // имя живет в общем пуле, view действителен, пока жив NPC
+    std::string_view getName() const { return name.view(); }
+    uint32_t getNameId() const { return name.getId(); }
     int getX() const { return x; }
     int getY() const { return y; }
+    // проверяет координаты так же, как конструктор
+    void moveTo(int newX, int newY);
+    NpcType getKind() const { return kind; }
     bool isAlive() const { return alive; }
     void kill() { alive = false; }
 
     double distance(const std::shared_ptr<NPC>& other) const;
 
-    virtual std::string getType() const = 0;
+    // исход по таблице FightRules, без виртуальных вызовов; true - защитник убит.
+    // Подробности уходят в FightTrace, если он включен
+    bool duel(const NPC& other) const;
+
+    // бросает runtime_error, если точка вне WorldBounds::current() (по умолчанию 0-500)
+    static void checkCoordinates(int x, int y);
+    static void checkCoordinates(int x, int y, const WorldBounds& bounds);
+
+    virtual std::string_view getType() const = 0;
 };
 
 using NPCPtr = std::shared_ptr<NPC>;
\ No newline at end of file
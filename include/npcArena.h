@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+// Память под NPC блоками: объекты и их счетчики ссылок (allocate_shared) размещаются
+// подряд, освобождение отдельного NPC ничего не стоит, все блоки уходят разом
+// вместе с ареной. Арена должна пережить все созданные в ней NPC.
+// Имена в арену не попадают - они в общем StringPool
+class NpcArena {
+private:
+    std::pmr::monotonic_buffer_resource memory;
+    size_t objects = 0;
+
+public:
+    // первый блок initialBytes, следующие растут в геометрической прогрессии
+    explicit NpcArena(size_t initialBytes = 64 * 1024) : memory(initialBytes) {}
+
+    NpcArena(const NpcArena&) = delete;
+    NpcArena& operator=(const NpcArena&) = delete;
+
+    template <class T, class... Args>
+    std::shared_ptr<T> make(Args&&... args) {
+        ++objects;
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(&memory), std::forward<Args>(args)...);
+    }
+
+    // сколько объектов создано за время жизни арены
+    size_t size() const { return objects; }
+};
\ No newline at end of file
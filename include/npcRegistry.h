@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "npc.h"
+#include "npcArena.h"
+#include "observer.h"
+
+// ссылка на NPC в NpcRegistry: слот + поколение. После удаления NPC слот
+// переиспользуется с новым поколением, старые ссылки перестают находить объект
+struct NpcHandle {
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    uint32_t index = INVALID;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != INVALID; }
+    friend bool operator==(const NpcHandle&, const NpcHandle&) = default;
+};
+
+// Реестр NPC (slot map): вставка, поиск и удаление по ссылке за O(1),
+// объекты лежат плотно. Порядок обхода зависит только от последовательности
+// вставок и удалений, но не от адресов в памяти
+class NpcRegistry {
+private:
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    struct Slot {
+        uint32_t dense;        // позиция в objects, у свободного слота - следующий свободный
+        uint32_t generation;
+        bool used;
+    };
+
+    std::vector<Slot> slots;
+    uint32_t freeHead = NO_SLOT;
+    std::vector<std::shared_ptr<NPC>> objects;   // плотно, в порядке обхода
+    std::vector<uint32_t> slotOf;                // позиция -> слот
+
+public:
+    // nullptr не вставляется, возвращается недействительная ссылка
+    NpcHandle insert(std::shared_ptr<NPC> npc);
+    // через NPCFactory, arena != nullptr - в памяти арены
+    NpcHandle create(NpcType type, std::string_view name, int x, int y, NpcArena* arena = nullptr);
+
+    bool contains(NpcHandle handle) const;
+    // nullptr, если ссылка устарела
+    NPC* get(NpcHandle handle) const;
+    std::shared_ptr<NPC> share(NpcHandle handle) const;
+
+    // false, если ссылка устарела; последний объект переезжает на место удаленного
+    bool remove(NpcHandle handle);
+    // выбрасывает мертвых за один проход, порядок живых сохраняется; возвращает сколько
+    size_t removeDead();
+    void clear();
+    void reserve(size_t count);
+
+    size_t size() const { return objects.size(); }
+    bool empty() const { return objects.empty(); }
+
+    // плотный доступ в порядке обхода, i < size()
+    const std::shared_ptr<NPC>& at(size_t i) const { return objects[i]; }
+    NpcHandle handleAt(size_t i) const { return {slotOf[i], slots[slotOf[i]].generation}; }
+};
+
+// наблюдатель боя по ссылкам реестра
+class IRegistryFightObserver {
+public:
+    virtual ~IRegistryFightObserver() = default;
+    virtual void onFight(const NpcRegistry& registry, NpcHandle attacker, NpcHandle defender, bool success) = 0;
+};
+
+// прежние наблюдатели (TextObserver, FileObserver, ...) через реестр
+class RegistryObserverAdapter : public IRegistryFightObserver {
+private:
+    std::shared_ptr<IFFightObserver> observer;
+
+public:
+    explicit RegistryObserverAdapter(std::shared_ptr<IFFightObserver> observer) : observer(std::move(observer)) {}
+
+    void onFight(const NpcRegistry& registry, NpcHandle attacker, NpcHandle defender, bool success) override {
+        observer->onFight(registry.share(attacker), registry.share(defender), success);
+    }
+};
+
+// раунд как fight(set_t): нападающие и защитники в порядке обхода реестра,
+// убитые остаются в реестре мертвыми до removeDead(); возвращаются в порядке гибели
+std::vector<NpcHandle> fight(NpcRegistry &registry, size_t range,
+                             const std::shared_ptr<IRegistryFightObserver>& observer = nullptr);
+
+void saveNPC(const NpcRegistry &registry, const std::string &file_name);
+// добавляет NPC из файла в порядке строк, false если файл не открылся
+bool loadNPC(const std::string &file_name, NpcRegistry &registry, NpcArena* arena = nullptr);
+
+std::ostream &operator<<(std::ostream &os, const NpcRegistry &registry);
\ No newline at end of file
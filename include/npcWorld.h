@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "factory.h"
+#include "npcRegistry.h"
+#include "observer.h"
+#include "spatialGrid.h"
+#include "world.h"
+#include "worldBounds.h"
+#include "worldSnapshot.h"
+
+// мир в виде структуры массивов: координаты, типы и флаги лежат подряд,
+// имена - в одном общем буфере. NPC адресуется индексом
+class NpcWorld {
+    friend class WorldFile;
+    friend class Simulation;
+    friend class WorldGenerator;
+
+private:
+    std::vector<int> xs, ys;
+    std::vector<NpcType> types;
+    std::vector<uint8_t> alive;
+    std::string names;                // все имена подряд
+    std::vector<uint32_t> nameStart;  // size() + 1 смещений в names
+    WorldBounds bounds;
+
+    // последний снятый или восстановленный снимок: мир совпадает с ним везде, кроме
+    // помеченных кусков (по частям снимка); куски за концом пометок - тоже изменены
+    std::shared_ptr<const WorldSnapshot::Data> base;
+    std::vector<uint8_t> dirtyPositions, dirtyFlags, dirtyIdentity;
+
+    static void touch(std::vector<uint8_t>& dirty, size_t i) {
+        size_t chunk = i / WorldSnapshot::CHUNK;
+        if (chunk < dirty.size()) dirty[chunk] = 1;
+    }
+    void touchAll(size_t i) {
+        touch(dirtyPositions, i);
+        touch(dirtyFlags, i);
+        touch(dirtyIdentity, i);
+    }
+    // для тех, кто пишет столбцы напрямую: сдвинуто все
+    void touchAllPositions() { std::fill(dirtyPositions.begin(), dirtyPositions.end(), uint8_t{1}); }
+    // индексы поменялись - следующий снимок строится целиком
+    void forgetSnapshot();
+
+public:
+    // границы по умолчанию - WorldBounds::current() на момент создания
+    NpcWorld() : bounds(WorldBounds::current()) { nameStart.push_back(0); }
+    explicit NpcWorld(const WorldBounds& bounds) : bounds(bounds) { nameStart.push_back(0); }
+
+    const WorldBounds& getBounds() const { return bounds; }
+    // runtime_error, если кто-то из NPC окажется снаружи
+    void setBounds(const WorldBounds& bounds);
+
+    // проверяет координаты по границам мира
+    size_t add(NpcType type, std::string_view name, int x, int y);
+    void reserve(size_t count, size_t nameBytes = 0);
+    void clear();
+
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+    size_t aliveCount() const;
+
+    int getX(size_t i) const { return xs[i]; }
+    int getY(size_t i) const { return ys[i]; }
+    NpcType getType(size_t i) const { return types[i]; }
+    std::string_view getName(size_t i) const {
+        return std::string_view(names).substr(nameStart[i], nameStart[i + 1] - nameStart[i]);
+    }
+    bool isAlive(size_t i) const { return alive[i] != 0; }
+    void kill(size_t i) {
+        alive[i] = 0;
+        touch(dirtyFlags, i);
+    }
+    // проверяет координаты по границам мира, как add
+    void move(size_t i, int x, int y);
+
+    const int* xData() const { return xs.data(); }
+    const int* yData() const { return ys.data(); }
+    const uint8_t* aliveData() const { return alive.data(); }
+
+    // выбрасывает мертвых, порядок живых сохраняется
+    void removeDead();
+
+    // объект NPC с теми же данными - для наблюдателей и старого API; координаты
+    // проверяются по границам этого мира
+    std::shared_ptr<NPC> materialize(size_t i) const;
+
+    // Снимок не O(1): O(число кусков + байты кусков, измененных с прошлого
+    // snapshot/restore), неизмененные куски берутся из прошлого снимка. O(1) только
+    // копия готового WorldSnapshot. Первый снимок и снимок после removeDead/clear
+    // копируют все. Запоминает снимок как базу для следующего, поэтому не const:
+    // из разных потоков одновременно не вызывать
+    WorldSnapshot snapshot();
+    // Возврат к снимку (любому, не только последнему): копируются только куски,
+    // которые отличаются от него. Границы тоже берутся из снимка
+    void restore(const WorldSnapshot& snapshot);
+    static NpcWorld fromSnapshot(const WorldSnapshot& snapshot);
+
+    static NpcWorld fromSet(const set_t& npc_collection);
+    // в порядке обхода реестра
+    static NpcWorld fromRegistry(const NpcRegistry& registry);
+    set_t toSet() const;
+
+    size_t memoryUsage() const;
+};
+
+// раунд боя по индексам, возвращает убитых в порядке гибели
+std::vector<size_t> fight(NpcWorld &world, size_t range, const std::shared_ptr<IFFightObserver>& observer = nullptr);
+// то же на буферах вызывающего: grid и killed переиспользуются между раундами,
+// без наблюдателя раунд не выделяет память, пока их емкости хватает
+void fight(NpcWorld &world, size_t range, SpatialGrid &grid, std::vector<size_t> &killed,
+           const std::shared_ptr<IFFightObserver>& observer = nullptr);
+
+void saveNPC(const NpcWorld &world, const std::string &file_name);
+// добавляет NPC из файла в world, false если файл не открылся
+bool loadNPC(const std::string &file_name, NpcWorld &world);
+
+std::ostream &operator<<(std::ostream &os, const NpcWorld &world);
\ No newline at end of file
@@ -3,6 +3,15 @@
 #include <memory>
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include "npc.h"
 
@@ -11,20 +20,99 @@ class IFFightObserver {
 public:
     virtual ~IFFightObserver() = default;
     virtual void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) = 0;
+    // проверка по типам и исходу до создания объектов: раунды NpcWorld, VariantWorld
+    // и Battle не материализуют NPC для события, от которого наблюдатель откажется
+    virtual bool accepts(NpcType, NpcType, bool) const { return true; }
 };
 
-class TextObserver : public IFFightObserver {
+// дописывает в out строку "Тип имя killed Тип имя at (x, y)\n" - байт в байт как прежняя
+// цепочка operator<<, но через to_chars, без локали; память нужна, только если не хватает емкости out
+void appendKillLine(std::string& out, std::string_view attackerType, std::string_view attackerName,
+                    std::string_view defenderType, std::string_view defenderName, int x, int y);
+
+// строка собирается в буфере потока и уходит в cout одним write - с проверкой
+// состояния потока, tie и unitbuf, как у прежнего operator<<
+class TextObserver final : public IFFightObserver {
 public:
     void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override;
 };
 
-class FileObserver : public IFFightObserver {
+// строки копятся в пачке и пишутся в файл одним write по BATCH_BYTES
+// и в деструкторе; flush() - сбросить раньше
+class FileObserver final : public IFFightObserver {
+public:
+    static constexpr size_t BATCH_BYTES = 64 * 1024;
+
 private:
     std::ofstream logfile;
+    std::string batch;
 
 public:
     FileObserver(const std::string& filename = "logs_of_battle.txt");
     ~FileObserver();
     
     void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override;
+
+    void flush();
+};
+
+// что делать, когда очередь записи заполнена
+enum class OverflowPolicy {
+    Block,   // ждать писателя, ничего не теряется
+    Drop,    // выбросить событие
+    Sample   // ждать только каждое sampleEvery-е событие сверх очереди, остальные выбросить
+};
+
+// FileObserver с фоновым потоком записи: бой кладет компактную запись в кольцевой буфер,
+// писатель форматирует и сбрасывает на диск пачками. В деструкторе очередь дописывается до конца.
+// Имена в записи - номера в StringPool::global() со ссылкой, снятой писателем после
+// записи: текст не уходит из пула, даже если NPC к тому времени уничтожен, так что
+// писатель читает его сам, любой длины, и строки совпадают с FileObserver
+class AsyncFileObserver final : public IFFightObserver {
+private:
+    struct Record {
+        NpcType attackerType;
+        NpcType defenderType;
+        int x, y;
+        uint32_t attackerName;
+        uint32_t defenderName;
+    };
+
+    std::ofstream logfile;
+    OverflowPolicy policy;
+    size_t sampleEvery;
+
+    std::vector<Record> ring;
+    size_t head = 0;   // всего положено
+    size_t tail = 0;   // всего записано
+    size_t overflowCount = 0;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::condition_variable drained;
+
+    std::atomic<size_t> droppedCount{0};
+    std::atomic<size_t> writtenCount{0};
+
+    std::thread writer;
+
+    void writerLoop();
+
+public:
+    AsyncFileObserver(const std::string& filename = "logs_of_battle.txt", size_t capacity = 4096,
+                      OverflowPolicy policy = OverflowPolicy::Block, size_t sampleEvery = 16);
+    ~AsyncFileObserver();
+
+    AsyncFileObserver(const AsyncFileObserver&) = delete;
+    AsyncFileObserver& operator=(const AsyncFileObserver&) = delete;
+
+    void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override;
+
+    // ждет, пока все положенное до вызова окажется в файле
+    void flush();
+
+    size_t dropped() const { return droppedCount.load(); }
+    size_t written() const { return writtenCount.load(); }
 };
\ No newline at end of file
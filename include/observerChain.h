@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "npc.h"
+#include "observer.h"
+
+// Фильтры событий для Filtered: static constexpr bool accepts(attacker, defender, success).
+// Проверка идет до вызова наблюдателя, так что отсеянные события не форматируются вовсе,
+// а через ObserverChain::accepts раунд узнает о ней еще до создания объектов NPC
+struct AnyFight {
+    static constexpr bool accepts(NpcType, NpcType, bool) { return true; }
+};
+
+struct KillsOnly {
+    static constexpr bool accepts(NpcType, NpcType, bool success) { return success; }
+};
+
+template <NpcType Attacker, NpcType Defender>
+struct TypePair {
+    static constexpr bool accepts(NpcType attacker, NpcType defender, bool) {
+        return attacker == Attacker && defender == Defender;
+    }
+};
+
+template <NpcType Attacker>
+struct AttackerIs {
+    static constexpr bool accepts(NpcType attacker, NpcType, bool) { return attacker == Attacker; }
+};
+
+template <class... Filters>
+struct AllOf {
+    static constexpr bool accepts(NpcType attacker, NpcType defender, bool success) {
+        return (Filters::accepts(attacker, defender, success) && ...);
+    }
+};
+
+namespace observer_detail {
+
+template <class T>
+struct IsPointer : std::false_type {};
+template <class T>
+struct IsPointer<T*> : std::true_type {};
+template <class T>
+struct IsPointer<std::shared_ptr<T>> : std::true_type {};
+template <class T>
+struct IsPointer<std::unique_ptr<T>> : std::true_type {};
+
+// наблюдатель по значению или по указателю; для final-классов вызов без vtable
+template <class Observer>
+void notify(Observer& observer, const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) {
+    if constexpr (IsPointer<Observer>::value) {
+        if (observer) observer->onFight(attacker, defender, success);
+    } else {
+        observer.onFight(attacker, defender, success);
+    }
+}
+
+// нужно ли событие наблюдателю: его accepts, если он есть, иначе нужно
+template <class Observer>
+bool accepts(const Observer& observer, NpcType attacker, NpcType defender, bool success) {
+    if constexpr (IsPointer<Observer>::value) {
+        if (!observer) return false;
+        if constexpr (requires { observer->accepts(attacker, defender, success); }) {
+            return observer->accepts(attacker, defender, success);
+        } else {
+            return true;
+        }
+    } else if constexpr (requires { observer.accepts(attacker, defender, success); }) {
+        return observer.accepts(attacker, defender, success);
+    } else {
+        return true;
+    }
+}
+
+}  // namespace observer_detail
+
+// наблюдатель, до которого доходят только события, пропущенные Filter
+template <class Filter, class Observer>
+class Filtered {
+private:
+    Observer observer;
+
+public:
+    template <class... Args>
+    explicit Filtered(Args&&... args) : observer(std::forward<Args>(args)...) {}
+
+    void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) {
+        if (Filter::accepts(attacker->getKind(), defender->getKind(), success)) {
+            observer_detail::notify(observer, attacker, defender, success);
+        }
+    }
+
+    bool accepts(NpcType attacker, NpcType defender, bool success) const {
+        return Filter::accepts(attacker, defender, success)
+            && observer_detail::accepts(observer, attacker, defender, success);
+    }
+
+    Observer& get() { return observer; }
+};
+
+// Наблюдатели, собранные на этапе компиляции: элементы - наблюдатели по значению,
+// указатели на них или Filtered<...>, вызываются по порядку без виртуальных вызовов
+// между собой. Снаружи это обычный IFFightObserver - подходит для FightVisitor,
+// fight(...), Battle и RegistryObserverAdapter, событие стоит один виртуальный вызов
+// на всю цепочку вместо одного на каждого наблюдателя.
+// Конструктор принимает по одному аргументу на элемент, элементы строятся на месте
+template <class... Observers>
+class ObserverChain final : public IFFightObserver {
+private:
+    std::tuple<Observers...> observers;
+
+public:
+    ObserverChain() = default;
+
+    template <class... Args>
+        requires(sizeof...(Args) == sizeof...(Observers) && sizeof...(Args) > 0)
+    explicit ObserverChain(Args&&... args) : observers(std::forward<Args>(args)...) {}
+
+    void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override {
+        std::apply([&](auto&... observer) { (observer_detail::notify(observer, attacker, defender, success), ...); },
+                   observers);
+    }
+
+    // событие нужно хотя бы одному элементу
+    bool accepts(NpcType attacker, NpcType defender, bool success) const override {
+        return std::apply([&](const auto&... observer) {
+            return (observer_detail::accepts(observer, attacker, defender, success) || ...);
+        }, observers);
+    }
+
+    template <size_t I>
+    auto& get() { return std::get<I>(observers); }
+
+    static constexpr size_t size() { return sizeof...(Observers); }
+};
\ No newline at end of file
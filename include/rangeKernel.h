@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// пакетная проверка "защитник в радиусе" для одного нападающего
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// лучший доступный на этой машине, определяется один раз при первом вызове
+SimdLevel detectSimdLevel();
+bool simdLevelSupported(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+// mask[i] = 1, если (xs[i] - x)^2 + (ys[i] - y)^2 <= range2, иначе 0; возвращает число единиц.
+// Целочисленное сравнение квадратов, без sqrt. Разности координат должны быть меньше 32768
+// (на карте 0-500 это всегда так)
+size_t rangeMask(int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask);
+size_t rangeMask(SimdLevel level, int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask);
+
+// радиус, до которого 64-битная арифметика rangeMaskWide не переполняется: 2 * r^2 < 2^63
+constexpr long long WIDE_RANGE_LIMIT = (1LL << 31) - 2;
+
+// То же для любых int32: разности и квадраты в 64 битах, радиус ограничен WIDE_RANGE_LIMIT.
+// Вдвое уже по дорожкам; SSE2 без 64-битных сравнений - там скалярный вариант
+size_t rangeMaskWide(int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask);
+size_t rangeMaskWide(SimdLevel level, int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask);
+
+// точки int32 не бывают дальше друг от друга: sqrt(2) * (2^32 - 1) < MAX_INT32_DISTANCE
+constexpr long long MAX_INT32_DISTANCE = 6074001000LL;
+
+// квадрат расстояния между любыми точками int32, до 2^65
+__extension__ typedef unsigned __int128 HugeDistance2;
+
+// Радиус больше WIDE_RANGE_LIMIT: квадраты не помещаются в 64 бита, сравнение скалярное
+// в 128 битах. При range >= MAX_INT32_DISTANCE в радиусе все точки, без сравнений
+size_t rangeMaskHuge(int x, int y, const int* xs, const int* ys, size_t count, unsigned long long range, uint8_t* mask);
\ No newline at end of file
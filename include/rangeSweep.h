@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "npcWorld.h"
+
+struct RangeSweepResult {
+    static constexpr size_t SURVIVES = std::numeric_limits<size_t>::max();
+
+    std::vector<size_t> ranges;
+    // убитые на каждом шаге, индексы world по возрастанию
+    std::vector<std::vector<size_t>> killed;
+    // дистанция шага, на котором NPC погиб, SURVIVES - дожил до конца
+    std::vector<size_t> deathRange;
+};
+
+// Все шаги дистанции за один проход вместо fight() на каждый шаг.
+//
+// Первый шаг считается прямым поиском. Для каждого выжившего нападающего один раз
+// собираются выжившие защитники, которых он побеждает по FightRules (поиск только по
+// сеткам нужных типов), в радиусе наибольшего шага, и сортируются по дистанции.
+// Следующий шаг с радиусом r двигает курсор каждого живого нападающего по его списку
+// до r: все, кто ближе, уже убиты им на прошлых шагах.
+// Внутри шага нападающие идут по возрастанию индекса, как в fight(NpcWorld&), поэтому
+// убитые совпадают с последовательностью fight(world, r) по тем же ranges
+// (мертвые между шагами выбывают). Память - по паре на каждого побеждаемого соседа
+// выжившего после первого шага в наибольшем радиусе
+class RangeSweep {
+public:
+    // world не меняется, мертвые в нем не участвуют
+    static RangeSweepResult run(const NpcWorld& world, const std::vector<size_t>& ranges);
+};
\ No newline at end of file
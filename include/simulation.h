@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "battle.h"
+#include "npcWorld.h"
+#include "spatialGrid.h"
+#include "worldBounds.h"
+
+struct SimulationOptions {
+    size_t range = 20;              // радиус боя каждого тика
+    int maxSpeed = 2;               // шаг за тик по каждой оси, не больше
+    uint32_t turnEvery = 32;        // тиков между сменами направления у одного NPC
+    double tickSeconds = 1.0 / 60;  // фиксированный шаг для advance()
+    size_t threads = 0;             // 0 - по числу ядер
+    size_t chunkSize = 4096;        // NPC на одну задачу пула
+    uint64_t seed = 1;
+};
+
+// время по этапам за все тики
+struct SimulationStats {
+    uint64_t ticks = 0;
+    uint64_t kills = 0;
+    uint64_t gridRebuilds = 0;      // тики, где update сетки сдался и собрал ее заново
+    double moveSeconds = 0;
+    double gridSeconds = 0;
+    double fightSeconds = 0;
+
+    double seconds() const { return moveSeconds + gridSeconds + fightSeconds; }
+    double ticksPerSecond() const { return seconds() > 0 ? ticks / seconds() : 0; }
+};
+
+// Мир с движением по фиксированному шагу. Тик: живые NPC делают шаг (направление
+// меняется раз в turnEvery тиков, у каждого в свой тик, от краев карты отражается),
+// сетка поправляется на месте через SpatialGrid::update, затем бой как Battle Parallel
+// по этой сетке. Все этапы - на пуле потоков Battle (с кражей работы).
+// Результат зависит только от мира, seed и числа тиков, но не от числа потоков.
+// Мир между тиками менять только через Simulation или add: новые NPC
+// получают скорость, сетка перестраивается
+class Simulation {
+private:
+    NpcWorld& world;
+    SimulationOptions options;
+    Battle battle;
+    SpatialGrid grid;
+    WorldBounds area;               // границы, над которыми строилась сетка
+    std::vector<int> vx, vy;
+    std::vector<size_t> killed;
+    SimulationStats stats;
+    uint64_t tickCount = 0;
+    double pending = 0;             // накопленное advance время, меньше шага
+
+    void prepare();
+    void move();
+
+public:
+    explicit Simulation(NpcWorld& world, const SimulationOptions& options = SimulationOptions());
+
+    // один тик, возвращает убитых в нем по возрастанию индекса
+    const std::vector<size_t>& tick();
+    void run(size_t ticks);
+    // Фиксированный шаг: копит прошедшее реальное время и делает столько целых
+    // тиков, сколько в нем помещается, но не больше maxTicks за вызов -
+    // отставание сверх этого отбрасывается. Возвращает число тиков
+    size_t advance(double elapsedSeconds, size_t maxTicks = 4);
+
+    // выбрасывает мертвых из мира, скорости и сетка следуют за индексами
+    void removeDead();
+
+    uint64_t getTick() const { return tickCount; }
+    const SimulationStats& getStats() const { return stats; }
+    const SpatialGrid& getGrid() const { return grid; }
+    const SimulationOptions& getOptions() const { return options; }
+    size_t threadCount() const { return battle.threadCount(); }
+};
\ No newline at end of file
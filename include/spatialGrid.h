@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+#include "rangeKernel.h"
+#include "threadPool.h"
+#include "worldBounds.h"
+
+// равномерная сетка для поиска соседей в радиусе
+// точки лежат подряд по ячейкам (как CSR), соседние ячейки одной строки - непрерывный кусок
+class SpatialGrid {
+private:
+    int cellSize = 1;
+    int minX = 0, minY = 0;
+    int maxX = 0, maxY = 0;
+    int cols = 0, rows = 0;
+    bool wide = false;   // разброс точек не влезает в узкий rangeMask
+
+    std::vector<uint32_t> cellStart;  // cols * rows + 1
+    std::vector<uint32_t> ids;        // индексы точек, отсортированы по ячейкам
+    std::vector<int> cellX, cellY;    // координаты в том же порядке
+    std::vector<uint32_t> cellOf, fill;  // рабочие буферы build, живут между вызовами
+
+    // для update: сетка над областью build(..., area), где лежит каждая точка
+    struct Move {
+        uint32_t point, cell;
+    };
+    bool tracked = false;
+    std::vector<uint32_t> slotOf;              // точка -> позиция в ids
+    std::vector<std::vector<Move>> movers;     // сменившие ячейку, по кускам update
+    std::vector<Move> arrivals;
+    std::vector<uint8_t> leaving;              // по позициям, между вызовами все нули
+    std::vector<uint32_t> spareIds;            // второй комплект ids/cellX/cellY для слияния
+    std::vector<int> spareX, spareY;
+
+    void layout(const int* xs, const int* ys, size_t count);
+    void relocate(const int* xs, const int* ys, size_t chunkCount, size_t moverCount);
+    void chooseCells(long long width, long long height, size_t count, size_t cell);
+    void swapSlots(uint32_t a, uint32_t b);
+
+    // разность двух int32 при x >= minX влезает в uint32, а 32-битное деление быстрее
+    int cellCol(int x) const {
+        return static_cast<int>(static_cast<uint32_t>(static_cast<long long>(x) - minX) / static_cast<uint32_t>(cellSize));
+    }
+    int cellRow(int y) const {
+        return static_cast<int>(static_cast<uint32_t>(static_cast<long long>(y) - minY) / static_cast<uint32_t>(cellSize));
+    }
+
+    // узкий rangeMask верен, пока все разности координат меньше 32768
+    bool needsWideKernel(int x, int y) const {
+        return wide || x < minX || x > maxX || y < minY || y > maxY;
+    }
+
+public:
+    SpatialGrid() = default;
+
+    // ячейка ~ радиус боя, тогда хватает соседей 3x3
+    // повторная сборка того же размера память не выделяет
+    void build(const int* xs, const int* ys, size_t count, size_t cell);
+    // сетка над всей областью area, а не над разбросом точек: точки могут
+    // двигаться внутри area, и сетку можно поправлять через update
+    void build(const int* xs, const int* ys, size_t count, size_t cell, const WorldBounds& area);
+
+    // Точки сдвинулись (все внутри area, число то же): координаты переписываются
+    // на месте, сменившие ячейку переносятся через соседние ячейки по одной
+    // границе за шаг. Если шагов много - один последовательный проход слиянием,
+    // без пересчета ячеек у оставшихся. Сетка без area или другое число точек -
+    // полная сборка, тогда false.
+    // pool - параллельный проход по точкам, nullptr - в вызывающем потоке;
+    // moving[i] == 0 - точка i не двигалась с прошлого раза и пропускается
+    bool update(const int* xs, const int* ys, size_t count, ThreadPool* pool = nullptr, size_t chunkSize = 4096,
+                const uint8_t* moving = nullptr);
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+    int getCellSize() const { return cellSize; }
+
+    // точки в порядке ячеек: соседи по карте лежат рядом и в памяти
+    uint32_t idAt(size_t slot) const { return ids[slot]; }
+    int xAt(size_t slot) const { return cellX[slot]; }
+    int yAt(size_t slot) const { return cellY[slot]; }
+
+    // все точки из ячеек, задевающих квадрат [x - range, x + range]
+    // точное сравнение расстояния остается вызывающему
+    template <class Fn>
+    void forEachCandidate(int x, int y, size_t range, Fn&& fn) const {
+        forEachRowSpan(x, y, range, [&](uint32_t from, uint32_t to) {
+            for (uint32_t k = from; k < to; ++k) {
+                fn(ids[k]);
+            }
+        });
+    }
+
+    // только точки в круге радиуса range; отсев пакетами через rangeMask,
+    // на картах шире 32767 - через rangeMaskWide, при радиусе больше WIDE_RANGE_LIMIT -
+    // через rangeMaskHuge
+    // (метрики пар считают и саму точку (x, y), если она есть в сетке)
+    template <class Fn>
+    void forEachInRange(int x, int y, size_t range, Fn&& fn) const {
+        const bool huge = range > static_cast<size_t>(WIDE_RANGE_LIMIT);
+        long long r = static_cast<long long>(std::min<size_t>(range, WIDE_RANGE_LIMIT));
+        long long range2 = r * r;
+        const bool wideKernel = needsWideKernel(x, y);
+        uint8_t mask[256];
+        forEachRowSpan(x, y, range, [&](uint32_t from, uint32_t to) {
+            for (uint32_t k = from; k < to; k += 256) {
+                size_t n = std::min<size_t>(256, to - k);
+                size_t hits = huge ? rangeMaskHuge(x, y, cellX.data() + k, cellY.data() + k, n, range, mask)
+                            : wideKernel ? rangeMaskWide(x, y, cellX.data() + k, cellY.data() + k, n, range2, mask)
+                                         : rangeMask(x, y, cellX.data() + k, cellY.data() + k, n, range2, mask);
+                DUNGEON_METRIC_ADD(PairsExamined, n);
+                DUNGEON_METRIC_ADD(PairsInRange, hits);
+                if (hits == 0) continue;
+                for (size_t j = 0; j < n; ++j) {
+                    if (mask[j]) fn(ids[k + j]);
+                }
+            }
+        });
+    }
+
+private:
+    // для каждой строки ячеек - непрерывный кусок [from, to) в ids/cellX/cellY
+    template <class Fn>
+    void forEachRowSpan(int x, int y, size_t range, Fn&& fn) const {
+        if (ids.empty()) return;
+        long long r = static_cast<long long>(std::min<size_t>(range, size_t{1} << 40));
+        long long left = (static_cast<long long>(x) - r - minX) / cellSize;
+        long long right = (static_cast<long long>(x) + r - minX) / cellSize;
+        long long top = (static_cast<long long>(y) - r - minY) / cellSize;
+        long long bottom = (static_cast<long long>(y) + r - minY) / cellSize;
+        if (static_cast<long long>(x) - r < minX) left = 0;
+        if (static_cast<long long>(y) - r < minY) top = 0;
+        if (right >= cols) right = cols - 1;
+        if (bottom >= rows) bottom = rows - 1;
+        if (left > right || top > bottom) return;
+
+        for (long long row = top; row <= bottom; ++row) {
+            size_t base = static_cast<size_t>(row) * cols;
+            uint32_t from = cellStart[base + left];
+            uint32_t to = cellStart[base + right + 1];
+            if (from < to) fn(from, to);
+        }
+    }
+};
\ No newline at end of file
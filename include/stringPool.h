@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Интернирование строк: каждая различная строка хранится один раз и получает
+// 32-битный номер. У номера счетчик ссылок: intern и retain добавляют ссылку,
+// release снимает. Со снятием последней строка уходит из пула, ее номер
+// достается следующей новой строке, а блок текста освобождается, когда в нем
+// не остается живых строк. Пока ссылка держится, текст не перемещается и
+// string_view из view() действителен.
+// intern/find/retain/release потокобезопасны; view по удерживаемому номеру читает без блокировки
+class StringPool {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    StringPool();
+    ~StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // номер строки и ссылка на него, новая строка копируется в пул
+    uint32_t intern(std::string_view text);
+    // номер без добавления и без ссылки, NONE если строки нет
+    uint32_t find(std::string_view text) const;
+
+    // еще одна ссылка на удерживаемый номер
+    void retain(uint32_t id) { entry(id).refs.fetch_add(1, std::memory_order_relaxed); }
+    // снимает ссылку; после последней номер и текст больше не принадлежат строке
+    void release(uint32_t id);
+
+    std::string_view view(uint32_t id) const { return entry(id).text; }
+
+    // сколько строк в пуле сейчас
+    size_t size() const;
+    // текст, таблица номеров и хеш-индекс, байт
+    size_t memoryUsage() const;
+
+    // общий пул имен NPC
+    static StringPool& global();
+
+private:
+    // номера лежат в сегментах 1024, 2048, 4096, ... - таблица растет без переноса,
+    // поэтому читатели view не мешают писателю
+    static constexpr size_t FIRST_SEGMENT = 1024;
+    static constexpr size_t SEGMENT_COUNT = 22;
+    static constexpr size_t TEXT_BLOCK = 64 * 1024;
+
+    static constexpr uint32_t NO_BLOCK = 0xFFFFFFFFu;
+
+    struct Entry {
+        std::string_view text;
+        std::atomic<uint32_t> refs{0};
+        uint32_t block = NO_BLOCK;  // где лежит текст, у пустой строки - нигде
+        bool used = false;          // меняется только под исключительной блокировкой
+    };
+
+    struct Block {
+        std::unique_ptr<char[]> data;  // nullptr - блок освобожден, слот свободен
+        size_t bytes = 0;
+        size_t live = 0;               // байт живых строк
+    };
+
+    static size_t segmentOf(uint32_t id);
+    static size_t segmentBase(size_t segment) { return FIRST_SEGMENT * ((size_t{1} << segment) - 1); }
+
+    Entry& entry(uint32_t id) const {
+        size_t segment = segmentOf(id);
+        return segments[segment][id - segmentBase(segment)];
+    }
+
+    std::unique_ptr<Entry[]> segments[SEGMENT_COUNT];
+    uint32_t count = 0;             // выдано номеров, включая освобожденные
+    uint32_t liveCount = 0;
+    std::vector<uint32_t> freeIds;
+
+    std::vector<Block> blocks;      // текст строк
+    std::vector<uint32_t> freeBlocks;
+    uint32_t current = NO_BLOCK;    // блок, куда дописываются короткие строки
+    size_t blockUsed = 0;
+    size_t blockBytes = 0;
+
+    std::vector<uint32_t> index;  // открытая адресация, NONE - пусто; размер - степень двойки
+
+    mutable std::shared_mutex mutex;
+
+    uint32_t lookup(std::string_view text, size_t hash) const;
+    void store(Entry& target, std::string_view text);
+    uint32_t newBlock(size_t bytes);
+    void discard(Entry& target);
+    void unindex(uint32_t id);
+    void grow();
+};
+
+// ссылка на строку в StringPool::global(): копия добавляет ссылку, деструктор снимает.
+// Так имена NPC и записей журнала уходят из пула вместе с последним владельцем
+class PooledName {
+private:
+    uint32_t id = StringPool::NONE;
+
+public:
+    PooledName() = default;
+    explicit PooledName(std::string_view text) : id(StringPool::global().intern(text)) {}
+    PooledName(const PooledName& other) : id(other.id) {
+        if (id != StringPool::NONE) StringPool::global().retain(id);
+    }
+    PooledName(PooledName&& other) noexcept : id(std::exchange(other.id, StringPool::NONE)) {}
+    PooledName& operator=(PooledName other) noexcept {
+        std::swap(id, other.id);
+        return *this;
+    }
+    ~PooledName() {
+        if (id != StringPool::NONE) StringPool::global().release(id);
+    }
+
+    uint32_t getId() const { return id; }
+    std::string_view view() const { return id == StringPool::NONE ? std::string_view() : StringPool::global().view(id); }
+};
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Фиксированный пул потоков под параллельные циклы, с кражей работы:
+// куски делятся между потоками поровну, поток берет свои с начала, а закончив,
+// отнимает вторую половину оставшихся у соседа. Без общего счетчика кусков
+class ThreadPool {
+private:
+    // ссылка на вызываемый объект без копирования и выделения памяти (в отличие от std::function)
+    struct Task {
+        const void* fn;
+        void (*call)(const void* fn, size_t chunk, size_t worker);
+        void operator()(size_t chunk, size_t worker) const { call(fn, chunk, worker); }
+    };
+
+    // оставшиеся куски потока [next, end) в одном слове - владелец и воры меняют его CAS
+    struct alignas(64) Range {
+        std::atomic<uint64_t> bounds{0};
+    };
+    static uint64_t pack(uint32_t next, uint32_t end) { return (uint64_t{end} << 32) | next; }
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<Range[]> ranges;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const Task* task = nullptr;
+    std::atomic<size_t> finishedChunks{0};
+    size_t chunks = 0;
+    size_t active = 0;          // потоков внутри drain, под mutex
+    size_t generation = 0;
+    bool stopping = false;
+
+    void workerLoop(size_t worker);
+    void drain(size_t worker, const Task& task);
+    bool popOwn(size_t worker, uint32_t& chunk);
+    bool steal(size_t worker, uint32_t& chunk);
+    void runTask(size_t count, const Task& task);
+
+public:
+    // threads == 0 - по числу ядер; вызывающий поток тоже работает, так что создается threads - 1
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // fn(chunk, worker) для каждого chunk из [0, count); возвращается, когда все выполнены.
+    // fn не должна бросать исключения
+    // worker < size(), один worker не выполняет два куска одновременно.
+    // Порядок кусков не задан: каждый поток идет по возрастанию в своей доле.
+    // count < 2^32
+    template <class Fn>
+    void run(size_t count, const Fn& fn) {
+        runTask(count, Task{&fn, [](const void* f, size_t chunk, size_t worker) {
+            (*static_cast<const Fn*>(f))(chunk, worker);
+        }});
+    }
+};
\ No newline at end of file
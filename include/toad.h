@@ -5,7 +5,7 @@
 
 class Toad : public NPC, public std::enable_shared_from_this<Toad> {
 public:
-    Toad(const std::string& name, int x, int y);
+    Toad(std::string_view name, int x, int y, const WorldBounds& bounds = WorldBounds::current());
     
     bool accept(const std::shared_ptr<FightVisitor>& attacker) override;
     
@@ -13,5 +13,5 @@ public:
     bool fight(const std::shared_ptr<Dragon>& other) override;
     bool fight(const std::shared_ptr<Knight>& other) override;
     
-    std::string getType() const override { return "Toad"; }
+    std::string_view getType() const override { return "Toad"; }
 };
\ No newline at end of file
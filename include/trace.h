@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+
+#include "npc.h"
+#include "fightRules.h"
+
+// подробности каждого поединка (кто с кем, чем кончилось) - для отладки
+class IFightTraceSink {
+public:
+    virtual ~IFightTraceSink() = default;
+    virtual void onDuel(const NPC& attacker, const NPC& defender, FightOutcome outcome) = 0;
+};
+
+// прежний вывод: "Toad T1 fights Dragon D1 - Toad wins (eats all)"
+class ConsoleTraceSink : public IFightTraceSink {
+public:
+    void onDuel(const NPC& attacker, const NPC& defender, FightOutcome outcome) override;
+};
+
+// По умолчанию выключено: NPC::duel проверяет один указатель и ничего не форматирует.
+// Устанавливать до боя, не из боевых потоков
+class FightTrace {
+private:
+    inline static std::shared_ptr<IFightTraceSink> owner;
+    inline static IFightTraceSink* active = nullptr;
+
+public:
+    static bool enabled() { return active != nullptr; }
+    static IFightTraceSink* sink() { return active; }
+
+    // nullptr - выключить
+    static void install(std::shared_ptr<IFightTraceSink> sink) {
+        owner = std::move(sink);
+        active = owner.get();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "fightRules.h"
+#include "npc.h"
+#include "observer.h"
+#include "stringPool.h"
+#include "world.h"
+#include "worldBounds.h"
+
+// NPC как значение: без vtable, без shared_ptr и enable_shared_from_this.
+// Тип - параметр шаблона, для поединка он известен при компиляции
+template <NpcType Kind>
+struct NpcUnit {
+    static constexpr NpcType kind = Kind;
+
+    PooledName name;  // как у NPC - ссылка в общем пуле имен
+    int x = 0;
+    int y = 0;
+    bool alive = true;
+};
+
+using ToadUnit = NpcUnit<NpcType::Toad>;
+using DragonUnit = NpcUnit<NpcType::Dragon>;
+using KnightUnit = NpcUnit<NpcType::Knight>;
+
+// порядок альтернатив совпадает с NpcType: index() - это тип
+using NpcValue = std::variant<ToadUnit, DragonUnit, KnightUnit>;
+
+static_assert(std::variant_alternative_t<static_cast<size_t>(NpcType::Toad), NpcValue>::kind == NpcType::Toad);
+static_assert(std::variant_alternative_t<static_cast<size_t>(NpcType::Dragon), NpcValue>::kind == NpcType::Dragon);
+static_assert(std::variant_alternative_t<static_cast<size_t>(NpcType::Knight), NpcValue>::kind == NpcType::Knight);
+
+// исход пары типов по встроенной таблице - константа времени компиляции
+template <class Attacker, class Defender>
+constexpr bool defaultKills() {
+    return defaultFightRules.kills(Attacker::kind, Defender::kind);
+}
+
+// мир из значений NpcValue, подряд в одном векторе; NPC адресуется индексом
+class VariantWorld {
+private:
+    std::vector<NpcValue> values;
+    WorldBounds bounds;
+
+public:
+    // границы по умолчанию - WorldBounds::current() на момент создания, как у NpcWorld
+    VariantWorld() : bounds(WorldBounds::current()) {}
+    explicit VariantWorld(const WorldBounds& bounds) : bounds(bounds) {}
+
+    const WorldBounds& getBounds() const { return bounds; }
+
+    // точка вне границ мира - runtime_error
+    size_t add(NpcType type, std::string_view name, int x, int y);
+    size_t add(NpcValue value);
+    void reserve(size_t count) { values.reserve(count); }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    size_t aliveCount() const;
+
+    const NpcValue& operator[](size_t i) const { return values[i]; }
+    NpcType getType(size_t i) const { return static_cast<NpcType>(values[i].index()); }
+    std::string_view getName(size_t i) const {
+        return std::visit([](const auto& unit) { return unit.name.view(); }, values[i]);
+    }
+    int getX(size_t i) const { return std::visit([](const auto& unit) { return unit.x; }, values[i]); }
+    int getY(size_t i) const { return std::visit([](const auto& unit) { return unit.y; }, values[i]); }
+    bool isAlive(size_t i) const { return std::visit([](const auto& unit) { return unit.alive; }, values[i]); }
+    void kill(size_t i) { std::visit([](auto& unit) { unit.alive = false; }, values[i]); }
+
+    // выбрасывает мертвых, порядок живых сохраняется
+    void removeDead();
+
+    // объект NPC с теми же данными - для наблюдателей и старого API; координаты
+    // проверяются по границам этого мира
+    std::shared_ptr<NPC> materialize(size_t i) const;
+
+    static VariantWorld fromSet(const set_t& npc_collection);
+    set_t toSet() const;
+};
+
+// Раунд как fight(NpcWorld&): нападающие по индексу, убитый сразу выбывает,
+// убитые в порядке гибели. Пара типов разбирается двойным std::visit; при встроенных
+// правилах исход - defaultKills<A, D>(), при установленных - та же таблица по
+// известному при компиляции индексу
+std::vector<size_t> fight(VariantWorld &world, size_t range, const std::shared_ptr<IFFightObserver>& observer = nullptr);
\ No newline at end of file
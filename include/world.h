@@ -0,0 +1,28 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "npc.h"
+#include "factory.h"
+#include "observer.h"
+
+using set_t = std::set<std::shared_ptr<NPC>>;
+
+std::shared_ptr<NPC> createFromStream(std::istream &is);
+// arena != nullptr - NPC размещаются в ней, арена должна пережить мир
+std::shared_ptr<NPC> createNPC(NpcType type, std::string_view name, int x, int y, NpcArena* arena = nullptr);
+
+void saveNPC(const set_t &npc_collection, const std::string &file_name);
+set_t loadNPC(const std::string &file_name, NpcArena* arena = nullptr);
+
+std::ostream &operator<<(std::ostream &os, const set_t &npc_collection);
+
+// раунд боя: соседи ищутся через SpatialGrid, убитые те же, что и у полного перебора
+set_t fight(const set_t &npc_collection, size_t range, const std::shared_ptr<IFFightObserver>& observer = nullptr);
+// эталонный перебор всех пар O(n^2) через FightVisitor
+set_t fightBruteForce(const set_t &npc_collection, size_t range, const std::shared_ptr<IFFightObserver>& observer = nullptr);
+
+std::string generateName(const std::string& type, int n);
\ No newline at end of file
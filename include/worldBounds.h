@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Прямоугольник карты, границы включительно. Координаты - любые int32,
+// дистанции считаются в 64 битах
+struct WorldBounds {
+    int minX = 0;
+    int minY = 0;
+    int maxX = 500;
+    int maxY = 500;
+
+    constexpr bool contains(int x, int y) const {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+    constexpr bool valid() const { return minX <= maxX && minY <= maxY; }
+    constexpr long long width() const { return static_cast<long long>(maxX) - minX; }
+    constexpr long long height() const { return static_cast<long long>(maxY) - minY; }
+
+    constexpr bool operator==(const WorldBounds&) const = default;
+
+    // "0-500" для квадратной карты, иначе "x 0-1000, y -50-50"
+    std::string describe() const;
+
+    // границы для NPC, созданных вне NpcWorld (конструктор NPC, set_t, реестр);
+    // по умолчанию 0-500
+    static const WorldBounds& current();
+    // не вызывать во время боя; неправильный прямоугольник - runtime_error
+    static void install(const WorldBounds& bounds);
+};
+
+constexpr WorldBounds defaultWorldBounds{};
\ No newline at end of file
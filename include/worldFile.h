@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "npcWorld.h"
+#include "threadPool.h"
+
+// Двоичный формат мира (little-endian):
+//   заголовок WorldFileHeader
+//   с версии 2 - границы карты WorldFileBounds (в версии 1 их нет, карта по умолчанию)
+//   count записей WorldFileRecord фиксированной длины
+//   таблица имен: все имена подряд, без разделителей
+// Текстовый формат (saveNPC/loadNPC) остается для импорта/экспорта
+struct WorldFileHeader {
+    char magic[4];          // "DNGW"
+    uint32_t version;
+    uint32_t byteOrder;     // 0x01020304, записанный на машине-авторе
+    uint32_t recordSize;
+    uint64_t count;
+    uint64_t namesBytes;
+};
+
+struct WorldFileBounds {
+    int32_t minX, minY, maxX, maxY;
+};
+
+struct WorldFileRecord {
+    uint8_t type;
+    uint8_t alive;
+    uint16_t reserved;
+    int32_t x;
+    int32_t y;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+static_assert(sizeof(WorldFileHeader) == 32, "header layout is part of the file format");
+static_assert(sizeof(WorldFileBounds) == 16, "bounds layout is part of the file format");
+static_assert(sizeof(WorldFileRecord) == 20, "record layout is part of the file format");
+
+// итог загрузки текстового мира
+struct TextLoadStats {
+    size_t lines = 0;       // всего строк в файле
+    size_t loaded = 0;      // добавлено NPC
+    size_t skipped = 0;     // строки, отвергнутые NPCFactory::parse (неизвестный тип, не хватает полей)
+    size_t bytes = 0;
+    size_t chunks = 0;      // кусков при параллельной загрузке, 1 - последовательная
+    double seconds = 0;
+
+    double linesPerSecond() const { return seconds > 0 ? lines / seconds : 0; }
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0; }
+};
+
+class WorldFile {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    // ошибки ввода-вывода и формата - runtime_error
+    static void saveBinary(const NpcWorld& world, const std::string& file_name);
+    // файл отображается в память (mmap), мир собирается копированием столбцов;
+    // читает и версию 1, границы у такого мира - defaultWorldBounds
+    static NpcWorld loadBinary(const std::string& file_name);
+    // по сигнатуре в начале файла
+    static bool isBinary(const std::string& file_name);
+
+    // Текстовый формат без потоков: файл отображается в память, строки и поля
+    // разбираются на месте (NPCFactory::parse по string_view), неподходящие строки
+    // пропускаются так же, как в loadNPC. false - файл не открылся;
+    // координаты вне карты - runtime_error, как у конструктора NPC.
+    // Пустой world принимает границы из строки #bounds, непустой остается со своими
+    static bool loadText(const std::string& file_name, NpcWorld& world, TextLoadStats* stats = nullptr);
+    // То же на пуле потоков: файл режется на куски по границам строк, каждый кусок
+    // разбирается в свой буфер, буферы дописываются в world в порядке файла.
+    // Результат совпадает с loadText; при координатах вне карты в world остаются
+    // все строки до ошибочной, и бросается то же исключение
+    static bool loadTextParallel(const std::string& file_name, NpcWorld& world, ThreadPool& pool,
+                                 TextLoadStats* stats = nullptr, size_t chunkBytes = size_t{1} << 20);
+    static bool scanText(const std::string& file_name,
+                         const std::function<void(NpcType type, std::string_view name, int x, int y)>& fn);
+};
\ No newline at end of file
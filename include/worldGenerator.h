@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "npc.h"
+#include "npcWorld.h"
+#include "threadPool.h"
+#include "worldBounds.h"
+
+enum class SpawnLayout {
+    Uniform,     // равномерно по всей карте
+    Clustered,   // кучками вокруг clusters центров
+    SingleCell   // все в одном квадрате cellSize - худший случай для сетки
+};
+
+struct WorldGeneratorOptions {
+    size_t count = 0;
+    uint64_t seed = 1;
+    // доли типов по порядку NpcType, сумма > 0 и < 2^32
+    std::array<uint32_t, NPC_TYPE_COUNT> typeWeights{1, 1, 1};
+    SpawnLayout layout = SpawnLayout::Uniform;
+    size_t clusters = 16;
+    int clusterRadius = 25;        // полуширина квадрата вокруг центра кучки
+    int cellSize = 20;             // сторона квадрата SingleCell, обычно радиус боя
+    WorldBounds bounds = defaultWorldBounds;
+    size_t threads = 0;            // 0 - по числу ядер
+    size_t chunkSize = 65536;      // NPC на одну задачу пула
+};
+
+// Генератор больших миров. NPC номер i зависит только от seed и i (хэш splitmix
+// от номера, а не общий поток случайных чисел), поэтому результат не зависит от
+// числа потоков и размера кусков, а любой NPC можно получить отдельно через npcAt.
+// Имена как у generateName: "Toad_12", номер - индекс NPC в мире (в файле - номер строки)
+class WorldGenerator {
+private:
+    WorldGeneratorOptions options;
+    uint64_t totalWeight = 0;
+    std::unique_ptr<ThreadPool> pool;
+
+    // сколько байт займет имя NPC номер i типа type
+    static size_t nameLength(NpcType type, size_t i);
+    static char* writeName(char* out, NpcType type, size_t i);
+
+public:
+    // неправильные границы, нулевые доли типов, count >= 2^32 - runtime_error
+    explicit WorldGenerator(const WorldGeneratorOptions& options = WorldGeneratorOptions());
+
+    const WorldGeneratorOptions& getOptions() const { return options; }
+    size_t threadCount() const { return pool->size(); }
+
+    void npcAt(size_t i, NpcType& type, int& x, int& y) const;
+
+    // Дописывает count NPC в конец world прямо в столбцы, на пуле потоков.
+    // Пустой world принимает границы генератора; непустой должен их вмещать,
+    // иначе runtime_error
+    void generate(NpcWorld& world);
+    NpcWorld generate();
+
+    // Тот же набор в текстовом формате saveNPC (со строкой #bounds): куски
+    // форматируются параллельно и пишутся по порядку, в памяти весь мир не держится.
+    // Ошибки ввода-вывода - runtime_error
+    void generateToFile(const std::string& file_name);
+};
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "npcWorld.h"
+
+// Журнальное сохранение мира: двоичный снимок (WorldFile) + файл <снимок>.journal,
+// куда дописываются только изменения. Формат журнала (little-endian):
+//   заголовок JournalHeader - отпечаток и границы мира, с которого начинается журнал
+//   записи JournalRecord, за каждой - имя (Create) и контрольная сумма
+// Запись, оборванная при сбое, и все после нее при восстановлении отбрасываются.
+// Перед заменой снимка compact() дописывает запись Compact с отпечатком нового
+// снимка: если после сбоя снимок уже новый, а журнал старый, повторяется только
+// то, что после этой записи. Журнал, который не подходит к снимку и не доказывает,
+// что снимок его сменил, не трогается - open() бросает runtime_error
+struct JournalHeader {
+    char magic[4];          // "DNGJ"
+    uint32_t version;
+    uint64_t fingerprint;   // WorldJournal::fingerprint мира из снимка
+    int32_t minX, minY;     // границы того же мира: без снимка мир берет их отсюда
+    int32_t maxX, maxY;
+};
+
+enum class JournalOp : uint8_t {
+    Create = 1,   // add(type, name, x, y)
+    Kill = 2,     // kill(index)
+    Move = 3,     // move(index, x, y)
+    Purge = 4,    // removeDead()
+    Compact = 5   // снимок заменяется миром с отпечатком x | y << 32, мир не меняется
+};
+
+struct JournalRecord {
+    uint8_t op;
+    uint8_t type;
+    uint16_t nameLength;
+    uint32_t index;
+    int32_t x;
+    int32_t y;
+};
+
+static_assert(sizeof(JournalHeader) == 32, "header layout is part of the file format");
+static_assert(sizeof(JournalRecord) == 16, "record layout is part of the file format");
+
+// что нашлось при открытии
+struct JournalRecovery {
+    size_t snapshotNpcs = 0;   // NPC в снимке
+    size_t replayed = 0;       // повторено записей журнала
+    size_t discardedBytes = 0; // оборванный хвост
+    bool staleJournal = false; // журнал от прежнего снимка: повторено только то, что после его замены
+};
+
+// Записи описывают изменения, которые вызывающий уже сделал с миром, индексы - как
+// в NpcWorld. Записи копятся в памяти, commit() дописывает их одним write.
+// Ошибки ввода-вывода и формата - runtime_error
+class WorldJournal {
+public:
+    // версия 2: в отпечатке есть границы карты; версия 3: границы в заголовке
+    static constexpr uint32_t VERSION = 3;
+
+private:
+    std::string snapshotFile;
+    std::string journalFile;
+    size_t compactBytes;
+
+    std::string pending;         // записи до commit()
+    size_t committedBytes = 0;   // размер файла журнала
+    bool opened = false;
+
+    void append(JournalOp op, NpcType type, std::string_view name, size_t index, int x, int y);
+    void startJournal(uint64_t fingerprint, const WorldBounds& bounds);
+
+public:
+    // compactBytes - после какого размера журнала needsCompaction() == true
+    explicit WorldJournal(const std::string& file_name, size_t compactBytes = size_t{64} << 20);
+
+    // Снимок (если есть) и журнал в world (старое содержимое стирается), оборванный
+    // хвост журнала обрезается. Без снимка границы мира берутся из журнала.
+    // Журнал другого мира (например, снимок потерян) - runtime_error, файл не меняется.
+    // Без open() журнал считается пустым миром без снимка
+    JournalRecovery open(NpcWorld& world);
+
+    void create(NpcType type, std::string_view name, int x, int y);
+    void kill(size_t index);
+    // все убитые за раунд
+    void kill(const std::vector<size_t>& indices);
+    void move(size_t index, int x, int y);
+    void purge();
+
+    // дописывает накопленное и сбрасывает на диск; sync - еще и fsync
+    void commit(bool sync = false);
+
+    size_t journalBytes() const { return committedBytes + pending.size(); }
+    size_t pendingBytes() const { return pending.size(); }
+    bool needsCompaction() const { return journalBytes() > compactBytes; }
+
+    // Новый снимок из world (вызывающий применил все записи) и пустой журнал.
+    // В открытый журнал сначала дописывается запись Compact (с fsync); снимок пишется
+    // во временный файл и подменяет старый через rename; временный файл, каталог после
+    // rename и очищенный журнал сбрасываются fsync по порядку
+    void compact(const NpcWorld& world);
+
+    const std::string& getSnapshotFile() const { return snapshotFile; }
+    const std::string& getJournalFile() const { return journalFile; }
+
+    // хеш содержимого мира: границы, типы, имена, координаты, живость, порядок
+    static uint64_t fingerprint(const NpcWorld& world);
+};
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "npc.h"
+#include "worldBounds.h"
+
+// Неизменяемый снимок NpcWorld. NPC лежат кусками по CHUNK, у куска три
+// независимые части: позиции, флаги жизни и "паспорт" (тип и имя). Снимки
+// делят общие части через shared_ptr, так что новый снимок хранит заново только
+// то, что изменилось с прошлого: после раунда боя - флаги кусков с убитыми.
+// Копия снимка - O(1), снимки безопасно читать из разных потоков. Снять снимок
+// дороже: см. NpcWorld::snapshot
+class WorldSnapshot {
+    friend class NpcWorld;
+
+public:
+    static constexpr size_t CHUNK = 4096;
+
+    WorldSnapshot();
+
+    size_t size() const { return data->count; }
+    bool empty() const { return data->count == 0; }
+    const WorldBounds& getBounds() const { return data->bounds; }
+    size_t chunkCount() const { return data->chunks.size(); }
+
+    int getX(size_t i) const { return data->chunks[i / CHUNK].positions->xs[i % CHUNK]; }
+    int getY(size_t i) const { return data->chunks[i / CHUNK].positions->ys[i % CHUNK]; }
+    NpcType getType(size_t i) const { return data->chunks[i / CHUNK].identity->types[i % CHUNK]; }
+    std::string_view getName(size_t i) const;
+    bool isAlive(size_t i) const { return data->chunks[i / CHUNK].flags->alive[i % CHUNK] != 0; }
+
+    // все части, на которые ссылается снимок
+    size_t memoryUsage() const;
+    // части, которых нет в other на тех же местах - столько памяти добавил этот
+    // снимок, если other уже есть
+    size_t changedBytes(const WorldSnapshot& other) const;
+
+private:
+    struct Positions {
+        std::vector<int> xs, ys;
+    };
+    struct Flags {
+        std::vector<uint8_t> alive;
+    };
+    struct Identity {
+        std::vector<NpcType> types;
+        std::string names;                // имена куска подряд
+        std::vector<uint32_t> nameStart;  // от начала names куска, размер куска + 1
+    };
+    struct Chunk {
+        std::shared_ptr<const Positions> positions;
+        std::shared_ptr<const Flags> flags;
+        std::shared_ptr<const Identity> identity;
+    };
+    struct Data {
+        size_t count = 0;
+        WorldBounds bounds;
+        std::vector<Chunk> chunks;
+    };
+
+    std::shared_ptr<const Data> data;
+
+    explicit WorldSnapshot(std::shared_ptr<const Data> data) : data(std::move(data)) {}
+};
\ No newline at end of file
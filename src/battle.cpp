@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "battle.h"
+#include "fightRules.h"
+#include "metrics.h"
+#include "trace.h"
+
+Battle::Battle(const BattleOptions& options) : options(options) {
+    if (this->options.chunkSize == 0) this->options.chunkSize = 1;
+    if (this->options.mode == BattleMode::Parallel) {
+        pool = std::make_unique<ThreadPool>(this->options.threads);
+    }
+}
+
+std::vector<size_t> Battle::round(NpcWorld& world, size_t range, const std::shared_ptr<IFFightObserver>& observer) {
+    std::vector<size_t> killed;
+    round(world, range, killed, observer);
+    return killed;
+}
+
+void Battle::round(NpcWorld& world, size_t range, std::vector<size_t>& killed, const std::shared_ptr<IFFightObserver>& observer) {
+    if (options.mode == BattleMode::Sequential) {
+        fight(world, range, grid, killed, observer);
+        return;
+    }
+    parallelRound(world, range, killed, observer);
+}
+
+void Battle::round(NpcWorld& world, size_t range, const SpatialGrid& prebuilt, std::vector<size_t>& killed) {
+    if (!pool) {
+        throw std::runtime_error("Battle on a prebuilt grid needs BattleMode::Parallel");
+    }
+    if (prebuilt.size() != world.size()) {
+        throw std::runtime_error("Battle grid does not match the world");
+    }
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    killed.clear();
+    if (FightTrace::enabled()) {
+        orderedRound(world, range, prebuilt, killed, nullptr);
+        return;
+    }
+    resolve(world, range, prebuilt, killed);
+}
+
+void Battle::resolve(NpcWorld& world, size_t range, const SpatialGrid& cells, std::vector<size_t>& killed) {
+    // достаточно знать, что защитника кто-то победил
+    const size_t count = world.size();
+    const uint8_t* alive = world.aliveData();
+    const FightRules& rules = FightRules::current();
+    const size_t chunkCount = (count + options.chunkSize - 1) / options.chunkSize;
+
+    if (doomed.size() < count) doomed = std::vector<std::atomic<uint8_t>>(count);
+    pool->run(chunkCount, [&](size_t chunk, size_t) {
+        size_t begin = chunk * options.chunkSize;
+        size_t end = std::min(count, begin + options.chunkSize);
+        for (size_t i = begin; i < end; ++i) doomed[i].store(0, std::memory_order_relaxed);
+    });
+    // нападающие в порядке ячеек сетки: у соседних по очереди те же соседние ячейки
+    // уже в кэше. Флаги от порядка не зависят
+    pool->run(chunkCount, [&](size_t chunk, size_t) {
+        size_t begin = chunk * options.chunkSize;
+        size_t end = std::min(count, begin + options.chunkSize);
+        for (size_t slot = begin; slot < end; ++slot) {
+            const uint32_t a = cells.idAt(slot);
+            if (!alive[a]) continue;
+            const NpcType attackerType = world.getType(a);
+            cells.forEachInRange(cells.xAt(slot), cells.yAt(slot), range, [&](uint32_t d) {
+                if (d == a || !alive[d]) return;
+                // метрика до пропуска: счет не зависит от того, какой поток успел первым
+                DUNGEON_METRIC_FIGHT(attackerType, world.getType(d));
+                // сначала чтение - не гоняем строку кэша между ядрами зря
+                if (doomed[d].load(std::memory_order_relaxed)) return;
+                if (rules.kills(attackerType, world.getType(d))) {
+                    doomed[d].store(1, std::memory_order_relaxed);
+                }
+            });
+        }
+    });
+    for (size_t d = 0; d < count; ++d) {
+        if (doomed[d].load(std::memory_order_relaxed)) {
+            world.kill(d);
+            killed.push_back(d);
+            DUNGEON_METRIC_ADD(Kills, 1);
+        }
+    }
+}
+
+void Battle::parallelRound(NpcWorld& world, size_t range, std::vector<size_t>& killed, const std::shared_ptr<IFFightObserver>& observer) {
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    grid.build(world.xData(), world.yData(), world.size(), range);
+
+    killed.clear();
+    if (!observer && !FightTrace::enabled()) {
+        resolve(world, range, grid, killed);
+        return;
+    }
+    orderedRound(world, range, grid, killed, observer.get());
+}
+
+void Battle::orderedRound(NpcWorld& world, size_t range, const SpatialGrid& cells, std::vector<size_t>& killed,
+                          IFFightObserver* observer) {
+    const size_t count = world.size();
+    const int* xs = world.xData();
+    const int* ys = world.yData();
+    const uint8_t* alive = world.aliveData();
+    const FightRules& rules = FightRules::current();
+    const size_t chunkCount = (count + options.chunkSize - 1) / options.chunkSize;
+
+    // этап 1 пишет предложенные бои в очередь, этап 2 - отдельный поток-читатель -
+    // фиксирует их в порядке кусков одновременно с этапом 1. Мир до конца раунда
+    // только читается: убитые копятся в doomed и переносятся в world после
+    if (doomed.size() < count) doomed = std::vector<std::atomic<uint8_t>>(count);
+    for (size_t d = 0; d < count; ++d) doomed[d].store(0, std::memory_order_relaxed);
+    sequencer.reset(static_cast<uint32_t>(chunkCount));
+
+    std::vector<std::shared_ptr<NPC>> objects(count);
+    auto object = [&](size_t i) -> const std::shared_ptr<NPC>& {
+        if (!objects[i]) objects[i] = world.materialize(i);
+        return objects[i];
+    };
+
+    // исключение наблюдателя ловится в читателе: тот дочитывает очередь, чтобы
+    // писатели не встали на полной очереди, и оно бросается дальше после join.
+    // jthread при раскрутке стека останавливает и дожидается читателя сам
+    std::exception_ptr error;
+    std::jthread committer([&](std::stop_token stop) {
+        sequencer.drain(events, [&](const FightEvent& event) {
+            if (error || doomed[event.defender].load(std::memory_order_relaxed)) return;
+            try {
+                if (FightTrace::enabled()) {
+                    FightOutcome outcome = rules.resolve(world.getType(event.attacker), world.getType(event.defender));
+                    FightTrace::sink()->onDuel(*object(event.attacker), *object(event.defender), outcome);
+                }
+                if (observer && observer->accepts(world.getType(event.attacker), world.getType(event.defender),
+                                                  event.success)) {
+                    DUNGEON_METRIC_TIMER(ObserverCall);
+                    observer->onFight(object(event.attacker), object(event.defender), event.success);
+                }
+                if (event.success) {
+                    doomed[event.defender].store(1, std::memory_order_relaxed);
+                    if (objects[event.defender]) objects[event.defender]->kill();
+                    killed.push_back(event.defender);
+                    DUNGEON_METRIC_ADD(Kills, 1);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }, stop);
+    });
+
+    // этап 1: только чтение мира
+    pool->run(chunkCount, [&](size_t chunk, size_t) {
+        FightEventStream out(events, static_cast<uint32_t>(chunk));
+        size_t begin = chunk * options.chunkSize;
+        size_t end = std::min(count, begin + options.chunkSize);
+        for (size_t a = begin; a < end; ++a) {
+            if (!alive[a]) continue;
+            const NpcType attackerType = world.getType(a);
+            cells.forEachInRange(xs[a], ys[a], range, [&](uint32_t d) {
+                if (d == a || !alive[d]) return;
+                DUNGEON_METRIC_FIGHT(attackerType, world.getType(d));
+                // отметку ставят только уже зафиксированные, т.е. более ранние бои -
+                // читатель все равно пропустил бы это событие
+                if (doomed[d].load(std::memory_order_relaxed)) return;
+                out.publish(static_cast<uint32_t>(a), d, rules.kills(attackerType, world.getType(d)));
+            });
+        }
+        out.close();
+    });
+    committer.join();
+
+    // как в Sequential: убитые до исключения остаются убитыми
+    for (size_t d : killed) world.kill(d);
+    std::sort(killed.begin(), killed.end());
+    if (error) std::rethrow_exception(error);
+}
\ No newline at end of file
@@ -1,39 +1,138 @@
+#include <charconv>
+
 #include "factory.h"
 #include "toad.h"     
 #include "dragon.h"
 #include "knight.h"
 
-std::shared_ptr<NPC> NPCFactory::create(NpcType type, const std::string& name, int x, int y) {
+const char* npcTypeName(NpcType type) {
+    switch (type) {
+        case NpcType::Toad:   return "Toad";
+        case NpcType::Dragon: return "Dragon";
+        case NpcType::Knight: return "Knight";
+        default:              return "Unknown";
+    }
+}
+
+bool parseNpcType(std::string_view name, NpcType& type) {
+    if (name == "Toad") {
+        type = NpcType::Toad;
+    } else if (name == "Dragon") {
+        type = NpcType::Dragon;
+    } else if (name == "Knight") {
+        type = NpcType::Knight;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<NPC> NPCFactory::create(NpcType type, std::string_view name, int x, int y) {
+    return create(type, name, x, y, WorldBounds::current());
+}
+
+std::shared_ptr<NPC> NPCFactory::create(NpcType type, std::string_view name, int x, int y, const WorldBounds& bounds) {
     switch (type) {
         case NpcType::Toad:    
-            return std::make_shared<Toad>(name, x, y);
+            return std::make_shared<Toad>(name, x, y, bounds);
+        case NpcType::Dragon:
+            return std::make_shared<Dragon>(name, x, y, bounds);
+        case NpcType::Knight:
+            return std::make_shared<Knight>(name, x, y, bounds);
+        default:
+            return nullptr;
+    }
+}
+
+std::shared_ptr<NPC> NPCFactory::create(NpcType type, std::string_view name, int x, int y, NpcArena& arena) {
+    switch (type) {
+        case NpcType::Toad:
+            return arena.make<Toad>(name, x, y);
         case NpcType::Dragon:
-            return std::make_shared<Dragon>(name, x, y);
+            return arena.make<Dragon>(name, x, y);
         case NpcType::Knight:
-            return std::make_shared<Knight>(name, x, y);
+            return arena.make<Knight>(name, x, y);
         default:
             return nullptr;
     }
 }
 
 std::shared_ptr<NPC> NPCFactory::create(std::istream& is) {
-    std::string type, name;
+    NpcType type;
+    std::string name;
     int x, y;
     
-    if (is >> type >> name >> x >> y) {
-        if (type == "Toad") { 
-            return std::make_shared<Toad>(name, x, y);
-        } else if (type == "Dragon") {
-            return std::make_shared<Dragon>(name, x, y);
-        } else if (type == "Knight") {
-            return std::make_shared<Knight>(name, x, y);
-        }
+    if (parse(is, type, name, x, y)) {
+        return create(type, name, x, y);
     }
     return nullptr;
 }
 
+bool NPCFactory::parse(std::istream& is, NpcType& type, std::string& name, int& x, int& y) {
+    std::string typeName;
+    if (is >> typeName >> name >> x >> y) {
+        return parseNpcType(typeName, type);
+    }
+    return false;
+}
+
+// пробельные символы локали "C", как у operator>>
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static bool nextToken(const char*& p, const char* end, std::string_view& token) {
+    while (p < end && isBlank(*p)) ++p;
+    const char* start = p;
+    while (p < end && !isBlank(*p)) ++p;
+    token = std::string_view(start, static_cast<size_t>(p - start));
+    return p != start;
+}
+
+// как operator>>(int&): пробелы, знак, хотя бы одна цифра, остаток после цифр не трогаем
+static bool nextInt(const char*& p, const char* end, int& value) {
+    while (p < end && isBlank(*p)) ++p;
+    const char* digits = p;
+    if (digits < end && (*digits == '+' || *digits == '-')) ++digits;
+    if (digits == end || *digits < '0' || *digits > '9') return false;
+    // from_chars понимает '-', но не '+'
+    auto result = std::from_chars(*p == '+' ? digits : p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+bool NPCFactory::parse(std::string_view line, NpcType& type, std::string_view& name, int& x, int& y) {
+    const char* p = line.data();
+    const char* end = p + line.size();
+    std::string_view typeName;
+    return nextToken(p, end, typeName) && nextToken(p, end, name)
+        && nextInt(p, end, x) && nextInt(p, end, y)
+        && parseNpcType(typeName, type);
+}
+
 void NPCFactory::save(const std::shared_ptr<NPC>& npc, std::ostream& os) {
     if (npc) {
         os << npc->getType() << " " << npc->getName() << " " << npc->getX() << " " << npc->getY() << "\n";
     }
+}
+
+void NPCFactory::saveBounds(const WorldBounds& bounds, std::ostream& os) {
+    if (bounds != defaultWorldBounds) {
+        os << "#bounds " << bounds.minX << " " << bounds.minY << " " << bounds.maxX << " " << bounds.maxY << "\n";
+    }
+}
+
+bool NPCFactory::parseBounds(std::string_view line, WorldBounds& bounds) {
+    const char* p = line.data();
+    const char* end = p + line.size();
+    std::string_view tag;
+    WorldBounds parsed;
+    if (!nextToken(p, end, tag) || tag != "#bounds"
+        || !nextInt(p, end, parsed.minX) || !nextInt(p, end, parsed.minY)
+        || !nextInt(p, end, parsed.maxX) || !nextInt(p, end, parsed.maxY) || !parsed.valid()) {
+        return false;
+    }
+    bounds = parsed;
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+#include "fightEventQueue.h"
+
+FightEventQueue::FightEventQueue(size_t capacity) {
+    size_t size = std::bit_ceil(std::max<size_t>(capacity, 2));
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        slots[i].turn.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool FightEventQueue::tryPush(const FightEvent& event) {
+    size_t position = head.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots[position & mask];
+        size_t turn = slot.turn.load(std::memory_order_acquire);
+        if (turn == position) {
+            // слот свободен на этом ходу - забираем позицию
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.event = event;
+                slot.turn.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (turn < position) {
+            // читатель еще не освободил слот с прошлого круга
+            return false;
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void FightEventQueue::push(const FightEvent& event) {
+    while (!tryPush(event)) {
+        std::this_thread::yield();
+    }
+}
+
+bool FightEventQueue::tryPop(FightEvent& event) {
+    Slot& slot = slots[tail & mask];
+    if (slot.turn.load(std::memory_order_acquire) != tail + 1) return false;
+    event = slot.event;
+    slot.turn.store(tail + mask + 1, std::memory_order_release);
+    ++tail;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "fightRules.h"
+#include "factory.h"
+
+namespace {
+    FightRules activeRules = defaultFightRules;
+}
+
+const char* fightOutcomeName(FightOutcome outcome) {
+    switch (outcome) {
+        case FightOutcome::Win:  return "win";
+        case FightOutcome::Lose: return "lose";
+        default:                 return "draw";
+    }
+}
+
+static bool parseOutcome(const std::string& text, FightOutcome& outcome) {
+    if (text == "win") {
+        outcome = FightOutcome::Win;
+    } else if (text == "lose") {
+        outcome = FightOutcome::Lose;
+    } else if (text == "draw") {
+        outcome = FightOutcome::Draw;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+FightRules FightRules::load(std::istream& is) {
+    FightRules rules;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(is, line)) {
+        ++line_number;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream stream(line);
+        std::string attacker, defender, outcome, extra;
+        if (!(stream >> attacker)) continue;  // пустая строка
+
+        NpcType a, d;
+        FightOutcome o;
+        if (!(stream >> defender >> outcome) || (stream >> extra)
+            || !parseNpcType(attacker, a) || !parseNpcType(defender, d) || !parseOutcome(outcome, o)) {
+            throw std::runtime_error("Bad fight rule at line " + std::to_string(line_number) + ": " + line);
+        }
+        rules.set(a, d, o);
+    }
+    return rules;
+}
+
+FightRules FightRules::loadFile(const std::string& file_name) {
+    std::ifstream file(file_name);
+    if (!file.is_open()) {
+        throw std::runtime_error("Can't open fight rules: " + file_name);
+    }
+    return load(file);
+}
+
+void FightRules::save(std::ostream& os) const {
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a) {
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d) {
+            NpcType attacker = static_cast<NpcType>(a);
+            NpcType defender = static_cast<NpcType>(d);
+            os << npcTypeName(attacker) << " " << npcTypeName(defender) << " "
+               << fightOutcomeName(resolve(attacker, defender)) << "\n";
+        }
+    }
+}
+
+const FightRules& FightRules::current() {
+    return activeRules;
+}
+
+void FightRules::install(const FightRules& rules) {
+    activeRules = rules;
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "fightVisitor.h"
 #include "observer.h"
+#include "metrics.h"
 #include "toad.h"    
 #include "dragon.h"
 #include "knight.h"
@@ -10,6 +11,7 @@ FightVisitor::FightVisitor(const std::shared_ptr<NPC>& attacker, const std::shar
 bool FightVisitor::visit(const std::shared_ptr<Toad>& defender) {   
     bool success = attacker->fight(defender);
     if (observer) { // наблюдатель передается в визитор
+        DUNGEON_METRIC_TIMER(ObserverCall);
         observer->onFight(attacker, defender, success);
     }
     return success;
@@ -18,6 +20,7 @@ bool FightVisitor::visit(const std::shared_ptr<Toad>& defender) {
 bool FightVisitor::visit(const std::shared_ptr<Dragon>& defender) {
     bool success = attacker->fight(defender);
     if (observer) {
+        DUNGEON_METRIC_TIMER(ObserverCall);
         observer->onFight(attacker, defender, success);
     }
     return success;
@@ -26,6 +29,7 @@ bool FightVisitor::visit(const std::shared_ptr<Dragon>& defender) {
 bool FightVisitor::visit(const std::shared_ptr<Knight>& defender) {
     bool success = attacker->fight(defender);
     if (observer) {
+        DUNGEON_METRIC_TIMER(ObserverCall);
         observer->onFight(attacker, defender, success);
     }
     return success;
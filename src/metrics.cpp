@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "metrics.h"
+#include "factory.h"
+
+namespace {
+
+// блоки живут до конца программы: снимок читает и блоки завершившихся потоков
+std::mutex registryMutex;
+std::vector<std::unique_ptr<Metrics::ThreadBlock>>& registry() {
+    static std::vector<std::unique_ptr<Metrics::ThreadBlock>> blocks;
+    return blocks;
+}
+
+void printNs(std::ostream& os, double ns) {
+    if (ns < 1e3) os << ns << " ns";
+    else if (ns < 1e6) os << ns / 1e3 << " us";
+    else os << ns / 1e6 << " ms";
+}
+
+}
+
+const char* metricCounterName(MetricCounter counter) {
+    switch (counter) {
+        case MetricCounter::PairsExamined: return "pairs examined";
+        case MetricCounter::PairsInRange:  return "pairs in range";
+        case MetricCounter::Kills:         return "kills";
+        case MetricCounter::Rounds:        return "rounds";
+        default:                           return "unknown";
+    }
+}
+
+const char* metricHistogramName(MetricHistogram histogram) {
+    switch (histogram) {
+        case MetricHistogram::ObserverCall: return "observer call";
+        case MetricHistogram::Round:        return "round";
+        default:                            return "unknown";
+    }
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t ns) {
+    size_t bucket = 0;
+    while (ns > 1 && bucket + 1 < BUCKETS) {
+        ns >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+uint64_t LatencyHistogram::percentileNs(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::max(1.0, q * static_cast<double>(count) + 0.5));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        seen += buckets[b];
+        if (seen >= rank) return std::min(maxNs, (uint64_t{2} << b) - 1);
+    }
+    return maxNs;
+}
+
+uint64_t MetricsSnapshot::fightCount() const {
+    uint64_t total = 0;
+    for (const auto& row : fights) {
+        for (uint64_t n : row) total += n;
+    }
+    return total;
+}
+
+namespace {
+
+// отдает блок обратно в реестр при выходе потока
+struct BlockRelease {
+    Metrics::ThreadBlock* block = nullptr;
+    ~BlockRelease() {
+        if (!block) return;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        block->inUse = false;
+    }
+};
+
+}
+
+Metrics::ThreadBlock* Metrics::acquire() {
+    thread_local BlockRelease release;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& blocks = registry();
+    ThreadBlock* block = nullptr;
+    for (auto& candidate : blocks) {
+        if (!candidate->inUse.load(std::memory_order_relaxed)) {
+            block = candidate.get();
+            break;
+        }
+    }
+    if (!block) {
+        blocks.push_back(std::make_unique<ThreadBlock>());
+        block = blocks.back().get();
+    }
+    block->inUse = true;
+    release.block = block;
+    return block;
+}
+
+void Metrics::record(MetricHistogram histogram, uint64_t ns) {
+    auto& h = local().histograms[static_cast<size_t>(histogram)];
+    bump(h.buckets[LatencyHistogram::bucketOf(ns)], 1);
+    bump(h.count, 1);
+    bump(h.totalNs, ns);
+    if (ns > h.maxNs.load(std::memory_order_relaxed)) h.maxNs.store(ns, std::memory_order_relaxed);
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot result;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& block : registry()) {
+        for (size_t c = 0; c < METRIC_COUNTER_COUNT; ++c) {
+            result.counters[c] += block->counters[c].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < NPC_TYPE_COUNT * NPC_TYPE_COUNT; ++i) {
+            result.fights[i / NPC_TYPE_COUNT][i % NPC_TYPE_COUNT] += block->fights[i].load(std::memory_order_relaxed);
+        }
+        for (size_t h = 0; h < METRIC_HISTOGRAM_COUNT; ++h) {
+            const auto& from = block->histograms[h];
+            LatencyHistogram& to = result.histograms[h];
+            for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+            }
+            to.count += from.count.load(std::memory_order_relaxed);
+            to.totalNs += from.totalNs.load(std::memory_order_relaxed);
+            to.maxNs = std::max(to.maxNs, from.maxNs.load(std::memory_order_relaxed));
+        }
+    }
+    result.threads = registry().size();
+    return result;
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& block : registry()) {
+        for (auto& c : block->counters) c.store(0, std::memory_order_relaxed);
+        for (auto& f : block->fights) f.store(0, std::memory_order_relaxed);
+        for (auto& h : block->histograms) {
+            for (auto& b : h.buckets) b.store(0, std::memory_order_relaxed);
+            h.count.store(0, std::memory_order_relaxed);
+            h.totalNs.store(0, std::memory_order_relaxed);
+            h.maxNs.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const MetricsSnapshot& snapshot) {
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+
+    const LatencyHistogram& round = snapshot.histogram(MetricHistogram::Round);
+    os << "     Metrics     " << std::endl
+       << "Rounds: " << snapshot.counter(MetricCounter::Rounds) << ", wall time ";
+    printNs(os, static_cast<double>(round.totalNs));
+    os << std::endl
+       << "Pairs examined: " << snapshot.counter(MetricCounter::PairsExamined)
+       << ", in range: " << snapshot.counter(MetricCounter::PairsInRange) << std::endl
+       << "Fights: " << snapshot.fightCount() << ", kills: " << snapshot.counter(MetricCounter::Kills) << std::endl;
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a) {
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d) {
+            if (snapshot.fights[a][d] == 0) continue;
+            os << "  " << npcTypeName(static_cast<NpcType>(a)) << " -> "
+               << npcTypeName(static_cast<NpcType>(d)) << ": " << snapshot.fights[a][d] << std::endl;
+        }
+    }
+
+    const LatencyHistogram& observer = snapshot.histogram(MetricHistogram::ObserverCall);
+    if (observer.count) {
+        os << "Observer calls: " << observer.count << ", total ";
+        printNs(os, static_cast<double>(observer.totalNs));
+        os << ", mean ";
+        printNs(os, observer.meanNs());
+        os << ", p50 <= ";
+        printNs(os, static_cast<double>(observer.percentileNs(0.5)));
+        os << ", p99 <= ";
+        printNs(os, static_cast<double>(observer.percentileNs(0.99)));
+        os << ", max ";
+        printNs(os, static_cast<double>(observer.maxNs));
+        os << std::endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
\ No newline at end of file
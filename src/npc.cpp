@@ -1,17 +1,45 @@
 #include <cmath>
+#include <stdexcept>
 
 #include "npc.h"
+#include "fightRules.h"
+#include "metrics.h"
+#include "trace.h"
 
-NPC::NPC(const std::string& name, int x, int y) 
-    : name(name), x(x), y(y), alive(true) {
-    if (x < 0 || x > 500 || y < 0 || y > 500) {
-        throw std::runtime_error("NPC coordinates must be in range 0-500");
+NPC::NPC(NpcType kind, std::string_view name, int x, int y, const WorldBounds& bounds)
+    : name(name), x(x), y(y), alive(true), kind(kind) {
+    checkCoordinates(x, y, bounds);
+}
+
+void NPC::moveTo(int newX, int newY) {
+    checkCoordinates(newX, newY);
+    x = newX;
+    y = newY;
+}
+
+void NPC::checkCoordinates(int x, int y) {
+    checkCoordinates(x, y, WorldBounds::current());
+}
+
+void NPC::checkCoordinates(int x, int y, const WorldBounds& bounds) {
+    if (!bounds.contains(x, y)) {
+        throw std::runtime_error("NPC coordinates must be in range " + bounds.describe());
     }
 }
 
 double NPC::distance(const std::shared_ptr<NPC>& other) const {
     if (!other) return 0;
-    int dx = x - other->x;
-    int dy = y - other->y;
+    // разность двух int32 не помещается в int
+    double dx = static_cast<double>(x) - other->x;
+    double dy = static_cast<double>(y) - other->y;
     return std::sqrt(dx * dx + dy * dy);
+}
+
+bool NPC::duel(const NPC& other) const {
+    FightOutcome outcome = FightRules::current().resolve(kind, other.kind);
+    DUNGEON_METRIC_FIGHT(kind, other.kind);
+    if (FightTrace::enabled()) {
+        FightTrace::sink()->onDuel(*this, other, outcome);
+    }
+    return outcome == FightOutcome::Win;
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+
+#include "npcRegistry.h"
+#include "factory.h"
+#include "fightLoop.h"
+#include "metrics.h"
+#include "spatialGrid.h"
+#include "worldFile.h"
+
+NpcHandle NpcRegistry::insert(std::shared_ptr<NPC> npc) {
+    if (!npc) return NpcHandle();
+
+    uint32_t slot;
+    if (freeHead != NO_SLOT) {
+        slot = freeHead;
+        freeHead = slots[slot].dense;
+    } else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back({0, 0, false});
+    }
+    slots[slot].dense = static_cast<uint32_t>(objects.size());
+    slots[slot].used = true;
+    objects.push_back(std::move(npc));
+    slotOf.push_back(slot);
+    return {slot, slots[slot].generation};
+}
+
+NpcHandle NpcRegistry::create(NpcType type, std::string_view name, int x, int y, NpcArena* arena) {
+    if (arena) return insert(NPCFactory::create(type, name, x, y, *arena));
+    return insert(NPCFactory::create(type, name, x, y));
+}
+
+bool NpcRegistry::contains(NpcHandle handle) const {
+    return handle.index < slots.size() && slots[handle.index].used
+        && slots[handle.index].generation == handle.generation;
+}
+
+NPC* NpcRegistry::get(NpcHandle handle) const {
+    return contains(handle) ? objects[slots[handle.index].dense].get() : nullptr;
+}
+
+std::shared_ptr<NPC> NpcRegistry::share(NpcHandle handle) const {
+    return contains(handle) ? objects[slots[handle.index].dense] : nullptr;
+}
+
+bool NpcRegistry::remove(NpcHandle handle) {
+    if (!contains(handle)) return false;
+
+    // последний объект занимает место удаленного
+    uint32_t dense = slots[handle.index].dense;
+    uint32_t last = static_cast<uint32_t>(objects.size() - 1);
+    if (dense != last) {
+        objects[dense] = std::move(objects[last]);
+        slotOf[dense] = slotOf[last];
+        slots[slotOf[dense]].dense = dense;
+    }
+    objects.pop_back();
+    slotOf.pop_back();
+
+    Slot& slot = slots[handle.index];
+    slot.used = false;
+    ++slot.generation;
+    slot.dense = freeHead;
+    freeHead = handle.index;
+    return true;
+}
+
+size_t NpcRegistry::removeDead() {
+    // один проход со сжатием: порядок живых не меняется
+    size_t kept = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        uint32_t slot = slotOf[i];
+        if (!objects[i]->isAlive()) {
+            Slot& freed = slots[slot];
+            freed.used = false;
+            ++freed.generation;
+            freed.dense = freeHead;
+            freeHead = slot;
+            continue;
+        }
+        if (kept != i) {
+            objects[kept] = std::move(objects[i]);
+            slotOf[kept] = slot;
+        }
+        slots[slot].dense = static_cast<uint32_t>(kept);
+        ++kept;
+    }
+    size_t removed = objects.size() - kept;
+    objects.resize(kept);
+    slotOf.resize(kept);
+    return removed;
+}
+
+void NpcRegistry::clear() {
+    while (!objects.empty()) {
+        remove(handleAt(objects.size() - 1));
+    }
+}
+
+void NpcRegistry::reserve(size_t count) {
+    slots.reserve(count);
+    objects.reserve(count);
+    slotOf.reserve(count);
+}
+
+namespace {
+
+// NpcRegistry для runFightLoop: объекты уже есть, наблюдатель получает handle
+struct RegistryRound {
+    NpcRegistry& registry;
+    IRegistryFightObserver* observer;
+    std::vector<NpcHandle>& killed;
+
+    bool alive(size_t i) const { return registry.at(i)->isAlive(); }
+    bool duel(size_t a, size_t d) const { return registry.at(a)->duel(*registry.at(d)); }
+    bool observed() const { return observer != nullptr; }
+    void observe(size_t a, size_t d, bool victory) {
+        observer->onFight(registry, registry.handleAt(a), registry.handleAt(d), victory);
+    }
+    void kill(size_t d) {
+        registry.at(d)->kill();
+        killed.push_back(registry.handleAt(d));
+    }
+};
+
+}
+
+std::vector<NpcHandle> fight(NpcRegistry &registry, size_t range,
+                             const std::shared_ptr<IRegistryFightObserver>& observer)
+{
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    std::vector<NpcHandle> killed;
+
+    const size_t count = registry.size();
+    std::vector<int> xs(count), ys(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = registry.at(i)->getX();
+        ys[i] = registry.at(i)->getY();
+    }
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), count, range);
+
+    // защитники по индексу, как при полном переборе
+    std::vector<uint32_t> candidates;
+    RegistryRound round{registry, observer.get(), killed};
+    runFightLoop(grid, xs.data(), ys.data(), count, range, round, &candidates);
+    return killed;
+}
+
+void saveNPC(const NpcRegistry &registry, const std::string &file_name)
+{
+    std::ofstream file(file_name);
+    NPCFactory::saveBounds(WorldBounds::current(), file);
+    for (size_t i = 0; i < registry.size(); ++i) {
+        NPCFactory::save(registry.at(i), file);
+    }
+    file.flush();
+    file.close();
+    std::cout << "Saved " << registry.size() << " NPC in " << file_name << std::endl;
+}
+
+bool loadNPC(const std::string &file_name, NpcRegistry &registry, NpcArena* arena)
+{
+    size_t before = registry.size();
+    bool opened = WorldFile::scanText(file_name, [&](NpcType type, std::string_view name, int x, int y) {
+        registry.create(type, name, x, y, arena);
+    });
+    if (!opened) {
+        std::cerr << "Err: can't open file: " << file_name << std::endl;
+        return false;
+    }
+    std::cout << "Loaded " << registry.size() - before << " NPC from " << file_name << std::endl;
+    return true;
+}
+
+std::ostream &operator<<(std::ostream &os, const NpcRegistry &registry)
+{
+    os << "Total NPCs: " << registry.size() << std::endl;
+    for (size_t i = 0; i < registry.size(); ++i) {
+        const auto &n = registry.at(i);
+        os << n->getType() << " \"" << n->getName()
+           << "\" at position: (" << n->getX() << ", " << n->getY() << ")"
+           << " - " << (n->isAlive() ? "Alive" : "Dead") << std::endl;
+    }
+    return os;
+}
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "npcWorld.h"
+#include "fightLoop.h"
+#include "fightRules.h"
+#include "metrics.h"
+#include "spatialGrid.h"
+#include "trace.h"
+#include "worldFile.h"
+
+void NpcWorld::setBounds(const WorldBounds& newBounds) {
+    if (!newBounds.valid()) {
+        throw std::runtime_error("World bounds are empty: " + newBounds.describe());
+    }
+    for (size_t i = 0; i < size(); ++i) {
+        NPC::checkCoordinates(xs[i], ys[i], newBounds);
+    }
+    bounds = newBounds;
+}
+
+size_t NpcWorld::add(NpcType type, std::string_view name, int x, int y) {
+    NPC::checkCoordinates(x, y, bounds);
+    touchAll(size());
+    xs.push_back(x);
+    ys.push_back(y);
+    types.push_back(type);
+    alive.push_back(1);
+    names.append(name);
+    nameStart.push_back(static_cast<uint32_t>(names.size()));
+    return types.size() - 1;
+}
+
+void NpcWorld::move(size_t i, int x, int y) {
+    NPC::checkCoordinates(x, y, bounds);
+    xs[i] = x;
+    ys[i] = y;
+    touch(dirtyPositions, i);
+}
+
+void NpcWorld::reserve(size_t count, size_t nameBytes) {
+    xs.reserve(count);
+    ys.reserve(count);
+    types.reserve(count);
+    alive.reserve(count);
+    nameStart.reserve(count + 1);
+    names.reserve(nameBytes);
+}
+
+void NpcWorld::clear() {
+    xs.clear();
+    ys.clear();
+    types.clear();
+    alive.clear();
+    names.clear();
+    nameStart.assign(1, 0);
+    forgetSnapshot();
+}
+
+void NpcWorld::forgetSnapshot() {
+    base.reset();
+    dirtyPositions.clear();
+    dirtyFlags.clear();
+    dirtyIdentity.clear();
+}
+
+WorldSnapshot NpcWorld::snapshot() {
+    const size_t chunkSize = WorldSnapshot::CHUNK;
+    const size_t count = size();
+    const size_t chunks = (count + chunkSize - 1) / chunkSize;
+    auto data = std::make_shared<WorldSnapshot::Data>();
+    data->count = count;
+    data->bounds = bounds;
+    data->chunks.resize(chunks);
+    auto clean = [&](const std::vector<uint8_t>& dirty, size_t c) { return base && c < dirty.size() && !dirty[c]; };
+
+    for (size_t c = 0; c < chunks; ++c) {
+        const size_t begin = c * chunkSize;
+        const size_t end = std::min(count, begin + chunkSize);
+        WorldSnapshot::Chunk& chunk = data->chunks[c];
+        if (clean(dirtyPositions, c)) {
+            chunk.positions = base->chunks[c].positions;
+        } else {
+            auto positions = std::make_shared<WorldSnapshot::Positions>();
+            positions->xs.assign(xs.begin() + begin, xs.begin() + end);
+            positions->ys.assign(ys.begin() + begin, ys.begin() + end);
+            chunk.positions = std::move(positions);
+        }
+        if (clean(dirtyFlags, c)) {
+            chunk.flags = base->chunks[c].flags;
+        } else {
+            auto flags = std::make_shared<WorldSnapshot::Flags>();
+            flags->alive.assign(alive.begin() + begin, alive.begin() + end);
+            chunk.flags = std::move(flags);
+        }
+        if (clean(dirtyIdentity, c)) {
+            chunk.identity = base->chunks[c].identity;
+        } else {
+            auto identity = std::make_shared<WorldSnapshot::Identity>();
+            identity->types.assign(types.begin() + begin, types.begin() + end);
+            identity->names.assign(names, nameStart[begin], nameStart[end] - nameStart[begin]);
+            identity->nameStart.resize(end - begin + 1);
+            for (size_t i = begin; i <= end; ++i) {
+                identity->nameStart[i - begin] = nameStart[i] - nameStart[begin];
+            }
+            chunk.identity = std::move(identity);
+        }
+    }
+
+    base = data;
+    dirtyPositions.assign(chunks, 0);
+    dirtyFlags.assign(chunks, 0);
+    dirtyIdentity.assign(chunks, 0);
+    return WorldSnapshot(std::move(data));
+}
+
+void NpcWorld::restore(const WorldSnapshot& snapshot) {
+    const WorldSnapshot::Data& target = *snapshot.data;
+    const size_t chunkSize = WorldSnapshot::CHUNK;
+    const size_t count = target.count;
+    const size_t chunks = target.chunks.size();
+    // кусок мира равен base, а у base та же часть, что у снимка - копировать нечего
+    auto same = [&](const std::vector<uint8_t>& dirty, size_t c, auto part) {
+        return base && c < dirty.size() && c < base->chunks.size() && !dirty[c]
+            && base->chunks[c].*part == target.chunks[c].*part;
+    };
+
+    xs.resize(count);
+    ys.resize(count);
+    alive.resize(count);
+    types.resize(count);
+    size_t firstIdentity = chunks;
+    for (size_t c = 0; c < chunks; ++c) {
+        const size_t begin = c * chunkSize;
+        const WorldSnapshot::Chunk& chunk = target.chunks[c];
+        if (!same(dirtyPositions, c, &WorldSnapshot::Chunk::positions)) {
+            std::copy(chunk.positions->xs.begin(), chunk.positions->xs.end(), xs.begin() + begin);
+            std::copy(chunk.positions->ys.begin(), chunk.positions->ys.end(), ys.begin() + begin);
+        }
+        if (!same(dirtyFlags, c, &WorldSnapshot::Chunk::flags)) {
+            std::copy(chunk.flags->alive.begin(), chunk.flags->alive.end(), alive.begin() + begin);
+        }
+        if (firstIdentity == chunks && !same(dirtyIdentity, c, &WorldSnapshot::Chunk::identity)) {
+            firstIdentity = c;
+        }
+    }
+
+    // имена лежат подряд: с первого измененного куска таблица собирается заново
+    const size_t from = std::min(count, firstIdentity * chunkSize);
+    nameStart.resize(count + 1);
+    names.resize(nameStart[from]);
+    for (size_t c = firstIdentity; c < chunks; ++c) {
+        const size_t begin = c * chunkSize;
+        const WorldSnapshot::Identity& identity = *target.chunks[c].identity;
+        const uint32_t offset = static_cast<uint32_t>(names.size());
+        std::copy(identity.types.begin(), identity.types.end(), types.begin() + begin);
+        names.append(identity.names);
+        for (size_t k = 0; k < identity.types.size(); ++k) {
+            nameStart[begin + k] = offset + identity.nameStart[k];
+        }
+    }
+    nameStart[count] = static_cast<uint32_t>(names.size());
+
+    bounds = target.bounds;
+    base = snapshot.data;
+    dirtyPositions.assign(chunks, 0);
+    dirtyFlags.assign(chunks, 0);
+    dirtyIdentity.assign(chunks, 0);
+}
+
+NpcWorld NpcWorld::fromSnapshot(const WorldSnapshot& snapshot) {
+    NpcWorld world(snapshot.getBounds());
+    world.restore(snapshot);
+    return world;
+}
+
+size_t NpcWorld::aliveCount() const {
+    return static_cast<size_t>(std::count(alive.begin(), alive.end(), uint8_t{1}));
+}
+
+void NpcWorld::removeDead() {
+    size_t out = 0;
+    uint32_t nameOut = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (!alive[i]) continue;
+        uint32_t from = nameStart[i];
+        uint32_t len = nameStart[i + 1] - from;
+        // сдвиг влево, источник всегда не левее приемника
+        std::char_traits<char>::move(&names[nameOut], &names[from], len);
+        xs[out] = xs[i];
+        ys[out] = ys[i];
+        types[out] = types[i];
+        alive[out] = 1;
+        nameStart[out] = nameOut;
+        nameOut += len;
+        ++out;
+    }
+    const bool removed = out != size();
+    xs.resize(out);
+    ys.resize(out);
+    types.resize(out);
+    alive.resize(out);
+    names.resize(nameOut);
+    nameStart.resize(out + 1);
+    nameStart[out] = nameOut;
+    if (removed) forgetSnapshot();
+}
+
+std::shared_ptr<NPC> NpcWorld::materialize(size_t i) const {
+    auto npc = NPCFactory::create(types[i], getName(i), xs[i], ys[i], bounds);
+    if (npc && !alive[i]) npc->kill();
+    return npc;
+}
+
+NpcWorld NpcWorld::fromSet(const set_t& npc_collection) {
+    NpcWorld world;
+    world.reserve(npc_collection.size());
+    for (const auto &n : npc_collection) {
+        NpcType type;
+        if (!parseNpcType(n->getType(), type)) continue;
+        size_t i = world.add(type, n->getName(), n->getX(), n->getY());
+        if (!n->isAlive()) world.kill(i);
+    }
+    return world;
+}
+
+NpcWorld NpcWorld::fromRegistry(const NpcRegistry& registry) {
+    NpcWorld world;
+    world.reserve(registry.size());
+    for (size_t i = 0; i < registry.size(); ++i) {
+        const NPC& n = *registry.at(i);
+        size_t index = world.add(n.getKind(), n.getName(), n.getX(), n.getY());
+        if (!n.isAlive()) world.kill(index);
+    }
+    return world;
+}
+
+set_t NpcWorld::toSet() const {
+    set_t result;
+    for (size_t i = 0; i < size(); ++i) {
+        result.insert(materialize(i));
+    }
+    return result;
+}
+
+size_t NpcWorld::memoryUsage() const {
+    return xs.capacity() * sizeof(int) + ys.capacity() * sizeof(int)
+         + types.capacity() * sizeof(NpcType) + alive.capacity()
+         + names.capacity() + nameStart.capacity() * sizeof(uint32_t);
+}
+
+namespace {
+
+// NpcWorld для runFightLoop
+struct WorldRound {
+    NpcWorld& world;
+    const FightRules& rules;
+    IFFightObserver* observer;
+    std::vector<std::shared_ptr<NPC>>& objects;
+    std::vector<size_t>& killed;
+
+    const std::shared_ptr<NPC>& object(size_t i) {
+        if (!objects[i]) objects[i] = world.materialize(i);
+        return objects[i];
+    }
+
+    bool alive(size_t i) const { return world.isAlive(i); }
+    bool duel(size_t a, size_t d) {
+        DUNGEON_METRIC_FIGHT(world.getType(a), world.getType(d));
+        FightOutcome outcome = rules.resolve(world.getType(a), world.getType(d));
+        // как NPC::duel; объекты для трассы - только когда она включена
+        if (FightTrace::enabled()) {
+            FightTrace::sink()->onDuel(*object(a), *object(d), outcome);
+        }
+        return outcome == FightOutcome::Win;
+    }
+    bool observed() const { return observer != nullptr; }
+    void observe(size_t a, size_t d, bool victory) {
+        if (!observer->accepts(world.getType(a), world.getType(d), victory)) return;
+        observer->onFight(object(a), object(d), victory);
+    }
+    void kill(size_t d) {
+        world.kill(d);
+        if (!objects.empty() && objects[d]) objects[d]->kill();
+        killed.push_back(d);
+    }
+};
+
+}
+
+std::vector<size_t> fight(NpcWorld &world, size_t range, const std::shared_ptr<IFFightObserver>& observer)
+{
+    SpatialGrid grid;
+    std::vector<size_t> killed;
+    fight(world, range, grid, killed, observer);
+    return killed;
+}
+
+void fight(NpcWorld &world, size_t range, SpatialGrid &grid, std::vector<size_t> &killed,
+           const std::shared_ptr<IFFightObserver>& observer)
+{
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    killed.clear();
+    const size_t count = world.size();
+    const int* xs = world.xData();
+    const int* ys = world.yData();
+    const FightRules& rules = FightRules::current();
+
+    grid.build(xs, ys, count, range);
+
+    // объекты для наблюдателя и трассы создаются только при первом нужном им поединке
+    std::vector<std::shared_ptr<NPC>> objects;
+    if (observer || FightTrace::enabled()) objects.resize(count);
+    WorldRound round{world, rules, observer.get(), objects, killed};
+    runFightLoop(grid, xs, ys, count, range, round);
+}
+
+void saveNPC(const NpcWorld &world, const std::string &file_name)
+{
+    std::ofstream file(file_name);
+    NPCFactory::saveBounds(world.getBounds(), file);
+    for (size_t i = 0; i < world.size(); ++i) {
+        file << npcTypeName(world.getType(i)) << " " << world.getName(i) << " "
+             << world.getX(i) << " " << world.getY(i) << "\n";
+    }
+    file.flush();
+    file.close();
+    std::cout << "Saved " << world.size() << " NPC in " << file_name << std::endl;
+}
+
+bool loadNPC(const std::string &file_name, NpcWorld &world)
+{
+    size_t before = world.size();
+    if (!WorldFile::loadText(file_name, world)) {
+        std::cerr << "Err: can't open file: " << file_name << std::endl;
+        return false;
+    }
+    std::cout << "Loaded " << world.size() - before << " NPC from " << file_name << std::endl;
+    return true;
+}
+
+std::ostream &operator<<(std::ostream &os, const NpcWorld &world)
+{
+    os << "Total NPCs: " << world.size() << std::endl;
+    for (size_t i = 0; i < world.size(); ++i) {
+        os << npcTypeName(world.getType(i)) << " \"" << world.getName(i)
+           << "\" at position: (" << world.getX(i) << ", " << world.getY(i) << ")"
+           << " - " << (world.isAlive(i) ? "Alive" : "Dead") << std::endl;
+    }
+    return os;
+}
\ No newline at end of file
@@ -1,25 +1,151 @@
+#include <algorithm>
+#include <charconv>
+
 #include "observer.h"
+#include "factory.h"
+#include "stringPool.h"
+
+void appendKillLine(std::string& out, std::string_view attackerType, std::string_view attackerName,
+                    std::string_view defenderType, std::string_view defenderName, int x, int y) {
+    char number[16];
+    auto appendNumber = [&](int value) {
+        auto result = std::to_chars(number, number + sizeof(number), value);
+        out.append(number, result.ptr);
+    };
+    out.append(attackerType).append(" ").append(attackerName)
+       .append(" killed ").append(defenderType).append(" ").append(defenderName)
+       .append(" at (");
+    appendNumber(x);
+    out.append(", ");
+    appendNumber(y);
+    out.append(")\n");
+}
 
 void TextObserver::onFight(const std::shared_ptr<NPC>& attacker,const std::shared_ptr<NPC>& defender,bool success) {
     if (success) {
-        std::cout << attacker->getType() << " " << attacker->getName() << " killed " << defender->getType() << " " << defender->getName() << " at (" << defender->getX() << ", " << defender->getY() << ")\n";
+        // емкость остается от прошлых строк этого потока
+        thread_local std::string line;
+        line.clear();
+        appendKillLine(line, attacker->getType(), attacker->getName(), defender->getType(), defender->getName(),
+                       defender->getX(), defender->getY());
+        std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
     }
 }
 
 FileObserver::FileObserver(const std::string& filename) {
     logfile.open(filename, std::ios::app);
+    if (logfile.is_open()) batch.reserve(BATCH_BYTES + 256);
 }
 
 FileObserver::~FileObserver() {
     if (logfile.is_open()) {
+        flush();
         logfile.close();
     }
 }
 
 void FileObserver::onFight(const std::shared_ptr<NPC>& attacker,const std::shared_ptr<NPC>& defender, bool success) {
     if (logfile.is_open() && success) {
-        logfile << attacker->getType() << " " << attacker->getName() 
-                << " killed " << defender->getType() << " " << defender->getName() 
-                << " at (" << defender->getX() << ", " << defender->getY() << ")\n";
+        appendKillLine(batch, attacker->getType(), attacker->getName(), defender->getType(), defender->getName(),
+                       defender->getX(), defender->getY());
+        if (batch.size() >= BATCH_BYTES) flush();
+    }
+}
+
+void FileObserver::flush() {
+    if (batch.empty()) return;
+    // пачка больше буфера filebuf уходит в файл напрямую, одним вызовом write
+    logfile.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    logfile.flush();
+    batch.clear();
+}
+
+AsyncFileObserver::AsyncFileObserver(const std::string& filename, size_t capacity, OverflowPolicy policy, size_t sampleEvery)
+    : policy(policy), sampleEvery(std::max<size_t>(1, sampleEvery)), ring(std::max<size_t>(1, capacity)) {
+    logfile.open(filename, std::ios::app);
+    writer = std::thread([this] { writerLoop(); });
+}
+
+AsyncFileObserver::~AsyncFileObserver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    notEmpty.notify_one();
+    writer.join();
+    if (logfile.is_open()) {
+        logfile.close();
+    }
+}
+
+void AsyncFileObserver::onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) {
+    if (!success || !logfile.is_open()) return;
+
+    Record record;
+    record.attackerType = attacker->getKind();
+    record.defenderType = defender->getKind();
+    record.x = defender->getX();
+    record.y = defender->getY();
+    record.attackerName = attacker->getNameId();
+    record.defenderName = defender->getNameId();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (head - tail == ring.size()) {
+        if (policy == OverflowPolicy::Drop
+            || (policy == OverflowPolicy::Sample && ++overflowCount % sampleEvery != 0)) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        notFull.wait(lock, [&] { return head - tail < ring.size(); });
+    }
+    // ссылки снимет писатель: NPC может не дожить до записи
+    StringPool& names = StringPool::global();
+    names.retain(record.attackerName);
+    names.retain(record.defenderName);
+    ring[head % ring.size()] = record;
+    bool wasEmpty = head++ == tail;
+    lock.unlock();
+    // писатель спит, только когда очередь пуста
+    if (wasEmpty) notEmpty.notify_one();
+}
+
+void AsyncFileObserver::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t target = head;
+    drained.wait(lock, [&] { return tail >= target; });
+}
+
+void AsyncFileObserver::writerLoop() {
+    std::string batch;
+    StringPool& names = StringPool::global();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        notEmpty.wait(lock, [&] { return head != tail || stopping; });
+        if (head == tail) break;  // stopping и все записано
+
+        // слоты [tail, head) никто не трогает, пока tail не сдвинут
+        size_t from = tail, to = head;
+        lock.unlock();
+
+        batch.clear();
+        for (size_t i = from; i < to; ++i) {
+            const Record& r = ring[i % ring.size()];
+            appendKillLine(batch, npcTypeName(r.attackerType), names.view(r.attackerName),
+                           npcTypeName(r.defenderType), names.view(r.defenderName), r.x, r.y);
+        }
+        logfile.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+        logfile.flush();
+        for (size_t i = from; i < to; ++i) {
+            const Record& r = ring[i % ring.size()];
+            names.release(r.attackerName);
+            names.release(r.defenderName);
+        }
+
+        lock.lock();
+        tail = to;
+        writtenCount.fetch_add(to - from, std::memory_order_relaxed);
+        notFull.notify_all();
+        drained.notify_all();
     }
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "rangeKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RANGE_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 4 бита попаданий -> 4 байта маски (и 8 -> 8 для AVX2)
+struct MaskTables {
+    uint32_t four[16];
+    uint64_t eight[256];
+
+    MaskTables() {
+        for (unsigned bits = 0; bits < 256; ++bits) {
+            uint64_t bytes = 0;
+            for (unsigned k = 0; k < 8; ++k) {
+                if (bits & (1u << k)) bytes |= uint64_t{1} << (8 * k);
+            }
+            eight[bits] = bytes;
+            if (bits < 16) four[bits] = static_cast<uint32_t>(bytes);
+        }
+    }
+};
+
+const MaskTables tables;
+
+int clampRange2(long long range2) {
+    if (range2 < 0) return -1;
+    return range2 > INT_MAX ? INT_MAX : static_cast<int>(range2);
+}
+
+size_t scalarMask(int x, int y, const int* xs, const int* ys, size_t count, int range2, uint8_t* mask) {
+    size_t hits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int dx = xs[i] - x;
+        int dy = ys[i] - y;
+        uint8_t in = dx * dx + dy * dy <= range2;
+        mask[i] = in;
+        hits += in;
+    }
+    return hits;
+}
+
+struct WideRange {
+    long long range2;
+    long long outside;   // floor(sqrt(range2)) + 1: дальше по одной оси - заведомо мимо
+};
+
+WideRange wideRange(long long range2) {
+    if (range2 < 0) return {-1, 0};
+    range2 = std::min(range2, WIDE_RANGE_LIMIT * WIDE_RANGE_LIMIT);
+    long long r = static_cast<long long>(std::sqrt(static_cast<double>(range2)));
+    while (r * r > range2) --r;
+    while ((r + 1) * (r + 1) <= range2) ++r;
+    return {range2, r + 1};
+}
+
+size_t scalarMaskWide(int x, int y, const int* xs, const int* ys, size_t count, WideRange range, uint8_t* mask) {
+    size_t hits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // разность прижимается к outside: квадрат уже больше range2, но без переполнения
+        long long dx = std::min(std::llabs(static_cast<long long>(xs[i]) - x), range.outside);
+        long long dy = std::min(std::llabs(static_cast<long long>(ys[i]) - y), range.outside);
+        uint8_t in = dx * dx + dy * dy <= range.range2;
+        mask[i] = in;
+        hits += in;
+    }
+    return hits;
+}
+
+#ifdef RANGE_KERNEL_X86
+
+// в SSE2 нет _mm_mullo_epi32 - собираем из двух _mm_mul_epu32
+inline __m128i square32(__m128i a) {
+    __m128i even = _mm_mul_epu32(a, a);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(a, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+size_t sse2Mask(int x, int y, const int* xs, const int* ys, size_t count, int range2, uint8_t* mask) {
+    const __m128i px = _mm_set1_epi32(x);
+    const __m128i py = _mm_set1_epi32(y);
+    const __m128i r2 = _mm_set1_epi32(range2);
+    // попадания копятся по дорожкам: промах = -1 от cmpgt, вычитаем из счетчика всех
+    __m128i misses = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i dx = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i)), px);
+        __m128i dy = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i)), py);
+        __m128i d2 = _mm_add_epi32(square32(dx), square32(dy));
+        __m128i out = _mm_cmpgt_epi32(d2, r2);
+        misses = _mm_sub_epi32(misses, out);
+        unsigned in = ~static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(out))) & 0xFu;
+        std::memcpy(mask + i, &tables.four[in], 4);
+    }
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), misses);
+    size_t hits = i - (static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3]);
+    return hits + scalarMask(x, y, xs + i, ys + i, count - i, range2, mask + i);
+}
+
+__attribute__((target("avx2")))
+size_t avx2Mask(int x, int y, const int* xs, const int* ys, size_t count, int range2, uint8_t* mask) {
+    const __m256i px = _mm256_set1_epi32(x);
+    const __m256i py = _mm256_set1_epi32(y);
+    const __m256i r2 = _mm256_set1_epi32(range2);
+    __m256i misses = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i)), px);
+        __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i)), py);
+        __m256i d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+        __m256i out = _mm256_cmpgt_epi32(d2, r2);
+        misses = _mm256_sub_epi32(misses, out);
+        unsigned in = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(out))) & 0xFFu;
+        std::memcpy(mask + i, &tables.eight[in], 8);
+    }
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), misses);
+    size_t hits = i;
+    for (uint32_t lane : lanes) hits -= lane;
+    return hits + sse2Mask(x, y, xs + i, ys + i, count - i, range2, mask + i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i clampedDistance(__m256i a, __m256i b, __m256i outside) {
+    __m256i d = _mm256_sub_epi64(a, b);
+    // |d| без _mm256_abs_epi64 (его нет в AVX2)
+    __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), d);
+    d = _mm256_sub_epi64(_mm256_xor_si256(d, sign), sign);
+    return _mm256_blendv_epi8(d, outside, _mm256_cmpgt_epi64(d, outside));
+}
+
+__attribute__((target("avx2")))
+size_t avx2MaskWide(int x, int y, const int* xs, const int* ys, size_t count, WideRange range, uint8_t* mask) {
+    const __m256i px = _mm256_set1_epi64x(x);
+    const __m256i py = _mm256_set1_epi64x(y);
+    const __m256i r2 = _mm256_set1_epi64x(range.range2);
+    const __m256i outside = _mm256_set1_epi64x(range.outside);
+    size_t hits = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i dx = clampedDistance(_mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i))), px, outside);
+        __m256i dy = clampedDistance(_mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i))), py, outside);
+        // после прижима разности меньше 2^32 - хватает беззнакового 32x32 -> 64
+        __m256i d2 = _mm256_add_epi64(_mm256_mul_epu32(dx, dx), _mm256_mul_epu32(dy, dy));
+        unsigned out = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(d2, r2))));
+        unsigned in = ~out & 0xFu;
+        std::memcpy(mask + i, &tables.four[in], 4);
+        hits += static_cast<size_t>(__builtin_popcount(in));
+    }
+    return hits + scalarMaskWide(x, y, xs + i, ys + i, count - i, range, mask + i);
+}
+
+#endif
+
+SimdLevel detect() {
+#ifdef RANGE_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = detect();
+    return level;
+}
+
+bool simdLevelSupported(SimdLevel level) {
+    return static_cast<int>(level) <= static_cast<int>(detectSimdLevel());
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default:              return "scalar";
+    }
+}
+
+size_t rangeMask(int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask) {
+    return rangeMask(detectSimdLevel(), x, y, xs, ys, count, range2, mask);
+}
+
+size_t rangeMask(SimdLevel level, int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask) {
+    int r2 = clampRange2(range2);
+    if (!simdLevelSupported(level)) level = detectSimdLevel();
+    switch (level) {
+#ifdef RANGE_KERNEL_X86
+        case SimdLevel::AVX2: return avx2Mask(x, y, xs, ys, count, r2, mask);
+        case SimdLevel::SSE2: return sse2Mask(x, y, xs, ys, count, r2, mask);
+#endif
+        default:              return scalarMask(x, y, xs, ys, count, r2, mask);
+    }
+}
+
+size_t rangeMaskWide(int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask) {
+    return rangeMaskWide(detectSimdLevel(), x, y, xs, ys, count, range2, mask);
+}
+
+size_t rangeMaskWide(SimdLevel level, int x, int y, const int* xs, const int* ys, size_t count, long long range2, uint8_t* mask) {
+    WideRange range = wideRange(range2);
+    if (!simdLevelSupported(level)) level = detectSimdLevel();
+#ifdef RANGE_KERNEL_X86
+    if (level == SimdLevel::AVX2) return avx2MaskWide(x, y, xs, ys, count, range, mask);
+#endif
+    return scalarMaskWide(x, y, xs, ys, count, range, mask);
+}
+
+size_t rangeMaskHuge(int x, int y, const int* xs, const int* ys, size_t count, unsigned long long range, uint8_t* mask) {
+    if (range >= static_cast<unsigned long long>(MAX_INT32_DISTANCE)) {
+        std::memset(mask, 1, count);
+        return count;
+    }
+    const HugeDistance2 range2 = HugeDistance2{range} * range;
+    size_t hits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        HugeDistance2 dx = static_cast<unsigned long long>(std::llabs(static_cast<long long>(xs[i]) - x));
+        HugeDistance2 dy = static_cast<unsigned long long>(std::llabs(static_cast<long long>(ys[i]) - y));
+        uint8_t in = dx * dx + dy * dy <= range2;
+        mask[i] = in;
+        hits += in;
+    }
+    return hits;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "rangeSweep.h"
+#include "fightRules.h"
+#include "spatialGrid.h"
+
+namespace {
+
+// Distance2 - uint64_t, пока наибольший радиус не больше WIDE_RANGE_LIMIT, иначе
+// HugeDistance2: квадраты дальних пар в 64 бита не помещаются
+template <class Distance2>
+struct Victim {
+    Distance2 distance2;
+    uint32_t defender;
+};
+
+// в списках нет пар дальше наибольшего радиуса, так что больший квадрат можно
+// прижать к его пределу - сравнение от этого не меняется
+template <class Distance2>
+Distance2 squaredRange(size_t range) {
+    constexpr long long limit = sizeof(Distance2) > sizeof(uint64_t) ? MAX_INT32_DISTANCE : WIDE_RANGE_LIMIT;
+    Distance2 r = static_cast<Distance2>(std::min<size_t>(range, static_cast<size_t>(limit)));
+    return r * r;
+}
+
+template <class Distance2>
+Distance2 squaredDistance(long long dx, long long dy) {
+    Distance2 x = static_cast<Distance2>(std::llabs(dx));
+    Distance2 y = static_cast<Distance2>(std::llabs(dy));
+    return x * x + y * y;
+}
+
+}
+
+RangeSweepResult RangeSweep::run(const NpcWorld& world, const std::vector<size_t>& ranges) {
+    RangeSweepResult result;
+    const size_t count = world.size();
+    result.ranges = ranges;
+    result.killed.resize(ranges.size());
+    result.deathRange.assign(count, RangeSweepResult::SURVIVES);
+    if (ranges.empty() || count == 0) return result;
+
+    const FightRules& rules = FightRules::current();
+    std::vector<uint8_t> alive(count);
+    for (size_t i = 0; i < count; ++i) alive[i] = world.isAlive(i) ? 1 : 0;
+
+    // отдельная сетка живых на каждый тип защитника
+    std::vector<uint32_t> ids[NPC_TYPE_COUNT];
+    std::vector<int> xs[NPC_TYPE_COUNT], ys[NPC_TYPE_COUNT];
+    SpatialGrid grids[NPC_TYPE_COUNT];
+    auto buildGrids = [&](size_t cell) {
+        for (size_t t = 0; t < NPC_TYPE_COUNT; ++t) {
+            ids[t].clear();
+            xs[t].clear();
+            ys[t].clear();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!alive[i]) continue;
+            size_t t = static_cast<size_t>(world.getType(i));
+            ids[t].push_back(static_cast<uint32_t>(i));
+            xs[t].push_back(world.getX(i));
+            ys[t].push_back(world.getY(i));
+        }
+        for (size_t t = 0; t < NPC_TYPE_COUNT; ++t) {
+            grids[t].build(xs[t].data(), ys[t].data(), ids[t].size(), cell);
+        }
+    };
+    // побеждаемые нападающим a в радиусе range, только по сеткам нужных типов
+    auto forEachVictim = [&](size_t a, size_t range, auto&& fn) {
+        const NpcType attackerType = world.getType(a);
+        for (size_t t = 0; t < NPC_TYPE_COUNT; ++t) {
+            if (!rules.kills(attackerType, static_cast<NpcType>(t))) continue;
+            grids[t].forEachInRange(world.getX(a), world.getY(a), range, [&](uint32_t k) {
+                uint32_t d = ids[t][k];
+                if (d != a) fn(d);
+            });
+        }
+    };
+
+    // первый шаг - прямым поиском: на плотной карте он убивает почти всех,
+    // и списки в большом радиусе нужны только выжившим
+    buildGrids(ranges[0]);
+    for (size_t a = 0; a < count; ++a) {
+        if (!alive[a]) continue;
+        forEachVictim(a, ranges[0], [&](uint32_t d) {
+            if (!alive[d]) return;
+            alive[d] = 0;
+            result.killed[0].push_back(d);
+            result.deathRange[d] = ranges[0];
+        });
+    }
+    std::sort(result.killed[0].begin(), result.killed[0].end());
+    if (ranges.size() == 1) return result;
+
+    // списки выживших в радиусе наибольшего шага, подряд по нападающим (CSR), по дистанции
+    const size_t maxRange = *std::max_element(ranges.begin() + 1, ranges.end());
+    buildGrids(maxRange);
+    auto steps = [&](auto zero) {
+        using Distance2 = decltype(zero);
+        std::vector<size_t> start(count + 1, 0);
+        std::vector<Victim<Distance2>> victims;
+        for (size_t a = 0; a < count; ++a) {
+            start[a] = victims.size();
+            if (!alive[a]) continue;
+            const long long ax = world.getX(a), ay = world.getY(a);
+            forEachVictim(a, maxRange, [&](uint32_t d) {
+                victims.push_back({squaredDistance<Distance2>(world.getX(d) - ax, world.getY(d) - ay), d});
+            });
+            std::sort(victims.begin() + static_cast<std::ptrdiff_t>(start[a]), victims.end(),
+                      [](const auto& l, const auto& r) { return l.distance2 < r.distance2; });
+        }
+        start[count] = victims.size();
+        std::vector<size_t> cursor(start.begin(), start.end() - 1);
+
+        // все, кто ближе уже пройденного радиуса, убиты раньше; меньший радиус после
+        // большего ничего нового не дает - берем накопленный максимум
+        Distance2 reach2 = squaredRange<Distance2>(ranges[0]);
+        for (size_t step = 1; step < ranges.size(); ++step) {
+            reach2 = std::max(reach2, squaredRange<Distance2>(ranges[step]));
+            std::vector<size_t>& killed = result.killed[step];
+            for (size_t a = 0; a < count; ++a) {
+                if (!alive[a]) continue;
+                size_t& k = cursor[a];
+                for (; k < start[a + 1] && victims[k].distance2 <= reach2; ++k) {
+                    uint32_t d = victims[k].defender;
+                    if (!alive[d]) continue;
+                    alive[d] = 0;
+                    killed.push_back(d);
+                    result.deathRange[d] = ranges[step];
+                }
+            }
+            std::sort(killed.begin(), killed.end());
+        }
+    };
+    if (maxRange > static_cast<size_t>(WIDE_RANGE_LIMIT)) {
+        steps(HugeDistance2{});
+    } else {
+        steps(uint64_t{});
+    }
+    return result;
+}
\ No newline at end of file
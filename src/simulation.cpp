@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include "simulation.h"
+
+namespace {
+
+uint64_t splitmix(uint64_t v) {
+    v += 0x9e3779b97f4a7c15ull;
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+    return v ^ (v >> 31);
+}
+
+// скорость зависит только от seed, номера NPC и эпохи - не от разбиения на потоки
+void pickVelocity(uint64_t seed, size_t i, uint64_t epoch, int maxSpeed, int& vx, int& vy) {
+    uint64_t h = splitmix(seed ^ splitmix(i ^ splitmix(epoch)));
+    uint64_t span = 2 * static_cast<uint64_t>(maxSpeed) + 1;
+    vx = static_cast<int>(h % span) - maxSpeed;
+    vy = static_cast<int>((h >> 32) % span) - maxSpeed;
+}
+
+// шаг с отражением от края [lo, hi], в 64 битах - у края int32 не переполняется
+int step(int pos, int& v, int lo, int hi) {
+    long long next = static_cast<long long>(pos) + v;
+    if (next < lo) {
+        next = 2LL * lo - next;
+        v = -v;
+    } else if (next > hi) {
+        next = 2LL * hi - next;
+        v = -v;
+    }
+    return static_cast<int>(std::clamp<long long>(next, lo, hi));
+}
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+Simulation::Simulation(NpcWorld& world, const SimulationOptions& options)
+    : world(world), options(options),
+      battle(BattleOptions{BattleMode::Parallel, options.threads, options.chunkSize}) {
+    if (options.maxSpeed < 0 || options.maxSpeed > (1 << 30)) {
+        throw std::runtime_error("Simulation speed must be in range 0-2^30");
+    }
+    if (!(options.tickSeconds > 0)) {
+        throw std::runtime_error("Simulation tick must be positive");
+    }
+    if (this->options.turnEvery == 0) this->options.turnEvery = 1;
+    if (this->options.chunkSize == 0) this->options.chunkSize = 1;
+    prepare();
+}
+
+void Simulation::prepare() {
+    const size_t count = world.size();
+    if (vx.size() == count && grid.size() == count && area == world.getBounds()) return;
+
+    const size_t known = std::min(vx.size(), count);
+    vx.resize(count);
+    vy.resize(count);
+    for (size_t i = known; i < count; ++i) {
+        pickVelocity(options.seed, i, tickCount, options.maxSpeed, vx[i], vy[i]);
+    }
+    area = world.getBounds();
+    grid.build(world.xData(), world.yData(), count, options.range, area);
+}
+
+void Simulation::move() {
+    const size_t count = world.size();
+    const size_t chunkCount = (count + options.chunkSize - 1) / options.chunkSize;
+    battle.threadPool()->run(chunkCount, [&](size_t chunk, size_t) {
+        const size_t begin = chunk * options.chunkSize;
+        const size_t end = std::min(count, begin + options.chunkSize);
+        for (size_t i = begin; i < end; ++i) {
+            if (!world.alive[i]) continue;
+            // направления меняются вразнобой, а не у всех в один тик
+            uint64_t phase = tickCount + i;
+            if (phase % options.turnEvery == 0) {
+                pickVelocity(options.seed, i, phase / options.turnEvery, options.maxSpeed, vx[i], vy[i]);
+            }
+            world.xs[i] = step(world.xs[i], vx[i], area.minX, area.maxX);
+            world.ys[i] = step(world.ys[i], vy[i], area.minY, area.maxY);
+        }
+    });
+    world.touchAllPositions();
+}
+
+const std::vector<size_t>& Simulation::tick() {
+    prepare();
+
+    auto start = std::chrono::steady_clock::now();
+    move();
+    stats.moveSeconds += since(start);
+
+    start = std::chrono::steady_clock::now();
+    // мертвые стоят на месте - их сетка не перебирает
+    if (!grid.update(world.xData(), world.yData(), world.size(), battle.threadPool(), options.chunkSize,
+                     world.aliveData())) {
+        ++stats.gridRebuilds;
+    }
+    stats.gridSeconds += since(start);
+
+    start = std::chrono::steady_clock::now();
+    battle.round(world, options.range, grid, killed);
+    stats.fightSeconds += since(start);
+
+    ++tickCount;
+    ++stats.ticks;
+    stats.kills += killed.size();
+    return killed;
+}
+
+void Simulation::run(size_t ticks) {
+    for (size_t t = 0; t < ticks; ++t) tick();
+}
+
+size_t Simulation::advance(double elapsedSeconds, size_t maxTicks) {
+    if (elapsedSeconds > 0) pending += elapsedSeconds;
+    size_t done = 0;
+    while (pending >= options.tickSeconds && done < maxTicks) {
+        tick();
+        pending -= options.tickSeconds;
+        ++done;
+    }
+    // не успеваем - догонять не пытаемся, иначе каждый следующий вызов дольше
+    if (pending >= options.tickSeconds) pending = std::fmod(pending, options.tickSeconds);
+    return done;
+}
+
+void Simulation::removeDead() {
+    prepare();
+    size_t kept = 0;
+    for (size_t i = 0; i < world.size(); ++i) {
+        if (!world.isAlive(i)) continue;
+        vx[kept] = vx[i];
+        vy[kept] = vy[i];
+        ++kept;
+    }
+    vx.resize(kept);
+    vy.resize(kept);
+    world.removeDead();
+    area = world.getBounds();
+    grid.build(world.xData(), world.yData(), world.size(), options.range, area);
+}
\ No newline at end of file
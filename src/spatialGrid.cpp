@@ -0,0 +1,218 @@
+#include <algorithm>
+
+#include "spatialGrid.h"
+
+void SpatialGrid::chooseCells(long long width, long long height, size_t count, size_t cell) {
+    wide = width > 32768 || height > 32768;
+
+    // на мелкой ячейке и большой карте сетка была бы почти пустой - укрупняем
+    long long size = std::max<long long>(1, static_cast<long long>(std::min<size_t>(cell, 1u << 30)));
+    long long maxCells = std::max<long long>(1024, static_cast<long long>(count) * 2);
+    while (((width + size - 1) / size) * ((height + size - 1) / size) > maxCells) {
+        size *= 2;
+    }
+    cellSize = static_cast<int>(size);
+    cols = static_cast<int>((width + size - 1) / size);
+    rows = static_cast<int>((height + size - 1) / size);
+}
+
+void SpatialGrid::build(const int* xs, const int* ys, size_t count, size_t cell) {
+    ids.clear();
+    cellX.clear();
+    cellY.clear();
+    cellStart.clear();
+    cols = rows = 0;
+    tracked = false;
+    if (count == 0) return;
+
+    minX = *std::min_element(xs, xs + count);
+    minY = *std::min_element(ys, ys + count);
+    maxX = *std::max_element(xs, xs + count);
+    maxY = *std::max_element(ys, ys + count);
+    chooseCells(static_cast<long long>(maxX) - minX + 1, static_cast<long long>(maxY) - minY + 1, count, cell);
+    layout(xs, ys, count);
+}
+
+void SpatialGrid::build(const int* xs, const int* ys, size_t count, size_t cell, const WorldBounds& area) {
+    minX = area.minX;
+    minY = area.minY;
+    maxX = area.maxX;
+    maxY = area.maxY;
+    chooseCells(area.width() + 1, area.height() + 1, count, cell);
+    tracked = true;
+    layout(xs, ys, count);
+}
+
+void SpatialGrid::layout(const int* xs, const int* ys, size_t count) {
+    // подсчет по ячейкам, потом раскладка (counting sort, порядок внутри ячейки сохраняется)
+    size_t cells = static_cast<size_t>(cols) * rows;
+    cellStart.assign(cells + 1, 0);
+    cellOf.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t c = static_cast<size_t>(cellRow(ys[i])) * cols + cellCol(xs[i]);
+        cellOf[i] = static_cast<uint32_t>(c);
+        ++cellStart[c + 1];
+    }
+    for (size_t c = 0; c < cells; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    ids.resize(count);
+    cellX.resize(count);
+    cellY.resize(count);
+    if (tracked) slotOf.resize(count);
+    fill.assign(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t pos = fill[cellOf[i]]++;
+        ids[pos] = static_cast<uint32_t>(i);
+        cellX[pos] = xs[i];
+        cellY[pos] = ys[i];
+        if (tracked) slotOf[i] = pos;
+    }
+}
+
+void SpatialGrid::swapSlots(uint32_t a, uint32_t b) {
+    if (a == b) return;
+    std::swap(ids[a], ids[b]);
+    std::swap(cellX[a], cellX[b]);
+    std::swap(cellY[a], cellY[b]);
+    slotOf[ids[a]] = a;
+    slotOf[ids[b]] = b;
+}
+
+bool SpatialGrid::update(const int* xs, const int* ys, size_t count, ThreadPool* pool, size_t chunkSize,
+                         const uint8_t* moving) {
+    if (!tracked) {
+        build(xs, ys, count, static_cast<size_t>(cellSize));
+        return false;
+    }
+    if (count != ids.size()) {
+        build(xs, ys, count, static_cast<size_t>(cellSize), WorldBounds{minX, minY, maxX, maxY});
+        return false;
+    }
+    if (count == 0) return true;
+
+    // проход 1: оставшиеся в своей ячейке получают новые координаты сразу
+    if (chunkSize == 0) chunkSize = 1;
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    if (movers.size() < chunkCount) movers.resize(chunkCount);
+    auto scan = [&](size_t chunk, size_t) {
+        std::vector<Move>& moved = movers[chunk];
+        moved.clear();
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(count, begin + chunkSize);
+        for (size_t i = begin; i < end; ++i) {
+            if (moving && !moving[i]) continue;
+            uint32_t c = static_cast<uint32_t>(static_cast<size_t>(cellRow(ys[i])) * cols + cellCol(xs[i]));
+            if (c == cellOf[i]) {
+                cellX[slotOf[i]] = xs[i];
+                cellY[slotOf[i]] = ys[i];
+            } else {
+                moved.push_back({static_cast<uint32_t>(i), c});
+            }
+        }
+    };
+    if (pool) {
+        pool->run(chunkCount, scan);
+    } else {
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) scan(chunk, 0);
+    }
+
+    // перенос по цепочке стоит разницы номеров ячеек (переход на другую строку - cols шагов);
+    // когда шагов много, дешевле один проход слиянием
+    size_t steps = 0, moverCount = 0;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        moverCount += movers[chunk].size();
+        for (const Move& m : movers[chunk]) {
+            steps += m.cell > cellOf[m.point] ? m.cell - cellOf[m.point] : cellOf[m.point] - m.cell;
+        }
+    }
+    if (steps * 8 > count + static_cast<size_t>(cols) * rows) {
+        relocate(xs, ys, chunkCount, moverCount);
+        return true;
+    }
+
+    // проход 2: точка идет в соседнюю ячейку, меняясь местами с крайним элементом
+    // своей и сдвигая общую границу на один
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        for (const Move& m : movers[chunk]) {
+            const uint32_t i = m.point;
+            uint32_t c = cellOf[i];
+            while (c < m.cell) {
+                swapSlots(slotOf[i], cellStart[c + 1] - 1);
+                --cellStart[c + 1];
+                ++c;
+            }
+            while (c > m.cell) {
+                swapSlots(slotOf[i], cellStart[c]);
+                ++cellStart[c];
+                --c;
+            }
+            cellOf[i] = m.cell;
+            cellX[slotOf[i]] = xs[i];
+            cellY[slotOf[i]] = ys[i];
+        }
+    }
+    return true;
+}
+
+void SpatialGrid::relocate(const int* xs, const int* ys, size_t chunkCount, size_t moverCount) {
+    const size_t cells = static_cast<size_t>(cols) * rows;
+    const size_t count = ids.size();
+
+    // fill[c + 1] - на сколько меняется ячейка c (по модулю 2^32, итог неотрицательный)
+    fill.assign(cells + 1, 0);
+    leaving.resize(count, 0);
+    arrivals.clear();
+    arrivals.reserve(moverCount);
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        for (const Move& m : movers[chunk]) {
+            ++fill[m.cell + 1];
+            --fill[cellOf[m.point] + 1];
+            leaving[slotOf[m.point]] = 1;
+            arrivals.push_back(m);
+        }
+    }
+    // внутри ячейки пришедшие встают по номеру точки - порядок не зависит от потоков
+    std::sort(arrivals.begin(), arrivals.end(), [](const Move& l, const Move& r) {
+        return l.cell != r.cell ? l.cell < r.cell : l.point < r.point;
+    });
+    fill[0] = 0;
+    for (size_t c = 0; c < cells; ++c) {
+        fill[c + 1] += fill[c] + (cellStart[c + 1] - cellStart[c]);
+    }
+
+    // один проход по ячейкам: оставшиеся по порядку, за ними пришедшие
+    spareIds.resize(count);
+    spareX.resize(count);
+    spareY.resize(count);
+    size_t next = 0;
+    for (size_t c = 0; c < cells; ++c) {
+        uint32_t pos = fill[c];
+        for (uint32_t k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+            if (leaving[k]) {
+                leaving[k] = 0;
+                continue;
+            }
+            const uint32_t id = ids[k];
+            spareIds[pos] = id;
+            spareX[pos] = cellX[k];
+            spareY[pos] = cellY[k];
+            if (pos != k) slotOf[id] = pos;
+            ++pos;
+        }
+        for (; next < arrivals.size() && arrivals[next].cell == c; ++next) {
+            const uint32_t id = arrivals[next].point;
+            spareIds[pos] = id;
+            spareX[pos] = xs[id];
+            spareY[pos] = ys[id];
+            slotOf[id] = pos;
+            cellOf[id] = static_cast<uint32_t>(c);
+            ++pos;
+        }
+    }
+    ids.swap(spareIds);
+    cellX.swap(spareX);
+    cellY.swap(spareY);
+    cellStart.swap(fill);
+}
\ No newline at end of file
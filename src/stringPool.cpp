@@ -0,0 +1,206 @@
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+#include "stringPool.h"
+
+StringPool::StringPool() : index(1024, NONE) {}
+
+StringPool::~StringPool() = default;
+
+size_t StringPool::segmentOf(uint32_t id) {
+    return static_cast<size_t>(std::bit_width(id / FIRST_SEGMENT + 1)) - 1;
+}
+
+uint32_t StringPool::lookup(std::string_view text, size_t hash) const {
+    const size_t mask = index.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        uint32_t id = index[slot];
+        if (id == NONE) return NONE;
+        if (view(id) == text) return id;
+    }
+}
+
+uint32_t StringPool::find(std::string_view text) const {
+    size_t hash = std::hash<std::string_view>{}(text);
+    std::shared_lock lock(mutex);
+    return lookup(text, hash);
+}
+
+uint32_t StringPool::intern(std::string_view text) {
+    size_t hash = std::hash<std::string_view>{}(text);
+    {
+        std::shared_lock lock(mutex);
+        uint32_t id = lookup(text, hash);
+        if (id != NONE) {
+            // снять строку release может только под исключительной блокировкой
+            retain(id);
+            return id;
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    // между блокировками строку мог добавить другой поток
+    uint32_t id = lookup(text, hash);
+    if (id != NONE) {
+        retain(id);
+        return id;
+    }
+
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = count;
+        size_t segment = segmentOf(id);
+        if (segment >= SEGMENT_COUNT) {
+            throw std::runtime_error("String pool is full");
+        }
+        if (!segments[segment]) {
+            segments[segment] = std::make_unique<Entry[]>(FIRST_SEGMENT << segment);
+        }
+        ++count;
+    }
+    Entry& target = entry(id);
+    store(target, text);
+    target.used = true;
+    target.refs.store(1, std::memory_order_relaxed);
+    ++liveCount;
+
+    // заполненность не больше половины
+    if (size_t{liveCount} * 2 > index.size()) {
+        grow();
+    } else {
+        const size_t mask = index.size() - 1;
+        size_t slot = hash & mask;
+        while (index[slot] != NONE) slot = (slot + 1) & mask;
+        index[slot] = id;
+    }
+    return id;
+}
+
+void StringPool::release(uint32_t id) {
+    if (entry(id).refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    std::unique_lock lock(mutex);
+    Entry& target = entry(id);
+    // до блокировки строку могли снова получить через intern, а то и снять и
+    // занять номер другой строкой - тогда убирать нечего
+    if (!target.used || target.refs.load(std::memory_order_relaxed) != 0) return;
+
+    unindex(id);
+    discard(target);
+    target.used = false;
+    target.text = {};
+    freeIds.push_back(id);
+    --liveCount;
+}
+
+uint32_t StringPool::newBlock(size_t bytes) {
+    uint32_t block;
+    if (!freeBlocks.empty()) {
+        block = freeBlocks.back();
+        freeBlocks.pop_back();
+    } else {
+        block = static_cast<uint32_t>(blocks.size());
+        blocks.emplace_back();
+    }
+    blocks[block].data = std::make_unique<char[]>(bytes);
+    blocks[block].bytes = bytes;
+    blocks[block].live = 0;
+    blockBytes += bytes;
+    return block;
+}
+
+void StringPool::store(Entry& target, std::string_view text) {
+    if (text.empty()) {
+        target.text = {};
+        target.block = NO_BLOCK;
+        return;
+    }
+    char* place;
+    if (text.size() > TEXT_BLOCK / 4) {
+        // длинная строка - свой блок, хвост текущего не бросаем
+        target.block = newBlock(text.size());
+        place = blocks[target.block].data.get();
+    } else {
+        if (current == NO_BLOCK || blockUsed + text.size() > TEXT_BLOCK) {
+            // прежний блок освободится вместе с последней строкой в нем
+            current = newBlock(TEXT_BLOCK);
+            blockUsed = 0;
+        }
+        target.block = current;
+        place = blocks[current].data.get() + blockUsed;
+        blockUsed += text.size();
+    }
+    blocks[target.block].live += text.size();
+    std::memcpy(place, text.data(), text.size());
+    target.text = std::string_view(place, text.size());
+}
+void StringPool::discard(Entry& target) {
+    if (target.block == NO_BLOCK) return;
+    Block& block = blocks[target.block];
+    block.live -= target.text.size();
+    if (block.live != 0) return;
+    if (target.block == current) {
+        // текущий блок заполняется заново с начала
+        blockUsed = 0;
+        return;
+    }
+    blockBytes -= block.bytes;
+    block.data.reset();
+    block.bytes = 0;
+    freeBlocks.push_back(target.block);
+}
+
+void StringPool::unindex(uint32_t id) {
+    const size_t mask = index.size() - 1;
+    auto home = [&](uint32_t other) { return std::hash<std::string_view>{}(view(other)) & mask; };
+    size_t hole = home(id);
+    while (index[hole] != id) hole = (hole + 1) & mask;
+
+    // линейное пробирование без надгробий: записи цепочки за дырой, чей дом
+    // не между дырой и ими, сдвигаются в нее
+    for (size_t slot = (hole + 1) & mask; index[slot] != NONE; slot = (slot + 1) & mask) {
+        if (((slot - home(index[slot])) & mask) >= ((slot - hole) & mask)) {
+            index[hole] = index[slot];
+            hole = slot;
+        }
+    }
+    index[hole] = NONE;
+}
+
+void StringPool::grow() {
+    std::vector<uint32_t> larger(index.size() * 2, NONE);
+    const size_t mask = larger.size() - 1;
+    for (uint32_t id = 0; id < count; ++id) {
+        if (!entry(id).used) continue;
+        size_t slot = std::hash<std::string_view>{}(view(id)) & mask;
+        while (larger[slot] != NONE) slot = (slot + 1) & mask;
+        larger[slot] = id;
+    }
+    index.swap(larger);
+}
+
+size_t StringPool::size() const {
+    std::shared_lock lock(mutex);
+    return liveCount;
+}
+
+size_t StringPool::memoryUsage() const {
+    std::shared_lock lock(mutex);
+    size_t bytes = blockBytes + index.capacity() * sizeof(uint32_t);
+    for (size_t segment = 0; segment < SEGMENT_COUNT && segments[segment]; ++segment) {
+        bytes += (FIRST_SEGMENT << segment) * sizeof(Entry);
+    }
+    return bytes;
+}
+
+StringPool& StringPool::global() {
+    // не разрушается: NPC в статических объектах могут пережить пул и снять
+    // свои ссылки уже после выхода из main
+    static StringPool* pool = new StringPool();
+    return *pool;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include <algorithm>
+
+#include "threadPool.h"
+#include "metrics.h"
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    ranges = std::make_unique<Range[]>(threads);
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool ThreadPool::popOwn(size_t worker, uint32_t& chunk) {
+    std::atomic<uint64_t>& bounds = ranges[worker].bounds;
+    uint64_t current = bounds.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t next = static_cast<uint32_t>(current), end = static_cast<uint32_t>(current >> 32);
+        if (next >= end) return false;
+        if (bounds.compare_exchange_weak(current, pack(next + 1, end), std::memory_order_acq_rel)) {
+            chunk = next;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::steal(size_t worker, uint32_t& chunk) {
+    const size_t count = size();
+    for (size_t k = 1; k < count; ++k) {
+        std::atomic<uint64_t>& bounds = ranges[(worker + k) % count].bounds;
+        uint64_t current = bounds.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t next = static_cast<uint32_t>(current), end = static_cast<uint32_t>(current >> 32);
+            if (next >= end) break;
+            // вор забирает вторую половину, последний кусок - целиком
+            uint32_t mid = next + (end - next) / 2;
+            if (bounds.compare_exchange_weak(current, pack(next, mid), std::memory_order_acq_rel)) {
+                // своя доля пуста - ее трогают только через CAS, которые на пустой не срабатывают
+                ranges[worker].bounds.store(pack(mid + 1, end), std::memory_order_release);
+                chunk = mid;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::drain(size_t worker, const Task& fn) {
+    uint32_t chunk;
+    while (popOwn(worker, chunk) || steal(worker, chunk)) {
+        fn(chunk, worker);
+        if (finishedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    if (Metrics::enabled) Metrics::attachThread();
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t seen = 0;
+    while (true) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        if (!task) continue;
+        const Task* current = task;
+        ++active;
+        lock.unlock();
+        drain(worker, *current);
+        lock.lock();
+        // следующий run не начнется, пока кто-то еще заглядывает в доли этого
+        if (--active == 0) done.notify_all();
+    }
+}
+
+void ThreadPool::runTask(size_t count, const Task& fn) {
+    if (count == 0) return;
+    if (workers.empty()) {
+        for (size_t chunk = 0; chunk < count; ++chunk) fn(chunk, 0);
+        return;
+    }
+
+    const size_t threads = size();
+    std::unique_lock<std::mutex> lock(mutex);
+    for (size_t w = 0; w < threads; ++w) {
+        ranges[w].bounds.store(pack(static_cast<uint32_t>(count * w / threads),
+                                    static_cast<uint32_t>(count * (w + 1) / threads)),
+                               std::memory_order_relaxed);
+    }
+    task = &fn;
+    chunks = count;
+    finishedChunks.store(0, std::memory_order_relaxed);
+    ++generation;
+    lock.unlock();
+    wake.notify_all();
+
+    drain(0, fn);
+    lock.lock();
+    done.wait(lock, [&] { return finishedChunks.load(std::memory_order_acquire) == chunks && active == 0; });
+    task = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include <iostream>
+
+#include "trace.h"
+#include "factory.h"
+
+void ConsoleTraceSink::onDuel(const NPC& attacker, const NPC& defender, FightOutcome outcome) {
+    std::cout << npcTypeName(attacker.getKind()) << " " << attacker.getName() << " fights "
+              << npcTypeName(defender.getKind()) << " " << defender.getName() << " - ";
+    if (outcome == FightOutcome::Draw) {
+        std::cout << "Draw\n";
+    } else {
+        NpcType winner = outcome == FightOutcome::Win ? attacker.getKind() : defender.getKind();
+        std::cout << npcTypeName(winner) << " wins" << (winner == NpcType::Toad ? " (eats all)" : "") << "\n";
+    }
+}
\ No newline at end of file
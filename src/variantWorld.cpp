@@ -0,0 +1,145 @@
+#include <algorithm>
+
+#include "variantWorld.h"
+#include "factory.h"
+#include "fightLoop.h"
+#include "metrics.h"
+#include "spatialGrid.h"
+#include "trace.h"
+
+namespace {
+
+NpcValue makeValue(NpcType type, std::string_view name, int x, int y) {
+    switch (type) {
+        case NpcType::Toad:   return ToadUnit{PooledName(name), x, y, true};
+        case NpcType::Dragon: return DragonUnit{PooledName(name), x, y, true};
+        default:              return KnightUnit{PooledName(name), x, y, true};
+    }
+}
+
+// VariantWorld для runFightLoop, исход пары решает Kills
+template <class Kills>
+struct VariantRound {
+    VariantWorld& world;
+    Kills& kills;
+    IFFightObserver* observer;
+    std::vector<std::shared_ptr<NPC>>& objects;
+    std::vector<size_t>& killed;
+
+    const std::shared_ptr<NPC>& object(size_t i) {
+        if (!objects[i]) objects[i] = world.materialize(i);
+        return objects[i];
+    }
+
+    bool alive(size_t i) const { return world.isAlive(i); }
+    bool duel(size_t a, size_t d) {
+        DUNGEON_METRIC_FIGHT(world.getType(a), world.getType(d));
+        if (FightTrace::enabled()) {
+            FightOutcome outcome = FightRules::current().resolve(world.getType(a), world.getType(d));
+            FightTrace::sink()->onDuel(*object(a), *object(d), outcome);
+        }
+        return kills(world[a], world[d]);
+    }
+    bool observed() const { return observer != nullptr; }
+    void observe(size_t a, size_t d, bool victory) {
+        if (!observer->accepts(world.getType(a), world.getType(d), victory)) return;
+        observer->onFight(object(a), object(d), victory);
+    }
+    void kill(size_t d) {
+        world.kill(d);
+        if (!objects.empty() && objects[d]) objects[d]->kill();
+        killed.push_back(d);
+    }
+};
+
+// один и тот же цикл для обоих способов решить исход пары
+template <class Kills>
+void runRound(VariantWorld& world, size_t range, const std::shared_ptr<IFFightObserver>& observer,
+              std::vector<size_t>& killed, Kills&& kills) {
+    const size_t count = world.size();
+    std::vector<int> xs(count), ys(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = world.getX(i);
+        ys[i] = world.getY(i);
+    }
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), count, range);
+
+    std::vector<std::shared_ptr<NPC>> objects;
+    if (observer || FightTrace::enabled()) objects.resize(count);
+    VariantRound<Kills> round{world, kills, observer.get(), objects, killed};
+    runFightLoop(grid, xs.data(), ys.data(), count, range, round);
+}
+
+}
+
+size_t VariantWorld::add(NpcType type, std::string_view name, int x, int y) {
+    NPC::checkCoordinates(x, y, bounds);
+    values.push_back(makeValue(type, name, x, y));
+    return values.size() - 1;
+}
+
+size_t VariantWorld::add(NpcValue value) {
+    std::visit([&](const auto& unit) { NPC::checkCoordinates(unit.x, unit.y, bounds); }, value);
+    values.push_back(std::move(value));
+    return values.size() - 1;
+}
+
+size_t VariantWorld::aliveCount() const {
+    size_t alive = 0;
+    for (size_t i = 0; i < values.size(); ++i) alive += isAlive(i);
+    return alive;
+}
+
+void VariantWorld::removeDead() {
+    values.erase(std::remove_if(values.begin(), values.end(), [](const NpcValue& value) {
+        return !std::visit([](const auto& unit) { return unit.alive; }, value);
+    }), values.end());
+}
+
+std::shared_ptr<NPC> VariantWorld::materialize(size_t i) const {
+    auto npc = NPCFactory::create(getType(i), getName(i), getX(i), getY(i), bounds);
+    if (npc && !isAlive(i)) npc->kill();
+    return npc;
+}
+
+VariantWorld VariantWorld::fromSet(const set_t& npc_collection) {
+    VariantWorld world;
+    world.reserve(npc_collection.size());
+    for (const auto &n : npc_collection) {
+        size_t i = world.add(n->getKind(), n->getName(), n->getX(), n->getY());
+        if (!n->isAlive()) world.kill(i);
+    }
+    return world;
+}
+
+set_t VariantWorld::toSet() const {
+    set_t result;
+    for (size_t i = 0; i < size(); ++i) {
+        result.insert(materialize(i));
+    }
+    return result;
+}
+
+std::vector<size_t> fight(VariantWorld &world, size_t range, const std::shared_ptr<IFFightObserver>& observer)
+{
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    std::vector<size_t> killed;
+
+    const FightRules& rules = FightRules::current();
+    if (rules == defaultFightRules) {
+        runRound(world, range, observer, killed, [](const NpcValue& attacker, const NpcValue& defender) {
+            return std::visit([](const auto& a, const auto& d) {
+                return defaultKills<std::decay_t<decltype(a)>, std::decay_t<decltype(d)>>();
+            }, attacker, defender);
+        });
+    } else {
+        runRound(world, range, observer, killed, [&rules](const NpcValue& attacker, const NpcValue& defender) {
+            return std::visit([&rules](const auto& a, const auto& d) {
+                return rules.kills(std::decay_t<decltype(a)>::kind, std::decay_t<decltype(d)>::kind);
+            }, attacker, defender);
+        });
+    }
+    return killed;
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "world.h"
+#include "fightLoop.h"
+#include "fightVisitor.h"
+#include "metrics.h"
+#include "spatialGrid.h"
+#include "worldFile.h"
+
+std::shared_ptr<NPC> createFromStream(std::istream &is)
+{
+    return NPCFactory::create(is);
+}
+
+std::shared_ptr<NPC> createNPC(NpcType type, std::string_view name, int x, int y, NpcArena* arena)
+{
+    if (arena) return NPCFactory::create(type, name, x, y, *arena);
+    return NPCFactory::create(type, name, x, y);
+}
+
+void saveNPC(const set_t &npc_collection, const std::string &file_name)
+{
+    std::ofstream file(file_name);
+    NPCFactory::saveBounds(WorldBounds::current(), file);
+    for (auto &n : npc_collection)
+        NPCFactory::save(n, file);
+    file.flush();
+    file.close();
+    std::cout << "Saved " << npc_collection.size() << " NPC in " << file_name << std::endl;
+}
+
+set_t loadNPC(const std::string &file_name, NpcArena* arena)
+{
+    set_t loaded;
+    // строки разбираются на месте, без istringstream на каждую
+    bool opened = WorldFile::scanText(file_name, [&](NpcType type, std::string_view name, int x, int y) {
+        loaded.insert(createNPC(type, name, x, y, arena));
+    });
+    if (opened) {
+        std::cout << "Loaded " << loaded.size() << " NPC from " << file_name << std::endl;
+    }
+    else {
+        std::cerr << "Err: can't open file: " << file_name << std::endl;
+    }
+    return loaded;
+}
+
+std::ostream &operator<<(std::ostream &os, const set_t &npc_collection)
+{
+    os << "Total NPCs: " << npc_collection.size() << std::endl;
+    for (auto &n : npc_collection) {
+        os << n->getType() << " \"" << n->getName()
+           << "\" at position: (" << n->getX() << ", " << n->getY() << ")"
+           << " - " << (n->isAlive() ? "Alive" : "Dead") << std::endl;
+    }
+    return os;
+}
+
+namespace {
+
+// снимок set_t для runFightLoop
+struct SetRound {
+    const std::vector<std::shared_ptr<NPC>>& npcs;
+    IFFightObserver* observer;
+    set_t& killed;
+
+    bool alive(size_t i) const { return npcs[i]->isAlive(); }
+    // исход - одна выборка из FightRules, без визитора и dynamic_pointer_cast
+    bool duel(size_t a, size_t d) const { return npcs[a]->duel(*npcs[d]); }
+    bool observed() const { return observer != nullptr; }
+    void observe(size_t a, size_t d, bool victory) { observer->onFight(npcs[a], npcs[d], victory); }
+    void kill(size_t d) {
+        npcs[d]->kill();
+        killed.insert(npcs[d]);
+    }
+};
+
+}
+
+set_t fight(const set_t &npc_collection, size_t range, const std::shared_ptr<IFFightObserver>& observer)
+{
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    set_t killed_npcs;
+
+    // снимок в порядке множества: индекс = позиция при полном переборе
+    std::vector<std::shared_ptr<NPC>> npcs(npc_collection.begin(), npc_collection.end());
+    std::vector<int> xs(npcs.size()), ys(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        xs[i] = npcs[i]->getX();
+        ys[i] = npcs[i]->getY();
+    }
+
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), npcs.size(), range);
+
+    // в круге - по квадрату целой дистанции, это то же самое, что distance() <= range;
+    // защитники в том же порядке, что и в переборе - наблюдатели видят ту же последовательность
+    std::vector<uint32_t> candidates;
+    SetRound round{npcs, observer.get(), killed_npcs};
+    runFightLoop(grid, xs.data(), ys.data(), npcs.size(), range, round, &candidates);
+    return killed_npcs;
+}
+
+set_t fightBruteForce(const set_t &npc_collection, size_t range, const std::shared_ptr<IFFightObserver>& observer)
+{
+    DUNGEON_METRIC_TIMER(Round);
+    DUNGEON_METRIC_ADD(Rounds, 1);
+    set_t killed_npcs;
+
+    for (const auto &attacker : npc_collection) {
+        if (!attacker->isAlive()) continue;
+
+        // визитор на стеке, accept получает на него shared_ptr без владения -
+        // ни одного выделения памяти на пару
+        FightVisitor visitor(attacker, observer);
+        const std::shared_ptr<FightVisitor> visitorRef(std::shared_ptr<FightVisitor>(), &visitor);
+
+        for (const auto &defender : npc_collection) {
+            if (!defender->isAlive()) continue;
+            if (attacker == defender) continue;
+
+            DUNGEON_METRIC_ADD(PairsExamined, 1);
+            if (attacker->distance(defender) <= range) {
+                DUNGEON_METRIC_ADD(PairsInRange, 1);
+                bool victory = defender->accept(visitorRef);
+
+                if (victory && defender->isAlive()) {
+                    defender->kill();
+                    killed_npcs.insert(defender);
+                    DUNGEON_METRIC_ADD(Kills, 1);
+                }
+            }
+        }
+    }
+
+    return killed_npcs;
+}
+
+std::string generateName(const std::string& type, int n) {
+    return type + "_" + std::to_string(n);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include <stdexcept>
+
+#include "worldBounds.h"
+
+namespace {
+WorldBounds activeBounds = defaultWorldBounds;
+}
+
+std::string WorldBounds::describe() const {
+    if (minX == minY && maxX == maxY) {
+        return std::to_string(minX) + "-" + std::to_string(maxX);
+    }
+    return "x " + std::to_string(minX) + "-" + std::to_string(maxX)
+         + ", y " + std::to_string(minY) + "-" + std::to_string(maxY);
+}
+
+const WorldBounds& WorldBounds::current() {
+    return activeBounds;
+}
+
+void WorldBounds::install(const WorldBounds& bounds) {
+    if (!bounds.valid()) {
+        throw std::runtime_error("World bounds are empty: " + bounds.describe());
+    }
+    activeBounds = bounds;
+}
\ No newline at end of file
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "worldFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORLD_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'D', 'N', 'G', 'W'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// файл целиком в памяти только для чтения: mmap, где он есть, иначе чтение в буфер
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef WORLD_FILE_MMAP
+    void* mapping = nullptr;
+#else
+    std::vector<char> buffer;
+#endif
+
+public:
+    // required == false: вместо исключения остается закрытым (isOpen() == false)
+    explicit MappedFile(const std::string& file_name, bool required = true) {
+#ifdef WORLD_FILE_MMAP
+        int fd = ::open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (!required) return;
+            throw std::runtime_error("Can't open world file: " + file_name);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Can't stat world file: " + file_name);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                ::close(fd);
+                throw std::runtime_error("Can't map world file: " + file_name);
+            }
+            ::madvise(mapping, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(file_name, std::ios::binary);
+        if (!file.is_open()) {
+            if (!required) return;
+            throw std::runtime_error("Can't open world file: " + file_name);
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        bytes = buffer.data();
+        length = buffer.size();
+#endif
+        opened = true;
+    }
+
+    ~MappedFile() {
+#ifdef WORLD_FILE_MMAP
+        if (mapping) ::munmap(mapping, length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// строки как у getline: по '\n', последняя может быть без него
+template <class Fn>
+void forEachLine(const char* data, size_t size, Fn&& fn) {
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* lineEnd = newline ? newline : end;
+        fn(std::string_view(p, static_cast<size_t>(lineEnd - p)));
+        p = newline ? newline + 1 : end;
+    }
+}
+
+// строка #bounds бывает только первой; пустой мир принимает эти границы
+void adoptBounds(const char* data, size_t size, NpcWorld& world) {
+    if (size == 0) return;
+    const void* newline = std::memchr(data, '\n', size);
+    const size_t length = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) : size;
+    WorldBounds bounds;
+    if (world.empty() && NPCFactory::parseBounds(std::string_view(data, length), bounds)) {
+        world.setBounds(bounds);
+    }
+}
+
+size_t countLines(const char* data, size_t size) {
+    size_t lines = 0;
+    forEachLine(data, size, [&](std::string_view) { ++lines; });
+    return lines;
+}
+
+}
+
+void WorldFile::saveBinary(const NpcWorld& world, const std::string& file_name) {
+    if (world.names.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("World names do not fit 32-bit offsets");
+    }
+
+    WorldFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.recordSize = sizeof(WorldFileRecord);
+    header.count = world.size();
+    header.namesBytes = world.names.size();
+
+    std::vector<WorldFileRecord> records(world.size());
+    for (size_t i = 0; i < world.size(); ++i) {
+        WorldFileRecord& r = records[i];
+        r.type = static_cast<uint8_t>(world.types[i]);
+        r.alive = world.alive[i];
+        r.reserved = 0;
+        r.x = world.xs[i];
+        r.y = world.ys[i];
+        r.nameOffset = world.nameStart[i];
+        r.nameLength = world.nameStart[i + 1] - world.nameStart[i];
+    }
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Can't create world file: " + file_name);
+    }
+    const WorldBounds& bounds = world.getBounds();
+    const WorldFileBounds fileBounds{bounds.minX, bounds.minY, bounds.maxX, bounds.maxY};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&fileBounds), sizeof(fileBounds));
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(WorldFileRecord)));
+    file.write(world.names.data(), static_cast<std::streamsize>(world.names.size()));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Can't write world file: " + file_name);
+    }
+}
+
+NpcWorld WorldFile::loadBinary(const std::string& file_name) {
+    MappedFile file(file_name);
+
+    WorldFileHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("World file is truncated: " + file_name);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a world file: " + file_name);
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+        throw std::runtime_error("World file has foreign byte order: " + file_name);
+    }
+    if (header.version < 1 || header.version > VERSION || header.recordSize != sizeof(WorldFileRecord)) {
+        throw std::runtime_error("Unsupported world file version: " + file_name);
+    }
+
+    WorldBounds bounds = defaultWorldBounds;
+    size_t headerBytes = sizeof(header);
+    if (header.version >= 2) {
+        WorldFileBounds fileBounds;
+        if (file.size() < headerBytes + sizeof(fileBounds)) {
+            throw std::runtime_error("World file is truncated: " + file_name);
+        }
+        std::memcpy(&fileBounds, file.data() + headerBytes, sizeof(fileBounds));
+        headerBytes += sizeof(fileBounds);
+        bounds = WorldBounds{fileBounds.minX, fileBounds.minY, fileBounds.maxX, fileBounds.maxY};
+        if (!bounds.valid()) {
+            throw std::runtime_error("Corrupted world bounds in " + file_name);
+        }
+    }
+
+    const size_t body = file.size() - headerBytes;
+    if (header.count > body / sizeof(WorldFileRecord)
+        || header.namesBytes != body - header.count * sizeof(WorldFileRecord)) {
+        throw std::runtime_error("World file is truncated: " + file_name);
+    }
+
+    const size_t count = static_cast<size_t>(header.count);
+    const char* records = file.data() + headerBytes;
+    const char* names = records + count * sizeof(WorldFileRecord);
+
+    NpcWorld world(bounds);
+    world.xs.resize(count);
+    world.ys.resize(count);
+    world.types.resize(count);
+    world.alive.resize(count);
+    world.nameStart.resize(count + 1);
+    // имена лежат подряд в порядке записей - одна копия всей таблицы
+    world.names.assign(names, static_cast<size_t>(header.namesBytes));
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        WorldFileRecord r;
+        std::memcpy(&r, records + i * sizeof(WorldFileRecord), sizeof(r));
+        if (r.type >= NPC_TYPE_COUNT || r.nameOffset != offset || r.nameLength > header.namesBytes - offset) {
+            throw std::runtime_error("Corrupted world record " + std::to_string(i) + " in " + file_name);
+        }
+        NPC::checkCoordinates(r.x, r.y, bounds);
+        world.xs[i] = r.x;
+        world.ys[i] = r.y;
+        world.types[i] = static_cast<NpcType>(r.type);
+        world.alive[i] = r.alive ? 1 : 0;
+        world.nameStart[i] = offset;
+        offset += r.nameLength;
+    }
+    world.nameStart[count] = offset;
+    if (offset != header.namesBytes) {
+        throw std::runtime_error("Corrupted world name table in " + file_name);
+    }
+    return world;
+}
+
+bool WorldFile::isBinary(const std::string& file_name) {
+    std::ifstream file(file_name, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool WorldFile::loadText(const std::string& file_name, NpcWorld& world, TextLoadStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(file_name, false);
+    if (!file.isOpen()) return false;
+
+    adoptBounds(file.data(), file.size(), world);
+    const size_t lines = countLines(file.data(), file.size());
+    const size_t before = world.size();
+    world.reserve(before + lines, world.names.size() + file.size() / 2);
+    forEachLine(file.data(), file.size(), [&](std::string_view line) {
+        NpcType type;
+        std::string_view name;
+        int x, y;
+        if (NPCFactory::parse(line, type, name, x, y)) {
+            world.add(type, name, x, y);
+        }
+    });
+
+    if (stats) {
+        stats->lines = lines;
+        stats->loaded = world.size() - before;
+        stats->skipped = lines - stats->loaded;
+        stats->bytes = file.size();
+        stats->chunks = 1;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+bool WorldFile::loadTextParallel(const std::string& file_name, NpcWorld& world, ThreadPool& pool,
+                                 TextLoadStats* stats, size_t chunkBytes) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(file_name, false);
+    if (!file.isOpen()) return false;
+
+    // границы кусков сдвигаются на начало следующей строки
+    const char* data = file.data();
+    const size_t size = file.size();
+    adoptBounds(data, size, world);
+    if (chunkBytes == 0) chunkBytes = 1;
+    std::vector<size_t> bounds{0};
+    while (bounds.back() < size) {
+        size_t target = bounds.back() + chunkBytes;
+        if (target >= size) {
+            bounds.push_back(size);
+            break;
+        }
+        const void* newline = std::memchr(data + target, '\n', size - target);
+        bounds.push_back(newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) + 1 : size);
+    }
+    const size_t chunkCount = bounds.size() - 1;
+
+    struct Chunk {
+        NpcWorld npcs;
+        size_t lines = 0;
+        std::exception_ptr error;   // первая ошибка куска, строки до нее уже в npcs
+    };
+    std::vector<Chunk> chunks(chunkCount);
+
+    pool.run(chunkCount, [&](size_t c, size_t) {
+        Chunk& chunk = chunks[c];
+        const char* from = data + bounds[c];
+        const size_t length = bounds[c + 1] - bounds[c];
+        chunk.lines = countLines(from, length);
+        chunk.npcs.setBounds(world.getBounds());
+        chunk.npcs.reserve(chunk.lines, length / 2);
+        try {
+            forEachLine(from, length, [&](std::string_view line) {
+                NpcType type;
+                std::string_view name;
+                int x, y;
+                if (NPCFactory::parse(line, type, name, x, y)) {
+                    chunk.npcs.add(type, name, x, y);
+                }
+            });
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+    });
+
+    // куски после первой ошибки не попадают в мир - как при последовательном чтении
+    size_t used = 0;
+    while (used < chunkCount && !chunks[used].error) ++used;
+    const size_t merged = used < chunkCount ? used + 1 : chunkCount;
+
+    std::vector<size_t> firstIndex(merged + 1), firstName(merged + 1);
+    firstIndex[0] = world.size();
+    firstName[0] = world.names.size();
+    for (size_t c = 0; c < merged; ++c) {
+        firstIndex[c + 1] = firstIndex[c] + chunks[c].npcs.size();
+        firstName[c + 1] = firstName[c] + chunks[c].npcs.names.size();
+    }
+    if (firstName[merged] > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("World names do not fit 32-bit offsets: " + file_name);
+    }
+
+    const size_t total = firstIndex[merged];
+    world.touchAll(firstIndex[0]);
+    world.xs.resize(total);
+    world.ys.resize(total);
+    world.types.resize(total);
+    world.alive.resize(total);
+    world.nameStart.resize(total + 1);
+    world.names.resize(firstName[merged]);
+    world.nameStart[total] = static_cast<uint32_t>(firstName[merged]);
+
+    pool.run(merged, [&](size_t c, size_t) {
+        const NpcWorld& part = chunks[c].npcs;
+        const size_t at = firstIndex[c];
+        const uint32_t nameBase = static_cast<uint32_t>(firstName[c]);
+        std::copy(part.xs.begin(), part.xs.end(), world.xs.begin() + at);
+        std::copy(part.ys.begin(), part.ys.end(), world.ys.begin() + at);
+        std::copy(part.types.begin(), part.types.end(), world.types.begin() + at);
+        std::copy(part.alive.begin(), part.alive.end(), world.alive.begin() + at);
+        std::copy(part.names.begin(), part.names.end(), world.names.begin() + nameBase);
+        for (size_t i = 0; i < part.size(); ++i) {
+            world.nameStart[at + i] = nameBase + part.nameStart[i];
+        }
+    });
+
+    if (used < chunkCount) std::rethrow_exception(chunks[used].error);
+
+    if (stats) {
+        stats->lines = 0;
+        for (const Chunk& chunk : chunks) stats->lines += chunk.lines;
+        stats->loaded = total - firstIndex[0];
+        stats->skipped = stats->lines - stats->loaded;
+        stats->bytes = size;
+        stats->chunks = chunkCount;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+bool WorldFile::scanText(const std::string& file_name,
+                         const std::function<void(NpcType type, std::string_view name, int x, int y)>& fn) {
+    MappedFile file(file_name, false);
+    if (!file.isOpen()) return false;
+
+    forEachLine(file.data(), file.size(), [&](std::string_view line) {
+        NpcType type;
+        std::string_view name;
+        int x, y;
+        if (NPCFactory::parse(line, type, name, x, y)) {
+            fn(type, name, x, y);
+        }
+    });
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "factory.h"
+#include "worldGenerator.h"
+
+namespace {
+
+uint64_t splitmix(uint64_t v) {
+    v += 0x9e3779b97f4a7c15ull;
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+    return v ^ (v >> 31);
+}
+
+// lo + [0, span) по 32 случайным битам, span <= 2^32 - умножение без деления.
+// В 64 битах: у края карты результат может выйти за int32, сужает вызывающий
+long long spread(long long lo, uint64_t span, uint32_t bits) {
+    return lo + static_cast<long long>((bits * span) >> 32);
+}
+
+uint32_t low(uint64_t v) { return static_cast<uint32_t>(v); }
+uint32_t high(uint64_t v) { return static_cast<uint32_t>(v >> 32); }
+
+// самая длинная строка "Dragon Dragon_4294967295 -2147483648 -2147483648\n" короче
+constexpr size_t MAX_LINE = 64;
+
+}
+
+WorldGenerator::WorldGenerator(const WorldGeneratorOptions& options) : options(options) {
+    if (!options.bounds.valid()) {
+        throw std::runtime_error("Generator bounds are invalid: " + options.bounds.describe());
+    }
+    if (options.count > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Generator count must be below 2^32");
+    }
+    if (options.clusterRadius < 0 || options.cellSize < 1) {
+        throw std::runtime_error("Generator cluster radius and cell size must be positive");
+    }
+    for (uint32_t weight : options.typeWeights) totalWeight += weight;
+    if (totalWeight == 0 || totalWeight > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Generator type weights must sum to 1..2^32-1");
+    }
+    if (this->options.clusters == 0) this->options.clusters = 1;
+    if (this->options.chunkSize == 0) this->options.chunkSize = 1;
+    pool = std::make_unique<ThreadPool>(options.threads);
+}
+
+void WorldGenerator::npcAt(size_t i, NpcType& type, int& x, int& y) const {
+    const WorldBounds& b = options.bounds;
+    const uint64_t h = splitmix(options.seed ^ splitmix(i));
+    const uint64_t p = splitmix(h);
+
+    // тип - по старшим битам h, доли через умножение
+    uint64_t pick = (uint64_t{high(h)} * totalWeight) >> 32;
+    size_t t = 0;
+    while (pick >= options.typeWeights[t]) pick -= options.typeWeights[t++];
+    type = static_cast<NpcType>(t);
+
+    const uint64_t width = static_cast<uint64_t>(b.width()) + 1;
+    const uint64_t height = static_cast<uint64_t>(b.height()) + 1;
+    switch (options.layout) {
+        case SpawnLayout::Uniform:
+            x = static_cast<int>(spread(b.minX, width, low(p)));
+            y = static_cast<int>(spread(b.minY, height, high(p)));
+            break;
+        case SpawnLayout::Clustered: {
+            // центр кучки - тоже хэш, от seed и номера кучки
+            const uint64_t cluster = (uint64_t{low(h)} * options.clusters) >> 32;
+            const uint64_t c = splitmix(~options.seed ^ splitmix(cluster));
+            const long long cx = spread(b.minX, width, low(c));
+            const long long cy = spread(b.minY, height, high(c));
+            const long long r = options.clusterRadius;
+            const uint64_t side = 2 * static_cast<uint64_t>(r) + 1;
+            x = static_cast<int>(std::clamp<long long>(spread(cx - r, side, low(p)), b.minX, b.maxX));
+            y = static_cast<int>(std::clamp<long long>(spread(cy - r, side, high(p)), b.minY, b.maxY));
+            break;
+        }
+        case SpawnLayout::SingleCell: {
+            // квадрат посреди карты
+            const uint64_t sideX = std::min<uint64_t>(options.cellSize, width);
+            const uint64_t sideY = std::min<uint64_t>(options.cellSize, height);
+            x = static_cast<int>(spread(b.minX + static_cast<long long>((width - sideX) / 2), sideX, low(p)));
+            y = static_cast<int>(spread(b.minY + static_cast<long long>((height - sideY) / 2), sideY, high(p)));
+            break;
+        }
+    }
+}
+
+size_t WorldGenerator::nameLength(NpcType type, size_t i) {
+    size_t digits = 1;
+    for (size_t v = i; v >= 10; v /= 10) ++digits;
+    return std::strlen(npcTypeName(type)) + 1 + digits;
+}
+
+char* WorldGenerator::writeName(char* out, NpcType type, size_t i) {
+    const char* typeName = npcTypeName(type);
+    const size_t length = std::strlen(typeName);
+    std::memcpy(out, typeName, length);
+    out += length;
+    *out++ = '_';
+    return std::to_chars(out, out + 20, i).ptr;
+}
+
+void WorldGenerator::generate(NpcWorld& world) {
+    const WorldBounds& b = options.bounds;
+    if (world.empty()) {
+        world.setBounds(b);
+    } else if (!world.getBounds().contains(b.minX, b.minY) || !world.getBounds().contains(b.maxX, b.maxY)) {
+        throw std::runtime_error("Generator bounds " + b.describe() + " do not fit the world " +
+                                 world.getBounds().describe());
+    }
+
+    const size_t first = world.size();
+    const size_t count = options.count;
+    const size_t chunkSize = options.chunkSize;
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    world.touchAll(first);
+    world.xs.resize(first + count);
+    world.ys.resize(first + count);
+    world.types.resize(first + count);
+    world.alive.resize(first + count, 1);
+    world.nameStart.resize(first + count + 1);
+
+    // проход 1: столбцы и длина имен каждого куска
+    std::vector<size_t> nameOffset(chunkCount + 1, 0);
+    pool->run(chunkCount, [&](size_t chunk, size_t) {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(count, begin + chunkSize);
+        size_t bytes = 0;
+        for (size_t i = begin; i < end; ++i) {
+            NpcType type;
+            int x, y;
+            npcAt(i, type, x, y);
+            world.types[first + i] = type;
+            world.xs[first + i] = x;
+            world.ys[first + i] = y;
+            bytes += nameLength(type, first + i);
+        }
+        nameOffset[chunk + 1] = bytes;
+    });
+
+    nameOffset[0] = world.names.size();
+    for (size_t c = 0; c < chunkCount; ++c) nameOffset[c + 1] += nameOffset[c];
+    if (nameOffset[chunkCount] > std::numeric_limits<uint32_t>::max()) {
+        world.xs.resize(first);
+        world.ys.resize(first);
+        world.types.resize(first);
+        world.alive.resize(first);
+        world.nameStart.resize(first + 1);
+        throw std::runtime_error("World names do not fit 32-bit offsets");
+    }
+
+    // проход 2: имена прямо в общий буфер, каждый кусок со своего смещения
+    world.names.resize(nameOffset[chunkCount]);
+    world.nameStart[first + count] = static_cast<uint32_t>(nameOffset[chunkCount]);
+    pool->run(chunkCount, [&](size_t chunk, size_t) {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(count, begin + chunkSize);
+        char* const base = world.names.data();
+        size_t offset = nameOffset[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            world.nameStart[first + i] = static_cast<uint32_t>(offset);
+            offset = static_cast<size_t>(writeName(base + offset, world.types[first + i], first + i) - base);
+        }
+    });
+}
+
+NpcWorld WorldGenerator::generate() {
+    NpcWorld world(options.bounds);
+    generate(world);
+    return world;
+}
+
+void WorldGenerator::generateToFile(const std::string& file_name) {
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Can't create world file: " + file_name);
+    }
+    NPCFactory::saveBounds(options.bounds, file);
+
+    // по два куска на поток за раз: буферы переиспользуются, мир целиком не копится
+    const size_t count = options.count;
+    const size_t chunkSize = options.chunkSize;
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    std::vector<std::string> buffers(std::min(chunkCount, pool->size() * 2));
+    for (size_t firstChunk = 0; firstChunk < chunkCount; firstChunk += buffers.size()) {
+        const size_t batch = std::min(buffers.size(), chunkCount - firstChunk);
+        pool->run(batch, [&](size_t k, size_t) {
+            const size_t begin = (firstChunk + k) * chunkSize;
+            const size_t end = std::min(count, begin + chunkSize);
+            std::string& out = buffers[k];
+            out.resize((end - begin) * MAX_LINE);
+            char* p = out.data();
+            char* const limit = p + out.size();
+            for (size_t i = begin; i < end; ++i) {
+                NpcType type;
+                int x, y;
+                npcAt(i, type, x, y);
+                const char* typeName = npcTypeName(type);
+                const size_t length = std::strlen(typeName);
+                std::memcpy(p, typeName, length);
+                p += length;
+                *p++ = ' ';
+                p = writeName(p, type, i);
+                *p++ = ' ';
+                p = std::to_chars(p, limit, x).ptr;
+                *p++ = ' ';
+                p = std::to_chars(p, limit, y).ptr;
+                *p++ = '\n';
+            }
+            out.resize(static_cast<size_t>(p - out.data()));
+        });
+        for (size_t k = 0; k < batch; ++k) {
+            file.write(buffers[k].data(), static_cast<std::streamsize>(buffers[k].size()));
+        }
+    }
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Can't write world file: " + file_name);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "worldJournal.h"
+#include "worldFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WORLD_JOURNAL_POSIX 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'D', 'N', 'G', 'J'};
+
+uint32_t checksum(const char* data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+uint64_t mix(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 1099511628211ull;
+}
+
+// дописывает в конец файла одним write; truncate - файл пишется заново
+void writeFile(const std::string& file_name, const char* data, size_t size, bool truncate, bool sync) {
+#ifdef WORLD_JOURNAL_POSIX
+    int fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : O_APPEND), 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open journal: " + file_name);
+    }
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            ::close(fd);
+            throw std::runtime_error("Can't write journal: " + file_name);
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    bool synced = !sync || ::fsync(fd) == 0;
+    if (::close(fd) != 0 || !synced) {
+        throw std::runtime_error("Can't write journal: " + file_name);
+    }
+#else
+    (void)sync;
+    std::ofstream file(file_name, std::ios::binary | (truncate ? std::ios::trunc : std::ios::app));
+    if (!file.is_open()) {
+        throw std::runtime_error("Can't open journal: " + file_name);
+    }
+    file.write(data, static_cast<std::streamsize>(size));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Can't write journal: " + file_name);
+    }
+#endif
+}
+
+// fsync уже записанного файла или каталога (после rename - чтобы новое имя пережило сбой)
+void syncPath(const std::string& path) {
+#ifdef WORLD_JOURNAL_POSIX
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open for sync: " + path);
+    }
+    bool synced = ::fsync(fd) == 0;
+    if (::close(fd) != 0 || !synced) {
+        throw std::runtime_error("Can't sync: " + path);
+    }
+#else
+    (void)path;
+#endif
+}
+
+std::string directoryOf(const std::string& file_name) {
+    std::filesystem::path parent = std::filesystem::path(file_name).parent_path();
+    return parent.empty() ? std::string(".") : parent.string();
+}
+
+}
+
+WorldJournal::WorldJournal(const std::string& file_name, size_t compactBytes)
+    : snapshotFile(file_name), journalFile(file_name + ".journal"), compactBytes(compactBytes) {}
+
+uint64_t WorldJournal::fingerprint(const NpcWorld& world) {
+    uint64_t hash = mix(14695981039346656037ull, world.size());
+    const WorldBounds& bounds = world.getBounds();
+    hash = mix(hash, static_cast<uint32_t>(bounds.minX) | (uint64_t{static_cast<uint32_t>(bounds.minY)} << 32));
+    hash = mix(hash, static_cast<uint32_t>(bounds.maxX) | (uint64_t{static_cast<uint32_t>(bounds.maxY)} << 32));
+    for (size_t i = 0; i < world.size(); ++i) {
+        std::string_view name = world.getName(i);
+        hash = mix(hash, static_cast<uint64_t>(world.getType(i)) | (uint64_t{world.isAlive(i)} << 8));
+        hash = mix(hash, static_cast<uint32_t>(world.getX(i)) | (uint64_t{static_cast<uint32_t>(world.getY(i))} << 32));
+        hash = mix(hash, name.size());
+        hash = mix(hash, checksum(name.data(), name.size()));
+    }
+    return hash;
+}
+
+void WorldJournal::startJournal(uint64_t fingerprint, const WorldBounds& bounds) {
+    JournalHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.fingerprint = fingerprint;
+    header.minX = bounds.minX;
+    header.minY = bounds.minY;
+    header.maxX = bounds.maxX;
+    header.maxY = bounds.maxY;
+    writeFile(journalFile, reinterpret_cast<const char*>(&header), sizeof(header), true, true);
+    committedBytes = sizeof(header);
+    pending.clear();
+    opened = true;
+}
+
+JournalRecovery WorldJournal::open(NpcWorld& world) {
+    JournalRecovery recovery;
+    world.clear();
+    const bool hasSnapshot = std::filesystem::exists(snapshotFile);
+    if (hasSnapshot) {
+        world = WorldFile::loadBinary(snapshotFile);
+    }
+    recovery.snapshotNpcs = world.size();
+
+    std::vector<char> bytes;
+    {
+        std::ifstream file(journalFile, std::ios::binary);
+        if (file.is_open()) {
+            bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+    // нет журнала или сбой при записи самого заголовка
+    if (bytes.size() < sizeof(JournalHeader)) {
+        recovery.discardedBytes = bytes.size();
+        startJournal(fingerprint(world), world.getBounds());
+        return recovery;
+    }
+
+    JournalHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a journal file: " + journalFile);
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error("Unsupported journal version: " + journalFile);
+    }
+    if (!hasSnapshot) {
+        world.setBounds(WorldBounds{header.minX, header.minY, header.maxX, header.maxY});
+    }
+
+    // целые записи подряд от заголовка: сумма сошлась - запись не оборвана
+    std::vector<size_t> records;
+    size_t offset = sizeof(header);
+    while (bytes.size() - offset >= sizeof(JournalRecord) + sizeof(uint32_t)) {
+        JournalRecord r;
+        std::memcpy(&r, bytes.data() + offset, sizeof(r));
+        const size_t length = sizeof(r) + r.nameLength;
+        if (bytes.size() - offset < length + sizeof(uint32_t)) break;
+        uint32_t stored;
+        std::memcpy(&stored, bytes.data() + offset + length, sizeof(stored));
+        if (stored != checksum(bytes.data() + offset, length)) break;
+        records.push_back(offset);
+        offset += length + sizeof(uint32_t);
+    }
+    auto recordAt = [&](size_t k) {
+        JournalRecord r;
+        std::memcpy(&r, bytes.data() + records[k], sizeof(r));
+        return r;
+    };
+
+    // журнал не от этого снимка: годится, только если в нем есть отметка compact()
+    // о замене снимка именно этим миром - тогда повторяется то, что после нее
+    const uint64_t expected = fingerprint(world);
+    size_t first = 0;
+    if (header.fingerprint != expected) {
+        size_t k = records.size();
+        for (; k > 0; --k) {
+            const JournalRecord r = recordAt(k - 1);
+            const uint64_t target = uint64_t{static_cast<uint32_t>(r.x)} | (uint64_t{static_cast<uint32_t>(r.y)} << 32);
+            if (static_cast<JournalOp>(r.op) == JournalOp::Compact && target == expected) break;
+        }
+        if (k == 0) {
+            throw std::runtime_error("Journal does not belong to the snapshot: " + journalFile);
+        }
+        recovery.staleJournal = true;
+        if (k == records.size()) {
+            recovery.discardedBytes = bytes.size() - offset;
+            startJournal(expected, world.getBounds());
+            return recovery;
+        }
+        first = k;
+    }
+
+    for (size_t k = first; k < records.size(); ++k) {
+        // сумма сошлась, значит запись целая - несоответствие миру уже порча, а не обрыв
+        const JournalRecord r = recordAt(k);
+        const std::string_view name(bytes.data() + records[k] + sizeof(r), r.nameLength);
+        const JournalOp op = static_cast<JournalOp>(r.op);
+        const bool needsIndex = op == JournalOp::Kill || op == JournalOp::Move;
+        if ((op == JournalOp::Create && r.type >= NPC_TYPE_COUNT)
+            || (needsIndex && r.index >= world.size())
+            || (!needsIndex && op != JournalOp::Create && op != JournalOp::Purge && op != JournalOp::Compact)) {
+            throw std::runtime_error("Corrupted journal record " + std::to_string(k) + " in " + journalFile);
+        }
+        switch (op) {
+            case JournalOp::Create:  world.add(static_cast<NpcType>(r.type), name, r.x, r.y); break;
+            case JournalOp::Kill:    world.kill(r.index); break;
+            case JournalOp::Move:    world.move(r.index, r.x, r.y); break;
+            case JournalOp::Purge:   world.removeDead(); break;
+            case JournalOp::Compact: break;
+        }
+        ++recovery.replayed;
+    }
+
+    recovery.discardedBytes = bytes.size() - offset;
+    if (recovery.discardedBytes > 0) {
+        std::filesystem::resize_file(journalFile, offset);
+    }
+    committedBytes = offset;
+    pending.clear();
+    opened = true;
+    return recovery;
+}
+
+void WorldJournal::append(JournalOp op, NpcType type, std::string_view name, size_t index, int x, int y) {
+    if (name.size() > std::numeric_limits<uint16_t>::max()) {
+        throw std::runtime_error("NPC name is too long for the journal");
+    }
+    if (index > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("NPC index does not fit the journal");
+    }
+    JournalRecord r{};
+    r.op = static_cast<uint8_t>(op);
+    r.type = static_cast<uint8_t>(type);
+    r.nameLength = static_cast<uint16_t>(name.size());
+    r.index = static_cast<uint32_t>(index);
+    r.x = x;
+    r.y = y;
+
+    const size_t start = pending.size();
+    pending.append(reinterpret_cast<const char*>(&r), sizeof(r));
+    pending.append(name);
+    uint32_t sum = checksum(pending.data() + start, pending.size() - start);
+    pending.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+}
+
+void WorldJournal::create(NpcType type, std::string_view name, int x, int y) {
+    append(JournalOp::Create, type, name, 0, x, y);
+}
+
+void WorldJournal::kill(size_t index) {
+    append(JournalOp::Kill, NpcType::Toad, {}, index, 0, 0);
+}
+
+void WorldJournal::kill(const std::vector<size_t>& indices) {
+    for (size_t index : indices) kill(index);
+}
+
+void WorldJournal::move(size_t index, int x, int y) {
+    append(JournalOp::Move, NpcType::Toad, {}, index, x, y);
+}
+
+void WorldJournal::purge() {
+    append(JournalOp::Purge, NpcType::Toad, {}, 0, 0, 0);
+}
+
+void WorldJournal::commit(bool sync) {
+    if (!opened) {
+        throw std::runtime_error("Journal is not open: " + journalFile);
+    }
+    if (pending.empty()) return;
+    writeFile(journalFile, pending.data(), pending.size(), false, sync);
+    committedBytes += pending.size();
+    pending.clear();
+}
+
+void WorldJournal::compact(const NpcWorld& world) {
+    const uint64_t target = fingerprint(world);
+    if (opened) {
+        // отметка до замены снимка: при сбое до startJournal open() по ней узнает,
+        // что снимок уже новый и старый журнал до этого места в нем
+        append(JournalOp::Compact, NpcType::Toad, {}, 0, static_cast<int32_t>(static_cast<uint32_t>(target)),
+               static_cast<int32_t>(static_cast<uint32_t>(target >> 32)));
+        commit(true);
+    }
+    const std::string temporary = snapshotFile + ".tmp";
+    WorldFile::saveBinary(world, temporary);
+    // порядок важен: снимок на диске целиком, потом новое имя на диске, и только
+    // потом журнал очищается - иначе после сбоя питания не будет ни того, ни другого
+    syncPath(temporary);
+    std::filesystem::rename(temporary, snapshotFile);
+    syncPath(directoryOf(snapshotFile));
+    // сбой здесь безопасен: в старом журнале последняя - отметка Compact с этим снимком
+    startJournal(target, world.getBounds());
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "worldSnapshot.h"
+
+WorldSnapshot::WorldSnapshot() : data(std::make_shared<Data>()) {}
+
+std::string_view WorldSnapshot::getName(size_t i) const {
+    const Identity& identity = *data->chunks[i / CHUNK].identity;
+    const size_t k = i % CHUNK;
+    return std::string_view(identity.names).substr(identity.nameStart[k], identity.nameStart[k + 1] - identity.nameStart[k]);
+}
+
+size_t WorldSnapshot::memoryUsage() const {
+    return changedBytes(WorldSnapshot());
+}
+
+size_t WorldSnapshot::changedBytes(const WorldSnapshot& other) const {
+    const std::vector<Chunk>& mine = data->chunks;
+    const std::vector<Chunk>& theirs = other.data->chunks;
+    size_t bytes = 0;
+    for (size_t c = 0; c < mine.size(); ++c) {
+        const Chunk* shared = c < theirs.size() ? &theirs[c] : nullptr;
+        if (!shared || mine[c].positions != shared->positions) {
+            bytes += mine[c].positions->xs.capacity() * sizeof(int) + mine[c].positions->ys.capacity() * sizeof(int);
+        }
+        if (!shared || mine[c].flags != shared->flags) {
+            bytes += mine[c].flags->alive.capacity();
+        }
+        if (!shared || mine[c].identity != shared->identity) {
+            const Identity& identity = *mine[c].identity;
+            bytes += identity.types.capacity() * sizeof(NpcType) + identity.names.capacity()
+                   + identity.nameStart.capacity() * sizeof(uint32_t);
+        }
+    }
+    return bytes;
+}
\ No newline at end of file
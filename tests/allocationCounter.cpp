@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocationCounter.h"
+
+namespace {
+
+std::atomic<bool> countAllocations{false};
+std::atomic<size_t> allocationCount{0};
+
+void countAllocation() {
+    if (countAllocations.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}
+
+void* operator new(std::size_t size) {
+    countAllocation();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// через выровненный вариант выделяет std::pmr::new_delete_resource
+void* operator new(std::size_t size, std::align_val_t align) {
+    countAllocation();
+    size_t alignment = static_cast<size_t>(align);
+    size_t rounded = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void* p = std::aligned_alloc(alignment, rounded)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+AllocationCounter::AllocationCounter() {
+    allocationCount = 0;
+    countAllocations = true;
+}
+
+AllocationCounter::~AllocationCounter() {
+    countAllocations = false;
+}
+
+size_t AllocationCounter::stop() {
+    countAllocations = false;
+    return allocationCount;
+}
\ No newline at end of file
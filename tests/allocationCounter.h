@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <streambuf>
+#include <string_view>
+
+// Тестовый помощник: operator new заменен во всем тестовом бинарнике
+// (allocationCounter.cpp), выделения считаются, пока жив AllocationCounter,
+// включая потоки пула
+class AllocationCounter {
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+    // выделения от конструктора до этого вызова
+    size_t stop();
+};
+
+// пишет в массив фиксированного размера, сам ничего не выделяет
+struct FixedBuffer : std::streambuf {
+    char data[4096];
+    FixedBuffer() { setp(data, data + sizeof(data)); }
+    std::string_view text() const { return std::string_view(data, pptr() - pbase()); }
+};
\ No newline at end of file
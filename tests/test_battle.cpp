@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "battle.h"
+#include "threadPool.h"
+
+class BattleTest : public ::testing::Test {
+protected:
+    static NpcWorld randomWorld(size_t count, unsigned seed) {
+        NpcWorld world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            world.add(type, "npc_" + std::to_string(i), x, y);
+        }
+        return world;
+    }
+
+    class Recorder : public IFFightObserver {
+    public:
+        std::vector<std::string> events;
+        void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override {
+            events.push_back(std::string(attacker->getName()) + ">" + std::string(defender->getName()) + (success ? "+" : "-"));
+        }
+    };
+};
+
+TEST_F(BattleTest, ThreadPoolRunsEveryChunkOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.run(hits.size(), [&](size_t chunk, size_t worker) {
+        EXPECT_LT(worker, pool.size());
+        hits[chunk]++;
+    });
+    for (auto& h : hits) EXPECT_EQ(h.load(), 1);
+
+    // пул переиспользуется
+    std::atomic<size_t> total{0};
+    pool.run(10, [&](size_t chunk, size_t) { total += chunk; });
+    EXPECT_EQ(total.load(), 45u);
+}
+
+TEST_F(BattleTest, ThreadPoolStealsFromBlockedWorker) {
+    // кусок 0 ждет все остальные: его доля выполнится, только если ее украдут
+    ThreadPool pool(4);
+    const size_t chunks = 64;
+    std::atomic<size_t> finished{0};
+    std::atomic<bool> stalled{false};
+    pool.run(chunks, [&](size_t chunk, size_t) {
+        if (chunk == 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (finished.load() < chunks - 1) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    stalled = true;
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        finished++;
+    });
+    EXPECT_FALSE(stalled.load());
+    EXPECT_EQ(finished.load(), chunks);
+}
+
+TEST_F(BattleTest, SequentialModeMatchesFight) {
+    NpcWorld a = randomWorld(800, 1);
+    NpcWorld b = randomWorld(800, 1);
+    Battle battle(BattleOptions{BattleMode::Sequential});
+    EXPECT_EQ(battle.round(a, 35), fight(b, 35));
+}
+
+TEST_F(BattleTest, ParallelIsDeterministicAcrossThreadCounts) {
+    std::vector<size_t> reference;
+    std::vector<std::string> referenceEvents;
+    for (size_t threads : {1u, 2u, 4u, 7u}) {
+        for (size_t chunk : {1u, 64u, 1024u}) {
+            NpcWorld world = randomWorld(1500, 2);
+            auto recorder = std::make_shared<Recorder>();
+            Battle battle(BattleOptions{BattleMode::Parallel, threads, chunk});
+            auto killed = battle.round(world, 20, recorder);
+            if (reference.empty()) {
+                reference = killed;
+                referenceEvents = recorder->events;
+                ASSERT_FALSE(reference.empty());
+            }
+            EXPECT_EQ(killed, reference) << threads << " threads, chunk " << chunk;
+            EXPECT_EQ(recorder->events, referenceEvents) << threads << " threads, chunk " << chunk;
+        }
+    }
+}
+
+TEST_F(BattleTest, ParallelStrikesAreSimultaneous) {
+    // две жабы рядом: по очереди выживает первая, одновременно гибнут обе
+    NpcWorld sequential, parallel;
+    for (NpcWorld* world : {&sequential, &parallel}) {
+        world->add(NpcType::Toad, "A", 10, 10);
+        world->add(NpcType::Toad, "B", 12, 10);
+    }
+    EXPECT_EQ(fight(sequential, 5).size(), 1u);
+    EXPECT_TRUE(sequential.isAlive(0));
+
+    Battle battle(BattleOptions{BattleMode::Parallel, 2});
+    auto killed = battle.round(parallel, 5);
+    EXPECT_EQ(killed, (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(parallel.aliveCount(), 0u);
+}
+
+TEST_F(BattleTest, KillCreditedToLowestAttacker) {
+    NpcWorld world;
+    world.add(NpcType::Dragon, "D1", 0, 0);
+    world.add(NpcType::Dragon, "D2", 2, 0);
+    world.add(NpcType::Knight, "K", 1, 0);  // бьет обоих драконов, оба бьют его
+    auto recorder = std::make_shared<Recorder>();
+    Battle battle(BattleOptions{BattleMode::Parallel, 3, 1});
+    battle.round(world, 3, recorder);
+
+    EXPECT_EQ(world.aliveCount(), 0u);
+    EXPECT_NE(std::find(recorder->events.begin(), recorder->events.end(), "D1>K+"), recorder->events.end());
+    EXPECT_EQ(std::find(recorder->events.begin(), recorder->events.end(), "D2>K+"), recorder->events.end());
+}
+
+TEST_F(BattleTest, KillSetIsSupersetOfSequential) {
+    // одновременные удары убивают не меньше, чем последовательные
+    NpcWorld a = randomWorld(1000, 3);
+    NpcWorld b = randomWorld(1000, 3);
+    auto sequential = fight(a, 20);
+    Battle battle;
+    auto parallel = battle.round(b, 20);
+    std::sort(sequential.begin(), sequential.end());
+    std::sort(parallel.begin(), parallel.end());
+    EXPECT_TRUE(std::includes(parallel.begin(), parallel.end(), sequential.begin(), sequential.end()));
+}
+
+
+TEST_F(BattleTest, ObserverExceptionLeavesRound) {
+    // событий больше емкости очереди: писатели не должны встать после исключения
+    class Throwing : public IFFightObserver {
+    public:
+        size_t calls = 0;
+        void onFight(const std::shared_ptr<NPC>&, const std::shared_ptr<NPC>&, bool) override {
+            if (++calls == 100) throw std::runtime_error("observer failed");
+        }
+    };
+    NpcWorld world = randomWorld(3000, 5);
+    auto observer = std::make_shared<Throwing>();
+    Battle battle(BattleOptions{BattleMode::Parallel, 4, 64});
+    EXPECT_THROW(battle.round(world, 40, observer), std::runtime_error);
+    EXPECT_EQ(observer->calls, 100u);
+
+    // пул и очередь после сбоя годны для следующего раунда
+    NpcWorld again = randomWorld(3000, 5);
+    NpcWorld reference = randomWorld(3000, 5);
+    auto recorder = std::make_shared<Recorder>();
+    EXPECT_EQ(battle.round(again, 20, recorder), Battle(BattleOptions{BattleMode::Parallel, 1}).round(reference, 20));
+}
\ No newline at end of file
@@ -319,4 +319,48 @@ TEST_F(FactoryTest, MixedValidAndInvalidFileContent) {
         EXPECT_EQ(loaded_npcs[3]->getType(), "Knight");
         EXPECT_EQ(loaded_npcs[3]->getName(), "ValidKnight1");
     }
-}
\ No newline at end of file
+}
+
+TEST_F(FactoryTest, StringViewParseMatchesStreamParse) {
+    const std::vector<std::string> lines = {
+        "Toad Toad1 10 20",
+        "  Dragon\tD  30   40  ",
+        "Knight K 5 6 extra tokens",
+        "Knight K +5 -0",
+        "Knight K 5 6\r",
+        "Toad T 10x 20",
+        "Toad T 10 20xyz",
+        "Toad T 0x10 5",
+        "Toad T + 5 6",
+        "Toad T +-5 6",
+        "Toad T - 6",
+        "Toad T 99999999999 6",
+        "Toad T 2147483647 -2147483648",
+        "Toad T 5",
+        "Toad OnlyName",
+        "InvalidType Name 10 20",
+        "toad lower 1 2",
+        "",
+        "   ",
+        "Toad\vT\f1\t2",
+    };
+
+    for (const auto& line : lines) {
+        std::istringstream stream(line);
+        NpcType streamType = NpcType::Toad, viewType = NpcType::Toad;
+        std::string streamName;
+        std::string_view viewName;
+        int sx = 0, sy = 0, vx = 0, vy = 0;
+
+        bool fromStream = NPCFactory::parse(stream, streamType, streamName, sx, sy);
+        bool fromView = NPCFactory::parse(std::string_view(line), viewType, viewName, vx, vy);
+
+        ASSERT_EQ(fromView, fromStream) << "line: '" << line << "'";
+        if (fromStream) {
+            EXPECT_EQ(viewType, streamType) << line;
+            EXPECT_EQ(viewName, streamName) << line;
+            EXPECT_EQ(vx, sx) << line;
+            EXPECT_EQ(vy, sy) << line;
+        }
+    }
+}
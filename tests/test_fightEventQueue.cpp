@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "fightEventQueue.h"
+#include "threadPool.h"
+
+namespace {
+
+FightEvent makeEvent(uint32_t stream, uint32_t position, uint32_t attacker) {
+    return {(uint64_t{stream} << 32) | position, attacker, attacker + 1, attacker % 2 == 0, false};
+}
+
+FightEvent endOf(uint32_t stream, uint32_t position) {
+    return {(uint64_t{stream} << 32) | position, 0, 0, false, true};
+}
+
+}  // namespace
+
+TEST(FightEventQueueTest, FifoAndCapacity) {
+    FightEventQueue queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+
+    FightEvent event;
+    EXPECT_FALSE(queue.tryPop(event));
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.tryPush(makeEvent(0, i, i)));
+    }
+    EXPECT_FALSE(queue.tryPush(makeEvent(0, 8, 8)));
+
+    // по кругу несколько раз
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_TRUE(queue.tryPop(event));
+        EXPECT_EQ(event.attacker, i);
+        EXPECT_EQ(event.position(), i);
+        EXPECT_TRUE(queue.tryPush(makeEvent(0, i + 8, i + 8)));
+    }
+}
+
+TEST(FightEventQueueTest, ManyProducersKeepTheirOrder) {
+    const uint32_t producers = 4;
+    const uint32_t perProducer = 20000;
+    FightEventQueue queue(256);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            FightEventStream stream(queue, p);
+            for (uint32_t i = 0; i < perProducer; ++i) stream.publish(i, p, true);
+            stream.close();
+        });
+    }
+
+    std::vector<uint32_t> next(producers, 0);
+    uint32_t closed = 0;
+    FightEvent event;
+    while (closed < producers) {
+        if (!queue.tryPop(event)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint32_t p = event.stream();
+        ASSERT_LT(p, producers);
+        if (event.endOfStream) {
+            EXPECT_EQ(event.position(), perProducer);
+            ++closed;
+            continue;
+        }
+        ASSERT_EQ(event.position(), next[p]);
+        ASSERT_EQ(event.attacker, next[p]);
+        ASSERT_EQ(event.defender, p);
+        ++next[p];
+    }
+    for (auto& thread : threads) thread.join();
+    for (uint32_t p = 0; p < producers; ++p) EXPECT_EQ(next[p], perProducer);
+    EXPECT_FALSE(queue.tryPop(event));
+}
+
+TEST(FightEventQueueTest, SequencerOrdersStreams) {
+    FightEventSequencer sequencer;
+    sequencer.reset(3);
+    std::vector<uint32_t> delivered;
+    auto collect = [&](const FightEvent& event) { delivered.push_back(event.attacker); };
+
+    // поток 2 целиком, потом 1 без конца, потом 0
+    sequencer.accept(makeEvent(2, 0, 20), collect);
+    sequencer.accept(endOf(2, 1), collect);
+    sequencer.accept(makeEvent(1, 0, 10), collect);
+    sequencer.accept(makeEvent(1, 1, 11), collect);
+    EXPECT_TRUE(delivered.empty());
+
+    sequencer.accept(makeEvent(0, 0, 0), collect);
+    EXPECT_EQ(delivered, std::vector<uint32_t>({0}));
+    sequencer.accept(endOf(0, 1), collect);
+    EXPECT_EQ(delivered, std::vector<uint32_t>({0, 10, 11}));
+    EXPECT_FALSE(sequencer.finished());
+
+    sequencer.accept(makeEvent(1, 2, 12), collect);
+    sequencer.accept(endOf(1, 3), collect);
+    EXPECT_EQ(delivered, std::vector<uint32_t>({0, 10, 11, 12, 20}));
+    EXPECT_TRUE(sequencer.finished());
+
+    // буферы переиспользуются
+    sequencer.reset(1);
+    EXPECT_FALSE(sequencer.finished());
+    sequencer.accept(endOf(0, 0), collect);
+    EXPECT_TRUE(sequencer.finished());
+}
+
+TEST(FightEventQueueTest, DeliveryDoesNotDependOnThreads) {
+    const uint32_t streams = 64;
+    auto run = [&](size_t threads) {
+        ThreadPool pool(threads);
+        FightEventQueue queue(128);
+        FightEventSequencer sequencer;
+        sequencer.reset(streams);
+        std::vector<uint64_t> delivered;
+
+        std::thread reader([&] {
+            sequencer.drain(queue, [&](const FightEvent& event) { delivered.push_back(event.sequence); });
+        });
+        pool.run(streams, [&](size_t chunk, size_t) {
+            FightEventStream stream(queue, static_cast<uint32_t>(chunk));
+            // разное число событий в потоках
+            for (uint32_t i = 0; i < (chunk * 37) % 200; ++i) stream.publish(i, 0, false);
+            stream.close();
+        });
+        reader.join();
+        return delivered;
+    };
+
+    std::vector<uint64_t> single = run(1);
+    EXPECT_EQ(run(4), single);
+    for (size_t i = 1; i < single.size(); ++i) {
+        ASSERT_LT(single[i - 1], single[i]);
+    }
+}
\ No newline at end of file
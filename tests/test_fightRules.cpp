@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "fightRules.h"
+#include "fightVisitor.h"
+#include "npcWorld.h"
+#include "toad.h"
+#include "dragon.h"
+#include "knight.h"
+
+class FightRulesTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        old_cout = std::cout.rdbuf(sink.rdbuf());
+    }
+
+    void TearDown() override {
+        FightRules::install(defaultFightRules);
+        std::cout.rdbuf(old_cout);
+    }
+
+    static std::shared_ptr<NPC> make(NpcType type) {
+        return NPCFactory::create(type, "npc", 0, 0);
+    }
+
+    std::ostringstream sink;
+    std::streambuf* old_cout = nullptr;
+};
+
+// исходные правила из Toad/Dragon/Knight::fight до перехода на таблицу,
+// строка - нападающий, столбец - защитник, порядок NpcType
+TEST_F(FightRulesTest, DefaultTableMatchesBaseline) {
+    constexpr FightOutcome W = FightOutcome::Win, L = FightOutcome::Lose, D = FightOutcome::Draw;
+    const FightOutcome baseline[NPC_TYPE_COUNT][NPC_TYPE_COUNT] = {
+        {W, W, W},  // Toad
+        {L, D, W},  // Dragon
+        {L, W, D},  // Knight
+    };
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a) {
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d) {
+            NpcType attackerType = static_cast<NpcType>(a);
+            NpcType defenderType = static_cast<NpcType>(d);
+            const FightOutcome expected = baseline[a][d];
+            EXPECT_EQ(defaultFightRules.resolve(attackerType, defenderType), expected)
+                << npcTypeName(attackerType) << " vs " << npcTypeName(defenderType);
+
+            // визитор и duel идут через ту же таблицу и должны дать тот же исход
+            auto attacker = make(attackerType);
+            auto defender = make(defenderType);
+            auto visitor = std::make_shared<FightVisitor>(attacker);
+            EXPECT_EQ(defender->accept(visitor), expected == W);
+            EXPECT_EQ(attacker->duel(*defender), expected == W);
+        }
+    }
+}
+
+TEST_F(FightRulesTest, DrawAndLoseAreDistinct) {
+    EXPECT_EQ(defaultFightRules.resolve(NpcType::Dragon, NpcType::Dragon), FightOutcome::Draw);
+    EXPECT_EQ(defaultFightRules.resolve(NpcType::Dragon, NpcType::Toad), FightOutcome::Lose);
+    EXPECT_EQ(defaultFightRules.resolve(NpcType::Knight, NpcType::Dragon), FightOutcome::Win);
+}
+
+TEST_F(FightRulesTest, LoadFromStream) {
+    std::istringstream input(
+        "# рыцари сильнее всех\n"
+        "Knight Toad win\n"
+        "Knight Dragon win   # и драконов\n"
+        "\n"
+        "Toad Knight lose\n");
+    FightRules rules = FightRules::load(input);
+
+    EXPECT_TRUE(rules.kills(NpcType::Knight, NpcType::Toad));
+    EXPECT_TRUE(rules.kills(NpcType::Knight, NpcType::Dragon));
+    EXPECT_EQ(rules.resolve(NpcType::Toad, NpcType::Knight), FightOutcome::Lose);
+    // не указано - ничья
+    EXPECT_EQ(rules.resolve(NpcType::Toad, NpcType::Toad), FightOutcome::Draw);
+}
+
+TEST_F(FightRulesTest, SaveLoadRoundTrip) {
+    std::stringstream buffer;
+    defaultFightRules.save(buffer);
+    FightRules loaded = FightRules::load(buffer);
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a) {
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d) {
+            EXPECT_EQ(loaded.resolve(static_cast<NpcType>(a), static_cast<NpcType>(d)),
+                      defaultFightRules.resolve(static_cast<NpcType>(a), static_cast<NpcType>(d)));
+        }
+    }
+}
+
+TEST_F(FightRulesTest, BadRulesThrow) {
+    std::istringstream unknownType("Elf Toad win\n");
+    std::istringstream badOutcome("Toad Toad maybe\n");
+    std::istringstream missing("Toad Dragon\n");
+    std::istringstream extra("Toad Dragon win now\n");
+
+    EXPECT_THROW(FightRules::load(unknownType), std::runtime_error);
+    EXPECT_THROW(FightRules::load(badOutcome), std::runtime_error);
+    EXPECT_THROW(FightRules::load(missing), std::runtime_error);
+    EXPECT_THROW(FightRules::load(extra), std::runtime_error);
+    EXPECT_THROW(FightRules::loadFile("no_such_rules_file.txt"), std::runtime_error);
+}
+
+TEST_F(FightRulesTest, InstalledRulesDriveFight) {
+    // все ничьи - никто не гибнет
+    FightRules::install(FightRules());
+    NpcWorld world;
+    world.add(NpcType::Toad, "T", 0, 0);
+    world.add(NpcType::Knight, "K", 1, 1);
+    EXPECT_TRUE(fight(world, 10).empty());
+
+    FightRules::install(FightRules().set(NpcType::Knight, NpcType::Toad, FightOutcome::Win));
+    auto killed = fight(world, 10);
+    ASSERT_EQ(killed.size(), 1u);
+    EXPECT_EQ(world.getName(killed[0]), "T");
+}
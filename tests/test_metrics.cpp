@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "battle.h"
+#include "metrics.h"
+#include "world.h"
+
+class MetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!Metrics::enabled) GTEST_SKIP() << "metrics are compiled out";
+        Metrics::reset();
+    }
+
+    void TearDown() override {
+        Metrics::reset();
+    }
+
+    class CountingObserver : public IFFightObserver {
+    public:
+        size_t events = 0;
+        void onFight(const std::shared_ptr<NPC>&, const std::shared_ptr<NPC>&, bool) override { ++events; }
+    };
+
+    static NpcWorld lineWorld() {
+        NpcWorld world;
+        world.add(NpcType::Toad, "T", 0, 0);
+        world.add(NpcType::Dragon, "D", 5, 0);
+        world.add(NpcType::Knight, "K", 10, 0);
+        world.add(NpcType::Dragon, "Far", 400, 400);
+        return world;
+    }
+};
+
+TEST_F(MetricsTest, HistogramBuckets) {
+    EXPECT_EQ(LatencyHistogram::bucketOf(0), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(1), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(2), 1u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(1023), 9u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(1024), 10u);
+
+    for (uint64_t ns : {100u, 100u, 100u, 5000u}) {
+        Metrics::record(MetricHistogram::ObserverCall, ns);
+    }
+    const MetricsSnapshot snapshot = Metrics::snapshot();
+    const LatencyHistogram& h = snapshot.histogram(MetricHistogram::ObserverCall);
+    EXPECT_EQ(h.count, 4u);
+    EXPECT_EQ(h.totalNs, 5300u);
+    EXPECT_EQ(h.maxNs, 5000u);
+    EXPECT_EQ(h.percentileNs(0.5), 127u);
+    EXPECT_EQ(h.percentileNs(1.0), 5000u);
+}
+
+TEST_F(MetricsTest, SequentialRoundCounts) {
+    NpcWorld world = lineWorld();
+    auto observer = std::make_shared<CountingObserver>();
+    std::vector<size_t> killed = fight(world, 10, observer);
+
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::Rounds), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::Kills), killed.size());
+    EXPECT_EQ(snapshot.fightCount(), observer->events);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::ObserverCall).count, observer->events);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::Round).count, 1u);
+    EXPECT_GE(snapshot.counter(MetricCounter::PairsInRange), snapshot.fightCount());
+    EXPECT_GE(snapshot.counter(MetricCounter::PairsExamined), snapshot.counter(MetricCounter::PairsInRange));
+    // жаба нападает первой и съедает обоих соседей
+    EXPECT_EQ(snapshot.fights[static_cast<size_t>(NpcType::Toad)][static_cast<size_t>(NpcType::Dragon)], 1u);
+    EXPECT_EQ(snapshot.fights[static_cast<size_t>(NpcType::Toad)][static_cast<size_t>(NpcType::Knight)], 1u);
+}
+
+TEST_F(MetricsTest, SetFightCountsDuels) {
+    set_t npcs;
+    npcs.insert(createNPC(NpcType::Knight, "K", 0, 0));
+    npcs.insert(createNPC(NpcType::Dragon, "D", 3, 4));
+    set_t killed = fight(npcs, 5);
+
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::Kills), killed.size());
+    EXPECT_GE(snapshot.fightCount(), 1u);
+}
+
+TEST_F(MetricsTest, ParallelThreadsAreSummed) {
+    NpcWorld world;
+    for (int i = 0; i < 2000; ++i) {
+        world.add(static_cast<NpcType>(i % 3), "n" + std::to_string(i), (i * 37) % 501, (i * 91) % 501);
+    }
+    auto observer = std::make_shared<CountingObserver>();
+    Battle battle(BattleOptions{BattleMode::Parallel, 4, 64});
+    std::vector<size_t> killed = battle.round(world, 15, observer);
+
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::Kills), killed.size());
+    // каждая предложенная пара записана потоком, который ее нашел
+    EXPECT_GE(snapshot.fightCount(), observer->events);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::ObserverCall).count, observer->events);
+    EXPECT_EQ(snapshot.counter(MetricCounter::Rounds), 1u);
+}
+
+// пары считаются до пропуска обреченных - одинаково при любом числе потоков
+TEST_F(MetricsTest, ParallelFightCountIgnoresThreads) {
+    std::array<std::array<uint64_t, NPC_TYPE_COUNT>, NPC_TYPE_COUNT> expected{};
+    for (size_t threads : {1u, 4u}) {
+        NpcWorld world;
+        for (int i = 0; i < 2000; ++i) {
+            world.add(static_cast<NpcType>(i % 3), "n" + std::to_string(i), (i * 37) % 501, (i * 91) % 501);
+        }
+        Metrics::reset();
+        // без наблюдателя и с ним - оба пути Parallel
+        Battle battle(BattleOptions{BattleMode::Parallel, threads, 64});
+        NpcWorld quiet = world;
+        battle.round(quiet, 15);
+        battle.round(world, 15, std::make_shared<CountingObserver>());
+        const MetricsSnapshot snapshot = Metrics::snapshot();
+        if (threads == 1) expected = snapshot.fights;
+        EXPECT_EQ(snapshot.fights, expected) << threads;
+    }
+}
+
+TEST_F(MetricsTest, ResetAndSummary) {
+    NpcWorld world = lineWorld();
+    fight(world, 10);
+    EXPECT_GT(Metrics::snapshot().fightCount(), 0u);
+
+    std::ostringstream summary;
+    summary << Metrics::snapshot();
+    EXPECT_NE(summary.str().find("Pairs examined"), std::string::npos);
+    EXPECT_NE(summary.str().find("Toad -> Dragon: 1"), std::string::npos);
+
+    Metrics::reset();
+    MetricsSnapshot empty = Metrics::snapshot();
+    EXPECT_EQ(empty.fightCount(), 0u);
+    EXPECT_EQ(empty.counter(MetricCounter::Rounds), 0u);
+}
\ No newline at end of file
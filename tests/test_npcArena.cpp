@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "allocationCounter.h"
+#include "battle.h"
+#include "factory.h"
+#include "npcArena.h"
+#include "npcRegistry.h"
+#include "world.h"
+
+class NpcArenaTest : public ::testing::Test {
+protected:
+    static NpcWorld randomWorld(size_t count, unsigned seed) {
+        NpcWorld world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            world.add(type, "npc_" + std::to_string(i), x, y);
+        }
+        return world;
+    }
+};
+
+TEST_F(NpcArenaTest, CreatesWorkingNpcs) {
+    NpcArena arena;
+    auto toad = NPCFactory::create(NpcType::Toad, "T", 1, 2, arena);
+    auto dragon = NPCFactory::create(NpcType::Dragon, "D", 3, 4, arena);
+    auto knight = NPCFactory::create(NpcType::Knight, "K", 5, 6, arena);
+
+    ASSERT_TRUE(toad && dragon && knight);
+    EXPECT_EQ(toad->getType(), "Toad");
+    EXPECT_EQ(dragon->getName(), "D");
+    EXPECT_EQ(knight->getX(), 5);
+    EXPECT_TRUE(toad->duel(*dragon));
+    EXPECT_TRUE(knight->duel(*dragon));
+    EXPECT_EQ(arena.size(), 3u);
+}
+
+TEST_F(NpcArenaTest, NpcsShareFewBlocks) {
+    NpcArena arena(4096);
+    std::vector<std::shared_ptr<NPC>> npcs;
+    npcs.reserve(10000);
+
+    AllocationCounter counter;
+    for (int i = 0; i < 10000; ++i) {
+        // имена повторяются - в пуле их всего тысяча
+        npcs.push_back(NPCFactory::create(static_cast<NpcType>(i % 3), "n" + std::to_string(i % 1000), i % 501, 0, arena));
+    }
+    size_t allocations = counter.stop();
+
+    // блоки растут геометрически: десятки выделений на 10000 объектов, а не 10000
+    EXPECT_GT(allocations, 0u);
+    EXPECT_LT(allocations, 32u);
+    EXPECT_EQ(npcs[9999]->getName(), "n999");
+}
+
+TEST_F(NpcArenaTest, BattleRoundDoesNotAllocate) {
+    for (BattleMode mode : {BattleMode::Sequential, BattleMode::Parallel}) {
+        NpcWorld world = randomWorld(3000, 5);
+        NpcWorld warmup = world;
+
+        Battle battle(BattleOptions{mode, 3, 256});
+        std::vector<size_t> killed;
+        killed.reserve(world.size());
+        // первый раунд заводит буферы сетки и отметок
+        battle.round(warmup, 25, killed);
+
+        AllocationCounter counter;
+        battle.round(world, 25, killed);
+        size_t allocations = counter.stop();
+
+        EXPECT_EQ(allocations, 0u) << (mode == BattleMode::Sequential ? "sequential" : "parallel");
+        EXPECT_FALSE(killed.empty());
+        EXPECT_EQ(world.aliveCount(), world.size() - killed.size());
+    }
+}
+
+TEST_F(NpcArenaTest, ArenaFightDoesNotAllocatePerPair) {
+    NpcArena arena;
+    set_t npcs;
+    NpcRegistry registry;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> rnd_type(0, 2);
+    std::uniform_int_distribution<> rnd_coord(0, 500);
+    for (int i = 0; i < 3000; ++i) {
+        NpcType type = static_cast<NpcType>(rnd_type(gen));
+        int x = rnd_coord(gen);
+        int y = rnd_coord(gen);
+        npcs.insert(NPCFactory::create(type, "npc_" + std::to_string(i), x, y, arena));
+        registry.create(type, "npc_" + std::to_string(i), x, y, &arena);
+    }
+
+    // буферы раунда (снимок координат, сетка, кандидаты, убитые) растут
+    // геометрически - десятки выделений; на пару дуэлей в арене ни одного,
+    // у set_t еще по узлу множества на убитого
+    AllocationCounter setCounter;
+    set_t killed = fight(npcs, 25);
+    size_t setAllocations = setCounter.stop();
+
+    ASSERT_FALSE(killed.empty());
+    EXPECT_LT(setAllocations, killed.size() + 64);
+
+    AllocationCounter registryCounter;
+    std::vector<NpcHandle> dead = fight(registry, 25);
+    size_t registryAllocations = registryCounter.stop();
+
+    ASSERT_FALSE(dead.empty());
+    EXPECT_LT(registryAllocations, 64u);
+}
\ No newline at end of file
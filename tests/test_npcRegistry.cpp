@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "npcRegistry.h"
+#include "npcWorld.h"
+
+class NpcRegistryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        old_cout = std::cout.rdbuf(sink.rdbuf());
+    }
+
+    void TearDown() override {
+        std::cout.rdbuf(old_cout);
+        std::remove("test_registry.txt");
+    }
+
+    static void fillRandom(NpcRegistry& registry, size_t count, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            registry.create(type, "npc_" + std::to_string(i), x, y);
+        }
+    }
+
+    static std::vector<std::string> names(const NpcRegistry& registry) {
+        std::vector<std::string> result;
+        for (size_t i = 0; i < registry.size(); ++i) result.emplace_back(registry.at(i)->getName());
+        return result;
+    }
+
+    std::ostringstream sink;
+    std::streambuf* old_cout = nullptr;
+};
+
+TEST_F(NpcRegistryTest, InsertLookupRemove) {
+    NpcRegistry registry;
+    NpcHandle toad = registry.create(NpcType::Toad, "T", 1, 1);
+    NpcHandle dragon = registry.create(NpcType::Dragon, "D", 2, 2);
+    NpcHandle knight = registry.create(NpcType::Knight, "K", 3, 3);
+
+    ASSERT_EQ(registry.size(), 3u);
+    EXPECT_EQ(registry.get(dragon)->getName(), "D");
+    EXPECT_TRUE(registry.contains(toad));
+
+    EXPECT_TRUE(registry.remove(toad));
+    EXPECT_FALSE(registry.remove(toad));
+    EXPECT_FALSE(registry.contains(toad));
+    EXPECT_EQ(registry.get(toad), nullptr);
+    EXPECT_EQ(registry.share(toad), nullptr);
+    // остальные ссылки не сдвинулись
+    EXPECT_EQ(registry.get(knight)->getName(), "K");
+    EXPECT_EQ(registry.get(dragon)->getName(), "D");
+    EXPECT_EQ(registry.size(), 2u);
+
+    EXPECT_FALSE(registry.insert(nullptr).valid());
+    EXPECT_FALSE(registry.contains(NpcHandle()));
+}
+
+TEST_F(NpcRegistryTest, SlotReuseBumpsGeneration) {
+    NpcRegistry registry;
+    NpcHandle first = registry.create(NpcType::Toad, "Old", 1, 1);
+    registry.remove(first);
+    NpcHandle second = registry.create(NpcType::Knight, "New", 2, 2);
+
+    EXPECT_EQ(second.index, first.index);
+    EXPECT_NE(second.generation, first.generation);
+    EXPECT_EQ(registry.get(first), nullptr);
+    EXPECT_EQ(registry.get(second)->getName(), "New");
+}
+
+TEST_F(NpcRegistryTest, HandleAtRoundTrips) {
+    NpcRegistry registry;
+    fillRandom(registry, 100, 3);
+    for (size_t i = 0; i < 100; i += 3) registry.remove(registry.handleAt(i % registry.size()));
+    for (size_t i = 0; i < registry.size(); ++i) {
+        EXPECT_EQ(registry.get(registry.handleAt(i)), registry.at(i).get());
+    }
+}
+
+TEST_F(NpcRegistryTest, DeterministicOrder) {
+    NpcRegistry a, b;
+    fillRandom(a, 200, 9);
+    fillRandom(b, 200, 9);
+    for (NpcRegistry* r : {&a, &b}) {
+        for (size_t i = 0; i < 50; ++i) r->remove(r->handleAt((i * 37) % r->size()));
+        r->create(NpcType::Toad, "late", 5, 5);
+    }
+    EXPECT_EQ(names(a), names(b));
+}
+
+TEST_F(NpcRegistryTest, FightMatchesNpcWorld) {
+    NpcRegistry registry;
+    fillRandom(registry, 2000, 4);
+    NpcWorld world = NpcWorld::fromRegistry(registry);
+
+    std::vector<NpcHandle> dead = fight(registry, 20);
+    std::vector<size_t> killed = fight(world, 20);
+
+    std::vector<std::string> registryNames, worldNames;
+    for (NpcHandle h : dead) {
+        ASSERT_TRUE(registry.contains(h));
+        EXPECT_FALSE(registry.get(h)->isAlive());
+        registryNames.emplace_back(registry.get(h)->getName());
+    }
+    for (size_t i : killed) worldNames.emplace_back(world.getName(i));
+    std::sort(registryNames.begin(), registryNames.end());
+    std::sort(worldNames.begin(), worldNames.end());
+    EXPECT_EQ(registryNames, worldNames);
+
+    std::vector<std::string> survivors;
+    for (size_t i = 0; i < registry.size(); ++i) {
+        if (registry.at(i)->isAlive()) survivors.emplace_back(registry.at(i)->getName());
+    }
+    EXPECT_EQ(registry.removeDead(), dead.size());
+    EXPECT_EQ(registry.size(), world.aliveCount());
+    EXPECT_EQ(names(registry), survivors);
+    for (NpcHandle h : dead) EXPECT_FALSE(registry.contains(h));
+    for (size_t i = 0; i < registry.size(); ++i) {
+        EXPECT_EQ(registry.get(registry.handleAt(i)), registry.at(i).get());
+    }
+}
+
+TEST_F(NpcRegistryTest, ObserverSeesHandles) {
+    class Recorder : public IRegistryFightObserver {
+    public:
+        std::vector<std::string> events;
+        void onFight(const NpcRegistry& registry, NpcHandle attacker, NpcHandle defender, bool success) override {
+            events.push_back(std::string(registry.get(attacker)->getName()) + ">" + std::string(registry.get(defender)->getName()) + (success ? "+" : "-"));
+        }
+    };
+    class ObjectRecorder : public IFFightObserver {
+    public:
+        size_t events = 0;
+        void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool) override {
+            if (attacker && defender) ++events;
+        }
+    };
+
+    NpcRegistry registry;
+    registry.create(NpcType::Knight, "K", 0, 0);
+    registry.create(NpcType::Dragon, "D", 3, 4);
+    auto recorder = std::make_shared<Recorder>();
+    fight(registry, 5, recorder);
+    EXPECT_EQ(recorder->events, (std::vector<std::string>{"K>D+"}));
+
+    NpcRegistry other;
+    other.create(NpcType::Toad, "T", 0, 0);
+    other.create(NpcType::Knight, "K", 1, 1);
+    auto objects = std::make_shared<ObjectRecorder>();
+    fight(other, 5, std::make_shared<RegistryObserverAdapter>(objects));
+    EXPECT_EQ(objects->events, 1u);
+}
+
+TEST_F(NpcRegistryTest, SaveLoadKeepsOrder) {
+    NpcRegistry registry;
+    fillRandom(registry, 50, 8);
+    registry.remove(registry.handleAt(10));
+    saveNPC(registry, "test_registry.txt");
+
+    NpcRegistry loaded;
+    ASSERT_TRUE(loadNPC("test_registry.txt", loaded));
+    EXPECT_EQ(names(loaded), names(registry));
+    EXPECT_FALSE(loadNPC("no_such_registry.txt", loaded));
+}
\ No newline at end of file
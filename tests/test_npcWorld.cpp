@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "npcWorld.h"
+#include "world.h"
+
+class NpcWorldTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        old_cout = std::cout.rdbuf(sink.rdbuf());
+    }
+
+    void TearDown() override {
+        std::cout.rdbuf(old_cout);
+        std::remove("test_npc_world.txt");
+    }
+
+    static set_t randomSet(size_t count, unsigned seed) {
+        set_t world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            world.insert(createNPC(type, generateName(npcTypeName(type), static_cast<int>(i)), x, y));
+        }
+        return world;
+    }
+
+    std::ostringstream sink;
+    std::streambuf* old_cout = nullptr;
+};
+
+TEST_F(NpcWorldTest, AddAndAccess) {
+    NpcWorld world;
+    size_t a = world.add(NpcType::Toad, "T1", 10, 20);
+    size_t b = world.add(NpcType::Knight, "K1", 30, 40);
+
+    EXPECT_EQ(world.size(), 2u);
+    EXPECT_EQ(world.getName(a), "T1");
+    EXPECT_EQ(world.getName(b), "K1");
+    EXPECT_EQ(world.getType(b), NpcType::Knight);
+    EXPECT_EQ(world.getX(b), 30);
+    EXPECT_EQ(world.getY(b), 40);
+    EXPECT_TRUE(world.isAlive(a));
+    world.kill(a);
+    EXPECT_FALSE(world.isAlive(a));
+    EXPECT_EQ(world.aliveCount(), 1u);
+}
+
+TEST_F(NpcWorldTest, InvalidCoordinates) {
+    NpcWorld world;
+    EXPECT_THROW(world.add(NpcType::Toad, "Bad", -1, 0), std::runtime_error);
+    EXPECT_THROW(world.add(NpcType::Toad, "Bad", 0, 501), std::runtime_error);
+    EXPECT_TRUE(world.empty());
+}
+
+TEST_F(NpcWorldTest, RemoveDeadKeepsOrder) {
+    NpcWorld world;
+    world.add(NpcType::Toad, "A", 1, 1);
+    world.add(NpcType::Dragon, "LongerName", 2, 2);
+    world.add(NpcType::Knight, "C", 3, 3);
+    world.add(NpcType::Toad, "D", 4, 4);
+    world.kill(0);
+    world.kill(2);
+    world.removeDead();
+
+    ASSERT_EQ(world.size(), 2u);
+    EXPECT_EQ(world.getName(0), "LongerName");
+    EXPECT_EQ(world.getName(1), "D");
+    EXPECT_EQ(world.getX(1), 4);
+    EXPECT_EQ(world.getType(0), NpcType::Dragon);
+}
+
+TEST_F(NpcWorldTest, FightMatchesSetFight) {
+    for (size_t range : {0u, 20u, 50u, 95u}) {
+        set_t npcs = randomSet(500, 3);
+        NpcWorld world = NpcWorld::fromSet(npcs);
+
+        std::vector<std::string> expected;
+        for (const auto& n : fight(npcs, range)) expected.emplace_back(n->getName());
+
+        std::vector<std::string> actual;
+        for (size_t i : fight(world, range)) actual.emplace_back(world.getName(i));
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, expected) << "range " << range;
+    }
+}
+
+TEST_F(NpcWorldTest, FightNotifiesObserver) {
+    class Recorder : public IFFightObserver {
+    public:
+        std::vector<std::string> kills;
+        int calls = 0;
+        void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override {
+            ++calls;
+            if (success) kills.push_back(std::string(attacker->getName()) + ">" + std::string(defender->getName()));
+        }
+    };
+
+    NpcWorld world;
+    world.add(NpcType::Dragon, "D", 0, 0);
+    world.add(NpcType::Knight, "K", 3, 4);
+    world.add(NpcType::Dragon, "Far", 400, 400);
+    auto recorder = std::make_shared<Recorder>();
+    auto killed = fight(world, 5, recorder);
+
+    ASSERT_EQ(killed.size(), 1u);
+    EXPECT_EQ(world.getName(killed[0]), "K");
+    EXPECT_EQ(recorder->calls, 1);
+    EXPECT_EQ(recorder->kills, std::vector<std::string>{"D>K"});
+}
+
+TEST_F(NpcWorldTest, SaveLoadRoundTrip) {
+    NpcWorld world;
+    world.add(NpcType::Toad, "Toad_1", 10, 20);
+    world.add(NpcType::Dragon, "Dragon_2", 300, 400);
+    world.add(NpcType::Knight, "Knight_3", 500, 0);
+    saveNPC(world, "test_npc_world.txt");
+
+    NpcWorld loaded;
+    ASSERT_TRUE(loadNPC("test_npc_world.txt", loaded));
+    ASSERT_EQ(loaded.size(), 3u);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(loaded.getName(i), world.getName(i));
+        EXPECT_EQ(loaded.getType(i), world.getType(i));
+        EXPECT_EQ(loaded.getX(i), world.getX(i));
+        EXPECT_EQ(loaded.getY(i), world.getY(i));
+    }
+
+    // тот же файл читается и в set_t
+    EXPECT_EQ(loadNPC("test_npc_world.txt").size(), 3u);
+}
+
+TEST_F(NpcWorldTest, PrintMatchesSetFormat) {
+    set_t npcs;
+    npcs.insert(createNPC(NpcType::Knight, "K", 5, 6));
+    NpcWorld world = NpcWorld::fromSet(npcs);
+
+    std::ostringstream fromSet, fromWorld;
+    fromSet << npcs;
+    fromWorld << world;
+    EXPECT_EQ(fromWorld.str(), fromSet.str());
+}
+
+TEST_F(NpcWorldTest, ToSetRoundTrip) {
+    set_t npcs = randomSet(50, 9);
+    NpcWorld world = NpcWorld::fromSet(npcs);
+    set_t back = world.toSet();
+    EXPECT_EQ(back.size(), npcs.size());
+    EXPECT_EQ(NpcWorld::fromSet(back).size(), world.size());
+}
@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
 #include <sstream>
 #include <fstream>
+#include <iterator>
 #include <memory>
 #include <cstdio>
+#include <string>
+#include <vector>
 
+#include "allocationCounter.h"
+#include "factory.h"
 #include "observer.h"
 #include "toad.h"
 #include "dragon.h"
@@ -21,6 +26,9 @@ protected:
         std::remove("test_log.txt");
         std::remove("test_log_append.txt");
         std::remove("test_log_empty.txt");
+        std::remove("test_async_log.txt");
+        std::remove("test_async_sync.txt");
+        std::remove("test_async_overflow.txt");
     }
     
     std::shared_ptr<NPC> attacker;
@@ -54,6 +62,22 @@ TEST_F(ObserverTest, TextObserverNoOutputFailedFight) {
     EXPECT_TRUE(buffer.str().empty());
 }
 
+TEST_F(ObserverTest, TextObserverHonorsStreamState) {
+    std::stringstream buffer;
+    std::streambuf* old_cout = std::cout.rdbuf(buffer.rdbuf());
+
+    // сломанный cout молчит и остается сломанным, как при operator<<
+    TextObserver observer;
+    std::cout.setstate(std::ios::badbit);
+    observer.onFight(attacker, defender, true);
+    bool stayedBad = std::cout.bad();
+    std::cout.clear();
+
+    std::cout.rdbuf(old_cout);
+    EXPECT_TRUE(stayedBad);
+    EXPECT_TRUE(buffer.str().empty());
+}
+
 TEST_F(ObserverTest, FileObserverCreatesAndWritesFile) {
     const std::string filename = "test_log.txt";
     
@@ -104,4 +128,165 @@ TEST_F(ObserverTest, FileObserverAppendsToExistingFile) {
     
     file.close();
     std::remove(filename.c_str());
+}
+
+static std::vector<std::string> readLines(const std::string& filename) {
+    std::ifstream file(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// так строку собирали раньше - цепочкой operator<<
+static std::string streamKillLine(const NPC& attacker, const NPC& defender) {
+    std::ostringstream os;
+    os << attacker.getType() << " " << attacker.getName() << " killed " << defender.getType() << " "
+       << defender.getName() << " at (" << defender.getX() << ", " << defender.getY() << ")\n";
+    return os.str();
+}
+
+TEST_F(ObserverTest, KillLineMatchesStreamFormatting) {
+    std::string line;
+    for (int value : {0, 7, 42, 500, -1, -250, 2147483647, -2147483647 - 1}) {
+        line.clear();
+        appendKillLine(line, "Knight", "K", "Toad", "", value, -value / 2);
+        std::ostringstream expected;
+        expected << "Knight" << " " << "K" << " killed " << "Toad" << " " << "" << " at (" << value << ", " << -value / 2 << ")\n";
+        EXPECT_EQ(line, expected.str());
+    }
+
+    std::stringstream buffer;
+    std::streambuf* old_cout = std::cout.rdbuf(buffer.rdbuf());
+    TextObserver observer;
+    observer.onFight(attacker, defender, true);
+    observer.onFight(defender, attacker, true);
+    std::cout.rdbuf(old_cout);
+
+    EXPECT_EQ(buffer.str(), streamKillLine(*attacker, *defender) + streamKillLine(*defender, *attacker));
+}
+
+TEST_F(ObserverTest, FileObserverWritesBatches) {
+    const std::string filename = "test_log.txt";
+    auto knight = std::make_shared<Knight>("KnightAttacker", 50, 60);
+    std::string expected;
+    {
+        FileObserver observer(filename);
+        // несколько полных пачек и хвост, который дописывает деструктор
+        while (expected.size() < 3 * FileObserver::BATCH_BYTES + 100) {
+            observer.onFight(knight, attacker, true);
+            observer.onFight(attacker, knight, false);
+            expected += streamKillLine(*knight, *attacker);
+        }
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    std::string actual((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_F(ObserverTest, FileObserverFlush) {
+    const std::string filename = "test_log.txt";
+    FileObserver observer(filename);
+    observer.onFight(attacker, defender, true);
+    observer.flush();
+
+    auto lines = readLines(filename);
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0], "Toad AttackerToad killed Dragon DefenderDragon at (30, 40)");
+}
+
+TEST_F(ObserverTest, AsyncFileObserverMatchesFileObserver) {
+    auto knight = std::make_shared<Knight>("KnightAttacker", 50, 60);
+    {
+        FileObserver sync("test_async_sync.txt");
+        AsyncFileObserver async("test_async_log.txt");
+        for (int i = 0; i < 100; ++i) {
+            sync.onFight(attacker, defender, true);
+            async.onFight(attacker, defender, true);
+            sync.onFight(knight, attacker, i % 2 == 0);
+            async.onFight(knight, attacker, i % 2 == 0);
+        }
+    }
+
+    auto expected = readLines("test_async_sync.txt");
+    auto actual = readLines("test_async_log.txt");
+    EXPECT_EQ(expected.size(), 150u);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_F(ObserverTest, AsyncFileObserverFlush) {
+    AsyncFileObserver async("test_async_log.txt");
+    async.onFight(attacker, defender, true);
+    async.onFight(attacker, defender, false);
+    async.flush();
+
+    EXPECT_EQ(async.written(), 1u);
+    auto lines = readLines("test_async_log.txt");
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0], "Toad AttackerToad killed Dragon DefenderDragon at (30, 40)");
+}
+
+TEST_F(ObserverTest, AsyncFileObserverOverflowPolicies) {
+    const size_t events = 2000;
+    for (OverflowPolicy policy : {OverflowPolicy::Block, OverflowPolicy::Drop, OverflowPolicy::Sample}) {
+        std::remove("test_async_overflow.txt");
+        size_t written, dropped;
+        {
+            AsyncFileObserver async("test_async_overflow.txt", 2, policy, 4);
+            for (size_t i = 0; i < events; ++i) {
+                async.onFight(attacker, defender, true);
+            }
+            async.flush();
+            written = async.written();
+            dropped = async.dropped();
+        }
+        EXPECT_EQ(written + dropped, events);
+        EXPECT_EQ(readLines("test_async_overflow.txt").size(), written);
+        if (policy == OverflowPolicy::Block) {
+            EXPECT_EQ(dropped, 0u);
+        }
+    }
+}
+
+TEST_F(ObserverTest, AsyncFileObserverKeepsLongNames) {
+    auto longName = std::make_shared<Knight>(std::string(100, 'k'), 1, 2);
+    auto longVictim = std::make_shared<Toad>(std::string(100, 't'), 3, 4);
+    {
+        FileObserver sync("test_async_sync.txt");
+        AsyncFileObserver async("test_async_log.txt");
+        for (auto* observer : {static_cast<IFFightObserver*>(&sync), static_cast<IFFightObserver*>(&async)}) {
+            observer->onFight(longName, defender, true);
+            observer->onFight(longName, longVictim, true);
+        }
+    }
+    auto lines = readLines("test_async_log.txt");
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "Knight " + std::string(100, 'k') + " killed Dragon DefenderDragon at (30, 40)");
+    EXPECT_EQ(lines, readLines("test_async_sync.txt"));
+}
+
+TEST_F(ObserverTest, ObserversDoNotAllocate) {
+    auto toad = NPCFactory::create(NpcType::Toad, "Toad_with_a_rather_long_name", 1, 2);
+    auto knight = NPCFactory::create(NpcType::Knight, "K", 5, 6);
+    FixedBuffer buffer;
+    std::streambuf* old_cout = std::cout.rdbuf(&buffer);
+    TextObserver text;
+    auto file = std::make_unique<FileObserver>("test_observer_alloc.txt");
+    // первая строка заводит буфер потока
+    text.onFight(toad, knight, true);
+
+    AllocationCounter counter;
+    for (int i = 0; i < 20; ++i) text.onFight(knight, toad, true);
+    // с переполнением пачки и записью в файл
+    for (size_t i = 0; i < 2 * FileObserver::BATCH_BYTES / 40; ++i) file->onFight(toad, knight, true);
+    size_t allocations = counter.stop();
+
+    std::cout.rdbuf(old_cout);
+    file.reset();
+    std::remove("test_observer_alloc.txt");
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_NE(buffer.text().find("Knight K killed Toad Toad_with_a_rather_long_name at (1, 2)\n"), std::string_view::npos);
 }
\ No newline at end of file
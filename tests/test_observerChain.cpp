@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "allocationCounter.h"
+#include "battle.h"
+#include "fightVisitor.h"
+#include "npcRegistry.h"
+#include "observerChain.h"
+#include "toad.h"
+#include "dragon.h"
+#include "knight.h"
+#include "variantWorld.h"
+#include "world.h"
+
+namespace {
+
+// пишет события в общий журнал с меткой, чтобы видеть порядок вызовов
+struct Recorder {
+    std::vector<std::string>* log;
+    std::string tag;
+
+    Recorder(std::vector<std::string>* log, std::string tag) : log(log), tag(std::move(tag)) {}
+
+    void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) {
+        log->push_back(tag + ":" + std::string(attacker->getName()) + ">" + std::string(defender->getName())
+                       + (success ? "+" : "-"));
+    }
+};
+
+class CountingObserver : public IFFightObserver {
+public:
+    int calls = 0;
+    void onFight(const std::shared_ptr<NPC>&, const std::shared_ptr<NPC>&, bool) override { ++calls; }
+};
+
+}  // namespace
+
+class ObserverChainTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        toad = std::make_shared<Toad>("T", 0, 0);
+        dragon = std::make_shared<Dragon>("D", 1, 1);
+        knight = std::make_shared<Knight>("K", 2, 2);
+    }
+
+    std::shared_ptr<NPC> toad, dragon, knight;
+    std::vector<std::string> log;
+};
+
+TEST_F(ObserverChainTest, FiltersAreCompileTime) {
+    static_assert(KillsOnly::accepts(NpcType::Toad, NpcType::Toad, true));
+    static_assert(!KillsOnly::accepts(NpcType::Toad, NpcType::Toad, false));
+    static_assert(TypePair<NpcType::Knight, NpcType::Dragon>::accepts(NpcType::Knight, NpcType::Dragon, false));
+    static_assert(!TypePair<NpcType::Knight, NpcType::Dragon>::accepts(NpcType::Dragon, NpcType::Knight, false));
+    static_assert(AllOf<KillsOnly, AttackerIs<NpcType::Toad>>::accepts(NpcType::Toad, NpcType::Knight, true));
+    static_assert(!AllOf<KillsOnly, AttackerIs<NpcType::Toad>>::accepts(NpcType::Knight, NpcType::Toad, true));
+    static_assert(ObserverChain<Recorder, Recorder>::size() == 2);
+    SUCCEED();
+}
+
+TEST_F(ObserverChainTest, CallsObserversInOrder) {
+    ObserverChain<Recorder, Filtered<KillsOnly, Recorder>, Filtered<TypePair<NpcType::Dragon, NpcType::Knight>, Recorder>>
+        chain(Recorder(&log, "all"), Recorder(&log, "kills"), Recorder(&log, "dk"));
+
+    chain.onFight(toad, dragon, true);
+    chain.onFight(dragon, toad, false);
+    chain.onFight(dragon, knight, true);
+
+    std::vector<std::string> expected = {
+        "all:T>D+", "kills:T>D+",
+        "all:D>T-",
+        "all:D>K+", "kills:D>K+", "dk:D>K+",
+    };
+    EXPECT_EQ(log, expected);
+    EXPECT_EQ(chain.get<1>().get().tag, "kills");
+}
+
+TEST_F(ObserverChainTest, HoldsPointersAndRuntimeObservers) {
+    auto counting = std::make_shared<CountingObserver>();
+    std::shared_ptr<IFFightObserver> missing;
+    ObserverChain<std::shared_ptr<CountingObserver>, Filtered<KillsOnly, std::shared_ptr<IFFightObserver>>,
+                  std::shared_ptr<IFFightObserver>> chain(counting, counting, missing);
+
+    chain.onFight(toad, dragon, true);
+    chain.onFight(dragon, toad, false);
+
+    // пустой указатель пропускается
+    EXPECT_EQ(counting->calls, 3);
+}
+
+TEST_F(ObserverChainTest, MatchesSeparateTextObservers) {
+    std::stringstream expected, actual;
+    std::streambuf* old_cout = std::cout.rdbuf(expected.rdbuf());
+    // то, что напечатали бы два отдельных наблюдателя с фильтрами
+    TextObserver text;
+    text.onFight(toad, dragon, true);
+    text.onFight(toad, dragon, true);
+    text.onFight(knight, dragon, true);
+
+    std::cout.rdbuf(actual.rdbuf());
+    ObserverChain<Filtered<KillsOnly, TextObserver>, Filtered<AttackerIs<NpcType::Toad>, TextObserver>> chain;
+    chain.onFight(toad, dragon, true);
+    chain.onFight(dragon, knight, false);
+    chain.onFight(knight, dragon, true);
+    std::cout.rdbuf(old_cout);
+
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST_F(ObserverChainTest, PlugsIntoFightVisitor) {
+    auto chain = std::make_shared<ObserverChain<Filtered<KillsOnly, Recorder>>>(Recorder(&log, "v"));
+    auto visitor = std::make_shared<FightVisitor>(toad, chain);
+
+    EXPECT_TRUE(dragon->accept(visitor));
+    EXPECT_TRUE(knight->accept(visitor));
+
+    auto dragonVisitor = std::make_shared<FightVisitor>(dragon, chain);
+    EXPECT_FALSE(toad->accept(dragonVisitor));
+
+    std::vector<std::string> expected = {"v:T>D+", "v:T>K+"};
+    EXPECT_EQ(log, expected);
+}
+
+TEST_F(ObserverChainTest, PlugsIntoFightAndRegistry) {
+    set_t npcs = {toad, dragon, knight};
+    auto chain = std::make_shared<ObserverChain<Recorder, Filtered<KillsOnly, Recorder>>>(Recorder(&log, "all"),
+                                                                                          Recorder(&log, "kills"));
+    set_t dead = fight(npcs, 10, chain);
+    size_t kills = 0, all = 0;
+    for (const auto& line : log) {
+        if (line.rfind("kills:", 0) == 0) ++kills;
+        if (line.rfind("all:", 0) == 0) ++all;
+    }
+    EXPECT_EQ(kills, dead.size());
+    EXPECT_FALSE(dead.empty());
+    EXPECT_GE(all, kills);
+
+    log.clear();
+    NpcRegistry registry;
+    registry.create(NpcType::Toad, "RT", 0, 0);
+    registry.create(NpcType::Dragon, "RD", 1, 1);
+    auto adapter = std::make_shared<RegistryObserverAdapter>(chain);
+    auto killed = fight(registry, 10, adapter);
+    EXPECT_EQ(killed.size(), 1u);
+    EXPECT_NE(std::find(log.begin(), log.end(), "kills:RT>RD+"), log.end());
+}
+
+TEST_F(ObserverChainTest, ChainExposesFilterToRounds) {
+    using KnightKills = ObserverChain<Filtered<AllOf<KillsOnly, AttackerIs<NpcType::Knight>>, Recorder>>;
+    KnightKills chain{Recorder(&log, "k")};
+    EXPECT_TRUE(chain.accepts(NpcType::Knight, NpcType::Dragon, true));
+    EXPECT_FALSE(chain.accepts(NpcType::Knight, NpcType::Dragon, false));
+    EXPECT_FALSE(chain.accepts(NpcType::Toad, NpcType::Dragon, true));
+
+    // элемент без фильтра принимает все, пустой указатель - ничего
+    ObserverChain<Filtered<KillsOnly, Recorder>, std::shared_ptr<CountingObserver>> withNull{Recorder(&log, "r"), nullptr};
+    EXPECT_FALSE(withNull.accepts(NpcType::Toad, NpcType::Toad, false));
+    ObserverChain<Filtered<KillsOnly, Recorder>, Recorder> withPlain{Recorder(&log, "r"), Recorder(&log, "p")};
+    EXPECT_TRUE(withPlain.accepts(NpcType::Toad, NpcType::Toad, false));
+}
+
+TEST_F(ObserverChainTest, RoundsSkipRejectedEvents) {
+    // жабы и драконы, рыцарей нет: фильтр по рыцарям отвергает каждое событие
+    NpcWorld source;
+    for (int i = 0; i < 600; ++i) {
+        source.add(i % 2 ? NpcType::Dragon : NpcType::Toad, "n" + std::to_string(i), (i * 37) % 500, (i * 91) % 500);
+    }
+    auto rejecting = std::make_shared<ObserverChain<Filtered<AttackerIs<NpcType::Knight>, Recorder>>>(Recorder(&log, "k"));
+    auto counting = std::make_shared<ObserverChain<std::shared_ptr<CountingObserver>>>(std::make_shared<CountingObserver>());
+
+    NpcWorld plain = source;
+    std::vector<size_t> expected = fight(plain, 40);
+    ASSERT_FALSE(expected.empty());
+
+    NpcWorld world = source;
+    std::vector<size_t> killed;
+    killed.reserve(world.size());
+    SpatialGrid grid;
+    AllocationCounter counter;
+    fight(world, 40, grid, killed, rejecting);
+    size_t allocations = counter.stop();
+    EXPECT_EQ(killed, expected);
+
+    // каждое принятое событие создает объекты NPC
+    NpcWorld observed = source;
+    std::vector<size_t> observedKilled;
+    observedKilled.reserve(observed.size());
+    SpatialGrid observedGrid;
+    AllocationCounter observedCounter;
+    fight(observed, 40, observedGrid, observedKilled, counting);
+    size_t observedAllocations = observedCounter.stop();
+    EXPECT_EQ(observedKilled, expected);
+    EXPECT_GT(counting->get<0>()->calls, 0);
+
+    // отвергнутые события не стоят ни одного NPC: только буферы раунда (у Battle
+    // еще очередь событий и поток-читатель), а принятые создают почти всех
+    EXPECT_LT(allocations, 16u);
+    EXPECT_GT(observedAllocations, source.size());
+
+    VariantWorld values;
+    for (size_t i = 0; i < source.size(); ++i) {
+        values.add(source.getType(i), source.getName(i), source.getX(i), source.getY(i));
+    }
+    AllocationCounter variantCounter;
+    EXPECT_EQ(fight(values, 40, rejecting), expected);
+    EXPECT_LT(variantCounter.stop(), 32u);
+
+    NpcWorld parallel = source;
+    Battle battle(BattleOptions{BattleMode::Parallel, 2, 64});
+    NpcWorld warmup = source;
+    battle.round(warmup, 40, rejecting);
+    AllocationCounter battleCounter;
+    std::vector<size_t> parallelKilled = battle.round(parallel, 40, rejecting);
+    size_t battleAllocations = battleCounter.stop();
+    EXPECT_FALSE(parallelKilled.empty());
+    EXPECT_LT(battleAllocations, source.size() / 4);
+    EXPECT_TRUE(log.empty());
+}
\ No newline at end of file
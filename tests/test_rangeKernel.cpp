@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "rangeKernel.h"
+
+class RangeKernelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen(5);
+        std::uniform_int_distribution<> coord(0, 500);
+        for (int i = 0; i < 1037; ++i) {
+            xs.push_back(coord(gen));
+            ys.push_back(coord(gen));
+        }
+    }
+
+    std::vector<uint8_t> expected(int x, int y, long long range2, size_t count) const {
+        std::vector<uint8_t> mask(count);
+        for (size_t i = 0; i < count; ++i) {
+            long long dx = xs[i] - x, dy = ys[i] - y;
+            mask[i] = dx * dx + dy * dy <= range2;
+        }
+        return mask;
+    }
+
+    std::vector<int> xs, ys;
+};
+
+TEST_F(RangeKernelTest, AllLevelsMatchScalarReference) {
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (!simdLevelSupported(level)) continue;
+        for (long long range : {0LL, 1LL, 20LL, 95LL, 400LL, 1000LL}) {
+            // разные длины, чтобы задеть хвосты после векторной части
+            for (size_t count : {size_t{0}, size_t{1}, size_t{3}, size_t{7}, size_t{9}, size_t{17}, xs.size()}) {
+                std::vector<uint8_t> mask(count + 1, 0xAA);
+                size_t hits = rangeMask(level, 250, 250, xs.data(), ys.data(), count, range * range, mask.data());
+                mask.pop_back();
+                auto reference = expected(250, 250, range * range, count);
+                EXPECT_EQ(mask, reference) << simdLevelName(level) << " range " << range << " count " << count;
+
+                size_t expectedHits = 0;
+                for (uint8_t m : reference) expectedHits += m;
+                EXPECT_EQ(hits, expectedHits);
+            }
+        }
+    }
+}
+
+TEST_F(RangeKernelTest, BoundaryIsInclusive) {
+    int bx[] = {3, 4, 0, 5};
+    int by[] = {4, 4, 5, 0};
+    uint8_t mask[4];
+    // 3-4-5: ровно на границе входит, чуть дальше - нет
+    EXPECT_EQ(rangeMask(0, 0, bx, by, 4, 25, mask), 3u);
+    EXPECT_EQ(mask[0], 1);
+    EXPECT_EQ(mask[1], 0);
+    EXPECT_EQ(mask[2], 1);
+    EXPECT_EQ(mask[3], 1);
+}
+
+TEST_F(RangeKernelTest, HugeRangeCoversEverything) {
+    std::vector<uint8_t> mask(xs.size());
+    EXPECT_EQ(rangeMask(0, 0, xs.data(), ys.data(), xs.size(), 1LL << 40, mask.data()), xs.size());
+}
+
+TEST_F(RangeKernelTest, DetectedLevelIsSupported) {
+    EXPECT_TRUE(simdLevelSupported(detectSimdLevel()));
+    EXPECT_TRUE(simdLevelSupported(SimdLevel::Scalar));
+}
+
+
+TEST_F(RangeKernelTest, WideMatchesReferenceOnHugeCoordinates) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> coord(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::uniform_int_distribution<int> near(-3000000, 3000000);
+    std::vector<int> wx, wy;
+    for (int i = 0; i < 517; ++i) {
+        // половина рядом с нападающим, половина по всей оси int32
+        wx.push_back(i % 2 ? coord(gen) : 1000000000 + near(gen));
+        wy.push_back(i % 2 ? coord(gen) : -1000000000 + near(gen));
+    }
+    const int x = 1000000000, y = -1000000000;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (!simdLevelSupported(level)) continue;
+        for (long long range : {0LL, 1000LL, 2000000LL, 2147483646LL}) {
+            std::vector<uint8_t> mask(wx.size());
+            size_t hits = rangeMaskWide(level, x, y, wx.data(), wy.data(), wx.size(), range * range, mask.data());
+            size_t expectedHits = 0;
+            for (size_t i = 0; i < wx.size(); ++i) {
+                long double dx = static_cast<long double>(wx[i]) - x, dy = static_cast<long double>(wy[i]) - y;
+                uint8_t inRange = dx * dx + dy * dy <= static_cast<long double>(range) * range;
+                EXPECT_EQ(mask[i], inRange) << simdLevelName(level) << " range " << range << " i " << i;
+                expectedHits += inRange;
+            }
+            EXPECT_EQ(hits, expectedHits);
+        }
+    }
+}
+
+// радиус больше WIDE_RANGE_LIMIT: пары дальше 2^31 не теряются, с краю до края - все
+TEST_F(RangeKernelTest, HugeMatchesReferenceBeyondWideLimit) {
+    std::mt19937 gen(12);
+    std::uniform_int_distribution<int> coord(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::vector<int> wx, wy;
+    for (int i = 0; i < 301; ++i) {
+        wx.push_back(coord(gen));
+        wy.push_back(coord(gen));
+    }
+    wx.push_back(std::numeric_limits<int>::max());
+    wy.push_back(std::numeric_limits<int>::max());
+    const int x = std::numeric_limits<int>::min(), y = std::numeric_limits<int>::min();
+    for (unsigned long long range : {2147483647ULL, 3000000000ULL, 5000000000ULL, 6074000998ULL,
+                                     static_cast<unsigned long long>(MAX_INT32_DISTANCE)}) {
+        std::vector<uint8_t> mask(wx.size());
+        size_t hits = rangeMaskHuge(x, y, wx.data(), wy.data(), wx.size(), range, mask.data());
+        size_t expectedHits = 0;
+        for (size_t i = 0; i < wx.size(); ++i) {
+            long double dx = static_cast<long double>(wx[i]) - x, dy = static_cast<long double>(wy[i]) - y;
+            uint8_t inRange = dx * dx + dy * dy <= static_cast<long double>(range) * range;
+            EXPECT_EQ(mask[i], inRange) << "range " << range << " i " << i;
+            expectedHits += inRange;
+        }
+        EXPECT_EQ(hits, expectedHits);
+    }
+    std::vector<uint8_t> all(wx.size());
+    EXPECT_EQ(rangeMaskHuge(x, y, wx.data(), wy.data(), wx.size(), MAX_INT32_DISTANCE, all.data()), wx.size());
+}
+
+TEST_F(RangeKernelTest, WideAgreesWithNarrowOnSmallMap) {
+    std::vector<uint8_t> narrow(xs.size()), wide(xs.size());
+    for (long long range : {0LL, 20LL, 400LL}) {
+        rangeMask(250, 250, xs.data(), ys.data(), xs.size(), range * range, narrow.data());
+        rangeMaskWide(250, 250, xs.data(), ys.data(), xs.size(), range * range, wide.data());
+        EXPECT_EQ(narrow, wide);
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fightRules.h"
+#include "rangeSweep.h"
+
+class RangeSweepTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        FightRules::install(defaultFightRules);
+    }
+
+    static NpcWorld randomWorld(size_t count, unsigned seed) {
+        NpcWorld world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            world.add(type, "npc_" + std::to_string(i), x, y);
+        }
+        return world;
+    }
+
+    // эталон: fight() на каждом шаге, как в редакторе
+    static std::vector<std::vector<size_t>> stepByStep(NpcWorld world, const std::vector<size_t>& ranges) {
+        std::vector<std::vector<size_t>> result;
+        for (size_t range : ranges) {
+            std::vector<size_t> killed = fight(world, range);
+            std::sort(killed.begin(), killed.end());
+            result.push_back(killed);
+        }
+        return result;
+    }
+
+    const std::vector<size_t> editorRanges = {20, 35, 50, 65, 80, 95};
+};
+
+TEST_F(RangeSweepTest, MatchesStepByStepFight) {
+    for (size_t count : {30u, 200u, 3000u}) {
+        for (unsigned seed = 1; seed <= 3; ++seed) {
+            NpcWorld world = randomWorld(count, seed);
+            RangeSweepResult sweep = RangeSweep::run(world, editorRanges);
+            EXPECT_EQ(sweep.killed, stepByStep(world, editorRanges)) << count << " npc, seed " << seed;
+        }
+    }
+}
+
+TEST_F(RangeSweepTest, DeathRangeAndSurvivors) {
+    NpcWorld world;
+    world.add(NpcType::Knight, "K", 0, 0);
+    world.add(NpcType::Dragon, "D", 30, 0);     // рыцарь достает на шаге 35
+    world.add(NpcType::Toad, "T", 100, 100);    // жабу не бьет никто
+    world.add(NpcType::Dragon, "Dead", 1, 1);
+    world.kill(3);
+
+    RangeSweepResult sweep = RangeSweep::run(world, editorRanges);
+    ASSERT_EQ(sweep.killed.size(), editorRanges.size());
+    EXPECT_TRUE(sweep.killed[0].empty());
+    EXPECT_EQ(sweep.killed[1], std::vector<size_t>{1});
+    EXPECT_EQ(sweep.deathRange[1], 35u);
+    EXPECT_EQ(sweep.deathRange[0], RangeSweepResult::SURVIVES);
+    EXPECT_EQ(sweep.deathRange[2], RangeSweepResult::SURVIVES);
+    EXPECT_EQ(sweep.deathRange[3], RangeSweepResult::SURVIVES);
+    // мир не меняется
+    EXPECT_TRUE(world.isAlive(1));
+}
+
+TEST_F(RangeSweepTest, ArbitraryRangeOrder) {
+    const std::vector<size_t> ranges = {50, 20, 80, 80, 10, 200};
+    NpcWorld world = randomWorld(500, 7);
+    EXPECT_EQ(RangeSweep::run(world, ranges).killed, stepByStep(world, ranges));
+}
+
+TEST_F(RangeSweepTest, CustomRules) {
+    FightRules rules;
+    rules.set(NpcType::Dragon, NpcType::Toad, FightOutcome::Win)
+         .set(NpcType::Knight, NpcType::Knight, FightOutcome::Win);
+    FightRules::install(rules);
+
+    NpcWorld world = randomWorld(1000, 11);
+    EXPECT_EQ(RangeSweep::run(world, editorRanges).killed, stepByStep(world, editorRanges));
+}
+
+TEST_F(RangeSweepTest, EmptyInputs) {
+    NpcWorld world = randomWorld(10, 1);
+    RangeSweepResult none = RangeSweep::run(world, {});
+    EXPECT_TRUE(none.killed.empty());
+    EXPECT_EQ(none.deathRange.size(), 10u);
+
+    RangeSweepResult empty = RangeSweep::run(NpcWorld(), editorRanges);
+    EXPECT_EQ(empty.killed.size(), editorRanges.size());
+}
\ No newline at end of file
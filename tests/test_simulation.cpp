@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "battle.h"
+#include "simulation.h"
+#include "spatialGrid.h"
+
+class SimulationTest : public ::testing::Test {
+protected:
+    static NpcWorld randomWorld(size_t count, const WorldBounds& bounds, unsigned seed) {
+        NpcWorld world(bounds);
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_x(bounds.minX, bounds.maxX);
+        std::uniform_int_distribution<> rnd_y(bounds.minY, bounds.maxY);
+        for (size_t i = 0; i < count; ++i) {
+            world.add(static_cast<NpcType>(rnd_type(gen)), "npc_" + std::to_string(i), rnd_x(gen), rnd_y(gen));
+        }
+        return world;
+    }
+
+    static std::vector<uint32_t> inRange(const SpatialGrid& grid, int x, int y, size_t range) {
+        std::vector<uint32_t> found;
+        grid.forEachInRange(x, y, range, [&](uint32_t i) { found.push_back(i); });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+};
+
+TEST_F(SimulationTest, GridUpdateMatchesBruteForce) {
+    const WorldBounds area{0, 0, 999, 999};
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<> coord(0, 999), small(-3, 3), large(-30, 30);
+    std::vector<int> xs(3000), ys(3000);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = coord(gen);
+        ys[i] = coord(gen);
+    }
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), xs.size(), 25, area);
+    ThreadPool pool(3);
+
+    // немногие сменившие ячейку идут по цепочке, массовый переход - слиянием
+    size_t incremental = 0;
+    for (int round = 0; round < 20; ++round) {
+        auto& delta = round < 15 ? small : large;
+        for (size_t i = 0; i < xs.size(); i += round < 5 ? 50 : 1) {
+            xs[i] = std::clamp(xs[i] + delta(gen), 0, 999);
+            ys[i] = std::clamp(ys[i] + delta(gen), 0, 999);
+        }
+        incremental += grid.update(xs.data(), ys.data(), xs.size(), round % 2 ? &pool : nullptr, 256);
+        ASSERT_EQ(grid.size(), xs.size());
+        for (size_t a = 0; a < xs.size(); a += 97) {
+            std::vector<uint32_t> expected;
+            for (size_t d = 0; d < xs.size(); ++d) {
+                long long dx = xs[d] - xs[a], dy = ys[d] - ys[a];
+                if (dx * dx + dy * dy <= 40 * 40) expected.push_back(static_cast<uint32_t>(d));
+            }
+            ASSERT_EQ(inRange(grid, xs[a], ys[a], 40), expected) << "round " << round << " npc " << a;
+        }
+    }
+    EXPECT_EQ(incremental, 20u);
+}
+
+TEST_F(SimulationTest, GridUpdateFallsBackToRebuild) {
+    std::vector<int> xs{1, 2, 3}, ys{1, 2, 3};
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), xs.size(), 5);
+    // сетка по разбросу точек обновляться не умеет
+    EXPECT_FALSE(grid.update(xs.data(), ys.data(), xs.size()));
+
+    grid.build(xs.data(), ys.data(), xs.size(), 5, WorldBounds{0, 0, 100, 100});
+    EXPECT_TRUE(grid.update(xs.data(), ys.data(), xs.size()));
+    xs.push_back(90);
+    ys.push_back(90);
+    EXPECT_FALSE(grid.update(xs.data(), ys.data(), xs.size()));
+    EXPECT_EQ(inRange(grid, 90, 90, 1), (std::vector<uint32_t>{3}));
+}
+
+TEST_F(SimulationTest, NpcsMoveInsideBounds) {
+    const WorldBounds bounds{-50, 10, 50, 60};
+    NpcWorld world = randomWorld(300, bounds, 1);
+    NpcWorld start = world;
+    SimulationOptions options;
+    options.range = 0;
+    options.maxSpeed = 7;
+    options.threads = 2;
+    Simulation simulation(world, options);
+    simulation.run(100);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < world.size(); ++i) {
+        EXPECT_TRUE(bounds.contains(world.getX(i), world.getY(i)));
+        moved += world.getX(i) != start.getX(i) || world.getY(i) != start.getY(i);
+    }
+    EXPECT_GT(moved, world.size() / 2);
+    EXPECT_EQ(simulation.getTick(), 100u);
+    EXPECT_EQ(simulation.getStats().ticks, 100u);
+}
+
+TEST_F(SimulationTest, DeterministicAcrossThreadCounts) {
+    const WorldBounds bounds{0, 0, 2000, 2000};
+    NpcWorld reference;
+    for (size_t threads : {1, 2, 5}) {
+        NpcWorld world = randomWorld(4000, bounds, 9);
+        SimulationOptions options;
+        options.range = 15;
+        options.threads = threads;
+        options.chunkSize = 100;
+        options.seed = 77;
+        Simulation simulation(world, options);
+        simulation.run(40);
+        if (threads == 1) {
+            reference = world;
+            EXPECT_GT(simulation.getStats().kills, 0u);
+            continue;
+        }
+        ASSERT_EQ(world.size(), reference.size());
+        for (size_t i = 0; i < world.size(); ++i) {
+            ASSERT_EQ(world.getX(i), reference.getX(i)) << "threads " << threads << " npc " << i;
+            ASSERT_EQ(world.getY(i), reference.getY(i));
+            ASSERT_EQ(world.isAlive(i), reference.isAlive(i));
+        }
+    }
+}
+
+TEST_F(SimulationTest, StandingStillFightsLikeBattle) {
+    NpcWorld world = randomWorld(2000, defaultWorldBounds, 4);
+    NpcWorld copy = world;
+    SimulationOptions options;
+    options.range = 12;
+    options.maxSpeed = 0;
+    options.threads = 3;
+    Simulation simulation(world, options);
+    std::vector<size_t> killed = simulation.tick();
+
+    Battle battle(BattleOptions{BattleMode::Parallel, 2});
+    EXPECT_EQ(killed, battle.round(copy, 12));
+    EXPECT_FALSE(killed.empty());
+}
+
+TEST_F(SimulationTest, AdvanceRunsWholeTicks) {
+    NpcWorld world = randomWorld(50, defaultWorldBounds, 2);
+    SimulationOptions options;
+    options.tickSeconds = 0.01;
+    options.threads = 1;
+    Simulation simulation(world, options);
+    EXPECT_EQ(simulation.advance(0.006), 0u);
+    EXPECT_EQ(simulation.advance(0.006), 1u);
+    EXPECT_EQ(simulation.advance(0.025), 2u);
+    // отставание больше maxTicks отбрасывается
+    EXPECT_EQ(simulation.advance(1.0, 4), 4u);
+    EXPECT_EQ(simulation.advance(0.0), 0u);
+    EXPECT_EQ(simulation.getTick(), 7u);
+}
+
+TEST_F(SimulationTest, RemoveDeadAndAddKeepGridInSync) {
+    NpcWorld world = randomWorld(1500, defaultWorldBounds, 6);
+    SimulationOptions options;
+    options.range = 10;
+    options.threads = 2;
+    Simulation simulation(world, options);
+    simulation.run(3);
+    simulation.removeDead();
+    EXPECT_EQ(world.size(), world.aliveCount());
+    EXPECT_EQ(simulation.getGrid().size(), world.size());
+
+    world.add(NpcType::Knight, "Newcomer", 250, 250);
+    simulation.tick();
+    EXPECT_EQ(simulation.getGrid().size(), world.size());
+
+    // сетку вызывающего умеет только Parallel
+    Battle sequential(BattleOptions{BattleMode::Sequential});
+    std::vector<size_t> killed;
+    EXPECT_THROW(sequential.round(world, 10, simulation.getGrid(), killed), std::runtime_error);
+
+}
\ No newline at end of file
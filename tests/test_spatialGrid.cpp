@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "spatialGrid.h"
+
+class SpatialGridTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<> coord(0, 500);
+        for (int i = 0; i < 2000; ++i) {
+            xs.push_back(coord(gen));
+            ys.push_back(coord(gen));
+        }
+    }
+
+    std::vector<uint32_t> inRange(const SpatialGrid& grid, int x, int y, size_t range) {
+        std::vector<uint32_t> found;
+        long long r2 = static_cast<long long>(range) * range;
+        grid.forEachCandidate(x, y, range, [&](uint32_t i) {
+            long long dx = xs[i] - x, dy = ys[i] - y;
+            if (dx * dx + dy * dy <= r2) found.push_back(i);
+        });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+    std::vector<uint32_t> bruteInRange(int x, int y, size_t range) {
+        std::vector<uint32_t> found;
+        long long r2 = static_cast<long long>(range) * range;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            long long dx = xs[i] - x, dy = ys[i] - y;
+            if (dx * dx + dy * dy <= r2) found.push_back(static_cast<uint32_t>(i));
+        }
+        return found;
+    }
+
+    std::vector<int> xs, ys;
+};
+
+TEST_F(SpatialGridTest, EmptyGrid) {
+    SpatialGrid grid;
+    grid.build(nullptr, nullptr, 0, 20);
+    int calls = 0;
+    grid.forEachCandidate(10, 10, 20, [&](uint32_t) { ++calls; });
+    EXPECT_TRUE(grid.empty());
+    EXPECT_EQ(calls, 0);
+}
+
+TEST_F(SpatialGridTest, CandidatesCoverRange) {
+    for (size_t range : {0u, 1u, 20u, 35u, 100u, 1000u}) {
+        SpatialGrid grid;
+        grid.build(xs.data(), ys.data(), xs.size(), range);
+        ASSERT_EQ(grid.size(), xs.size());
+        for (size_t i = 0; i < xs.size(); i += 37) {
+            EXPECT_EQ(inRange(grid, xs[i], ys[i], range), bruteInRange(xs[i], ys[i], range))
+                << "range " << range << " point " << i;
+        }
+    }
+}
+
+TEST_F(SpatialGridTest, QueryOutsideBounds) {
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), xs.size(), 20);
+    EXPECT_EQ(inRange(grid, -100, -100, 20), bruteInRange(-100, -100, 20));
+    EXPECT_EQ(inRange(grid, 510, 505, 20), bruteInRange(510, 505, 20));
+}
+
+TEST_F(SpatialGridTest, EachPointVisitedOnce) {
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), xs.size(), 50);
+    std::vector<int> seen(xs.size(), 0);
+    grid.forEachCandidate(250, 250, 1000, [&](uint32_t i) { ++seen[i]; });
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](int n) { return n == 1; }));
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "allocationCounter.h"
+#include "factory.h"
+#include "observer.h"
+#include "stringPool.h"
+#include "toad.h"
+#include "variantWorld.h"
+#include "world.h"
+
+class StringPoolTest : public ::testing::Test {
+protected:
+    StringPool pool;
+};
+
+TEST_F(StringPoolTest, SameTextSameId) {
+    uint32_t a = pool.intern("Toad_Ivan");
+    uint32_t b = pool.intern("Dragon_Petr");
+    std::string copy = "Toad_Ivan";
+
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 1u);
+    EXPECT_EQ(pool.intern(copy), a);
+    EXPECT_EQ(pool.view(a), "Toad_Ivan");
+    EXPECT_EQ(pool.view(b), "Dragon_Petr");
+    EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST_F(StringPoolTest, FindDoesNotInsert) {
+    EXPECT_EQ(pool.find("Knight"), StringPool::NONE);
+    uint32_t id = pool.intern("Knight");
+    EXPECT_EQ(pool.find("Knight"), id);
+    EXPECT_EQ(pool.find("Knigh"), StringPool::NONE);
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST_F(StringPoolTest, EmptyAndLongStrings) {
+    std::string longName(100000, 'x');
+    uint32_t empty = pool.intern("");
+    uint32_t big = pool.intern(longName);
+    uint32_t small = pool.intern("s");
+
+    EXPECT_EQ(pool.view(empty), "");
+    EXPECT_EQ(pool.view(big), longName);
+    EXPECT_EQ(pool.view(small), "s");
+    EXPECT_EQ(pool.intern(longName), big);
+}
+
+TEST_F(StringPoolTest, ViewsSurviveGrowth) {
+    uint32_t first = pool.intern("first");
+    std::string_view firstView = pool.view(first);
+
+    // несколько сегментов номеров и блоков текста, хеш-индекс перестраивается
+    const size_t count = 50000;
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(pool.intern("npc_" + std::to_string(i)), i + 1);
+    }
+
+    EXPECT_EQ(firstView.data(), pool.view(first).data());
+    EXPECT_EQ(firstView, "first");
+    for (size_t i = 0; i < count; i += 997) {
+        EXPECT_EQ(pool.view(static_cast<uint32_t>(i + 1)), "npc_" + std::to_string(i));
+        EXPECT_EQ(pool.find("npc_" + std::to_string(i)), i + 1);
+    }
+    EXPECT_EQ(pool.size(), count + 1);
+    EXPECT_GT(pool.memoryUsage(), count * 8);
+}
+
+TEST_F(StringPoolTest, ConcurrentInternAgrees) {
+    const size_t threads = 4;
+    const size_t names = 20000;
+    std::vector<std::vector<uint32_t>> ids(threads, std::vector<uint32_t>(names));
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            // потоки идут с разных концов, чтобы чаще сталкиваться на вставке
+            for (size_t k = 0; k < names; ++k) {
+                size_t i = (t % 2 == 0) ? k : names - 1 - k;
+                ids[t][i] = pool.intern("name_" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    EXPECT_EQ(pool.size(), names);
+    for (size_t i = 0; i < names; ++i) {
+        for (size_t t = 1; t < threads; ++t) {
+            ASSERT_EQ(ids[t][i], ids[0][i]);
+        }
+        ASSERT_EQ(pool.view(ids[0][i]), "name_" + std::to_string(i));
+    }
+}
+
+TEST_F(StringPoolTest, NpcsShareInternedNames) {
+    auto toad = NPCFactory::create(NpcType::Toad, "Twin", 1, 1);
+    auto knight = NPCFactory::create(NpcType::Knight, std::string("Twin"), 2, 2);
+    auto dragon = NPCFactory::create(NpcType::Dragon, "Other", 3, 3);
+
+    EXPECT_EQ(toad->getNameId(), knight->getNameId());
+    EXPECT_NE(toad->getNameId(), dragon->getNameId());
+    EXPECT_EQ(toad->getName().data(), knight->getName().data());
+    EXPECT_EQ(StringPool::global().view(dragon->getNameId()), "Other");
+    EXPECT_EQ(knight->getType(), "Knight");
+}
+
+TEST_F(StringPoolTest, OutputPathsDoNotAllocate) {
+    set_t npcs;
+    npcs.insert(NPCFactory::create(NpcType::Toad, "Toad_with_a_rather_long_name", 1, 2));
+    npcs.insert(NPCFactory::create(NpcType::Knight, "K", 5, 6));
+    FixedBuffer buffer;
+    std::ostream out(&buffer);
+    // локаль и прочее состояние потока - до начала счета
+    out << 0;
+
+    AllocationCounter counter;
+    for (const auto& npc : npcs) NPCFactory::save(npc, out);
+    out << npcs;
+    size_t allocations = counter.stop();
+
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_NE(buffer.text().find("Toad Toad_with_a_rather_long_name 1 2\n"), std::string_view::npos);
+    EXPECT_NE(buffer.text().find("Knight K 5 6\n"), std::string_view::npos);
+}
+
+TEST_F(StringPoolTest, ReleaseReclaimsNamesAndIds) {
+    std::string longName(100000, 'y');
+    uint32_t big = pool.intern(longName);
+    uint32_t kept = pool.intern("kept");
+    uint32_t twice = pool.intern("twice");
+    EXPECT_EQ(pool.intern("twice"), twice);
+    size_t withBig = pool.memoryUsage();
+
+    pool.release(big);
+    EXPECT_EQ(pool.find(longName), StringPool::NONE);
+    // у длинной строки свой блок - он уходит сразу
+    EXPECT_LE(pool.memoryUsage() + longName.size(), withBig);
+
+    // вторая ссылка держит строку
+    pool.release(twice);
+    EXPECT_EQ(pool.find("twice"), twice);
+    pool.release(twice);
+    EXPECT_EQ(pool.find("twice"), StringPool::NONE);
+    EXPECT_EQ(pool.size(), 1u);
+
+    // освобожденные номера достаются новым строкам
+    uint32_t reused = pool.intern("reused");
+    EXPECT_TRUE(reused == big || reused == twice);
+    EXPECT_EQ(pool.view(reused), "reused");
+    EXPECT_EQ(pool.view(kept), "kept");
+    EXPECT_EQ(pool.find("kept"), kept);
+}
+
+TEST_F(StringPoolTest, ChurnKeepsIndexAndMemoryBounded) {
+    // мир за миром: имена рождаются и уходят, пул не растет
+    std::vector<uint32_t> ids;
+    size_t firstRound = 0;
+    for (int round = 0; round < 20; ++round) {
+        ids.clear();
+        for (int i = 0; i < 5000; ++i) {
+            ids.push_back(pool.intern("r" + std::to_string(round) + "_npc_" + std::to_string(i)));
+        }
+        if (round == 0) firstRound = pool.memoryUsage();
+        // половину снимаем вразброс, остальные должны находиться по-прежнему
+        for (size_t i = 0; i < ids.size(); i += 2) pool.release(ids[i]);
+        for (size_t i = 1; i < ids.size(); i += 2) {
+            ASSERT_EQ(pool.find("r" + std::to_string(round) + "_npc_" + std::to_string(i)), ids[i]);
+        }
+        for (size_t i = 1; i < ids.size(); i += 2) pool.release(ids[i]);
+        ASSERT_EQ(pool.size(), 0u);
+    }
+    EXPECT_LE(pool.memoryUsage(), firstRound);
+}
+
+TEST_F(StringPoolTest, ConcurrentInternReleaseAgrees) {
+    const size_t threads = 4;
+    const size_t names = 2000;
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int pass = 0; pass < 5; ++pass) {
+                for (size_t k = 0; k < names; ++k) {
+                    size_t i = (t % 2 == 0) ? k : names - 1 - k;
+                    std::string name = "shared_" + std::to_string(i);
+                    uint32_t id = pool.intern(name);
+                    ASSERT_EQ(pool.view(id), name);
+                    pool.release(id);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(StringPoolTest, NamesLeaveGlobalPoolWithOwners) {
+    StringPool& global = StringPool::global();
+    const std::string name = "Transient_npc_name";
+    {
+        auto toad = NPCFactory::create(NpcType::Toad, name, 1, 1);
+        auto copy = std::make_shared<Toad>(*std::static_pointer_cast<Toad>(toad));
+        EXPECT_NE(global.find(name), StringPool::NONE);
+        toad.reset();
+        EXPECT_EQ(copy->getName(), name);
+    }
+    EXPECT_EQ(global.find(name), StringPool::NONE);
+
+    {
+        VariantWorld world;
+        world.add(NpcType::Knight, name, 2, 2);
+        VariantWorld copy = world;
+        world = VariantWorld();
+        EXPECT_EQ(copy.getName(0), name);
+    }
+    EXPECT_EQ(global.find(name), StringPool::NONE);
+}
+
+TEST_F(StringPoolTest, AsyncRecordsHoldNamesPastNpcs) {
+    const std::string attacker = "Async_attacker_name";
+    const std::string defender = "Async_defender_name";
+    {
+        AsyncFileObserver async("test_pool_async.txt", 8);
+        auto knight = NPCFactory::create(NpcType::Knight, attacker, 1, 2);
+        auto dragon = NPCFactory::create(NpcType::Dragon, defender, 3, 4);
+        async.onFight(knight, dragon, true);
+        // NPC уходят раньше, чем писатель мог дойти до записи
+        knight.reset();
+        dragon.reset();
+        async.flush();
+    }
+    std::ifstream file("test_pool_async.txt");
+    std::string line;
+    std::getline(file, line);
+    file.close();
+    std::remove("test_pool_async.txt");
+
+    EXPECT_EQ(line, "Knight Async_attacker_name killed Dragon Async_defender_name at (3, 4)");
+    EXPECT_EQ(StringPool::global().find(attacker), StringPool::NONE);
+    EXPECT_EQ(StringPool::global().find(defender), StringPool::NONE);
+}
\ No newline at end of file
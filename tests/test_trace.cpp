@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "battle.h"
+#include "trace.h"
+#include "variantWorld.h"
+#include "world.h"
+#include "toad.h"
+#include "dragon.h"
+#include "knight.h"
+
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        old_cout = std::cout.rdbuf(buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        FightTrace::install(nullptr);
+        std::cout.rdbuf(old_cout);
+    }
+
+    class RecordingSink : public IFightTraceSink {
+    public:
+        std::vector<FightOutcome> outcomes;
+        std::vector<std::string> pairs;  // "нападающий>защитник"
+        void onDuel(const NPC& attacker, const NPC& defender, FightOutcome outcome) override {
+            outcomes.push_back(outcome);
+            pairs.push_back(std::string(attacker.getName()) + ">" + std::string(defender.getName()));
+        }
+    };
+
+    static NpcWorld randomWorld(size_t count, unsigned seed) {
+        NpcWorld world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            world.add(type, "npc_" + std::to_string(i), x, y);
+        }
+        return world;
+    }
+
+    // счетчик событий наблюдателя - для сравнения с трассой
+    class CountingObserver : public IFFightObserver {
+    public:
+        size_t events = 0;
+        void onFight(const std::shared_ptr<NPC>&, const std::shared_ptr<NPC>&, bool) override { ++events; }
+    };
+
+    std::stringstream buffer;
+    std::streambuf* old_cout = nullptr;
+};
+
+TEST_F(TraceTest, DisabledByDefault) {
+    EXPECT_FALSE(FightTrace::enabled());
+    Toad toad("T", 0, 0);
+    Dragon dragon("D", 1, 1);
+    EXPECT_TRUE(toad.duel(dragon));
+    EXPECT_TRUE(buffer.str().empty());
+}
+
+TEST_F(TraceTest, ConsoleSinkNarratesEachDuel) {
+    FightTrace::install(std::make_shared<ConsoleTraceSink>());
+    Toad toad("T", 0, 0);
+    Dragon dragon("D", 1, 1);
+    Knight knight("K", 2, 2);
+
+    dragon.duel(toad);
+    dragon.duel(knight);
+    knight.duel(knight);
+
+    EXPECT_EQ(buffer.str(),
+              "Dragon D fights Toad T - Toad wins (eats all)\n"
+              "Dragon D fights Knight K - Dragon wins\n"
+              "Knight K fights Knight K - Draw\n");
+}
+
+TEST_F(TraceTest, SinkSeesEveryPairInRound) {
+    auto sink = std::make_shared<RecordingSink>();
+    FightTrace::install(sink);
+
+    set_t world;
+    world.insert(std::make_shared<Dragon>("D1", 0, 0));
+    world.insert(std::make_shared<Dragon>("D2", 1, 0));
+    fight(world, 5);
+
+    // две ничьи, в обе стороны
+    EXPECT_EQ(sink->outcomes, (std::vector<FightOutcome>{FightOutcome::Draw, FightOutcome::Draw}));
+    EXPECT_TRUE(buffer.str().empty());
+}
+
+TEST_F(TraceTest, InstallNullDisables) {
+    FightTrace::install(std::make_shared<ConsoleTraceSink>());
+    EXPECT_TRUE(FightTrace::enabled());
+    FightTrace::install(nullptr);
+    EXPECT_FALSE(FightTrace::enabled());
+
+    Knight knight("K", 0, 0);
+    Dragon dragon("D", 0, 0);
+    knight.duel(dragon);
+    EXPECT_TRUE(buffer.str().empty());
+}
+
+TEST_F(TraceTest, WorldAndVariantRoundsReachSink) {
+    const NpcWorld source = randomWorld(400, 11);
+
+    auto expected = std::make_shared<RecordingSink>();
+    FightTrace::install(expected);
+    NpcWorld world = source;
+    std::vector<size_t> killed = fight(world, 30);
+    ASSERT_FALSE(expected->pairs.empty());
+    ASSERT_FALSE(killed.empty());
+
+    // тот же обход сетки - та же последовательность поединков
+    auto variant = std::make_shared<RecordingSink>();
+    FightTrace::install(variant);
+    VariantWorld values;
+    for (size_t i = 0; i < source.size(); ++i) {
+        values.add(source.getType(i), source.getName(i), source.getX(i), source.getY(i));
+    }
+    EXPECT_EQ(fight(values, 30), killed);
+    EXPECT_EQ(variant->pairs, expected->pairs);
+    EXPECT_EQ(variant->outcomes, expected->outcomes);
+
+    auto sequential = std::make_shared<RecordingSink>();
+    FightTrace::install(sequential);
+    NpcWorld again = source;
+    Battle battle(BattleOptions{BattleMode::Sequential, 1, 64});
+    EXPECT_EQ(battle.round(again, 30), killed);
+    EXPECT_EQ(sequential->pairs, expected->pairs);
+    EXPECT_TRUE(buffer.str().empty());
+}
+
+TEST_F(TraceTest, ParallelBattleReachesSinkInCommitOrder) {
+    const NpcWorld source = randomWorld(2000, 12);
+    Battle battle(BattleOptions{BattleMode::Parallel, 4, 64});
+
+    NpcWorld plain = source;
+    std::vector<size_t> expected = battle.round(plain, 20);
+
+    // трасса без наблюдателя идет через читателя, убитые те же
+    auto traced = std::make_shared<RecordingSink>();
+    FightTrace::install(traced);
+    NpcWorld world = source;
+    EXPECT_EQ(battle.round(world, 20), expected);
+    ASSERT_FALSE(traced->pairs.empty());
+
+    // с наблюдателем - те же поединки, что видит он
+    auto observed = std::make_shared<RecordingSink>();
+    FightTrace::install(observed);
+    auto observer = std::make_shared<CountingObserver>();
+    NpcWorld withObserver = source;
+    EXPECT_EQ(battle.round(withObserver, 20, observer), expected);
+    EXPECT_EQ(observed->pairs, traced->pairs);
+    EXPECT_EQ(observer->events, observed->pairs.size());
+
+    // готовая сетка вызывающего, как у Simulation
+    auto prebuilt = std::make_shared<RecordingSink>();
+    FightTrace::install(prebuilt);
+    NpcWorld onGrid = source;
+    SpatialGrid grid;
+    grid.build(onGrid.xData(), onGrid.yData(), onGrid.size(), 20);
+    std::vector<size_t> killed;
+    battle.round(onGrid, 20, grid, killed);
+    EXPECT_EQ(killed, expected);
+    EXPECT_EQ(prebuilt->pairs, traced->pairs);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "npcWorld.h"
+#include "variantWorld.h"
+
+static_assert(defaultKills<ToadUnit, DragonUnit>());
+static_assert(defaultKills<KnightUnit, DragonUnit>());
+static_assert(!defaultKills<DragonUnit, ToadUnit>());
+static_assert(!defaultKills<KnightUnit, KnightUnit>());
+
+class VariantWorldTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        FightRules::install(defaultFightRules);
+    }
+
+    static void fillRandom(size_t count, unsigned seed, NpcWorld& world, VariantWorld& values) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            NpcType type = static_cast<NpcType>(rnd_type(gen));
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            std::string name = "npc_" + std::to_string(i);
+            world.add(type, name, x, y);
+            values.add(type, name, x, y);
+        }
+    }
+
+    class Recorder : public IFFightObserver {
+    public:
+        std::vector<std::string> events;
+        void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override {
+            events.push_back(std::string(attacker->getType()) + std::string(attacker->getName()) + ">" + std::string(defender->getType())
+                             + std::string(defender->getName()) + (success ? "+" : "-"));
+        }
+    };
+};
+
+TEST_F(VariantWorldTest, Accessors) {
+    VariantWorld world;
+    world.add(NpcType::Dragon, "D", 10, 20);
+    world.add(KnightUnit{PooledName("K"), 5, 6, true});
+
+    EXPECT_EQ(world.getType(0), NpcType::Dragon);
+    EXPECT_EQ(world.getName(0), "D");
+    EXPECT_EQ(world.getX(0), 10);
+    EXPECT_EQ(world.getY(1), 6);
+    EXPECT_TRUE(std::holds_alternative<KnightUnit>(world[1]));
+
+    world.kill(0);
+    EXPECT_FALSE(world.isAlive(0));
+    EXPECT_EQ(world.aliveCount(), 1u);
+    auto object = world.materialize(0);
+    EXPECT_EQ(object->getType(), "Dragon");
+    EXPECT_FALSE(object->isAlive());
+
+    world.removeDead();
+    ASSERT_EQ(world.size(), 1u);
+    EXPECT_EQ(world.getName(0), "K");
+
+    EXPECT_THROW(world.add(NpcType::Toad, "Out", 501, 0), std::runtime_error);
+    EXPECT_THROW(world.add(ToadUnit{PooledName("Out"), -1, 0, true}), std::runtime_error);
+}
+
+TEST_F(VariantWorldTest, MatchesNpcWorld) {
+    for (unsigned seed = 1; seed <= 3; ++seed) {
+        NpcWorld world;
+        VariantWorld values;
+        fillRandom(3000, seed, world, values);
+        for (size_t range : {20u, 35u, 50u}) {
+            EXPECT_EQ(fight(values, range), fight(world, range)) << "seed " << seed << ", range " << range;
+        }
+    }
+}
+
+TEST_F(VariantWorldTest, ObserverSeesSameFights) {
+    NpcWorld world;
+    VariantWorld values;
+    fillRandom(300, 5, world, values);
+    auto expected = std::make_shared<Recorder>();
+    auto actual = std::make_shared<Recorder>();
+    fight(world, 40, expected);
+    fight(values, 40, actual);
+    EXPECT_EQ(actual->events, expected->events);
+}
+
+TEST_F(VariantWorldTest, InstalledRulesAreUsed) {
+    FightRules rules;
+    rules.set(NpcType::Dragon, NpcType::Toad, FightOutcome::Win)
+         .set(NpcType::Knight, NpcType::Knight, FightOutcome::Win);
+    FightRules::install(rules);
+
+    NpcWorld world;
+    VariantWorld values;
+    fillRandom(2000, 9, world, values);
+    EXPECT_EQ(fight(values, 30), fight(world, 30));
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "world.h"
+#include "toad.h"
+#include "dragon.h"
+#include "knight.h"
+
+// порядок в set_t - порядок адресов; раздаем память по возрастанию,
+// чтобы два одинаково собранных мира обходились в одном порядке
+template <class T>
+struct BumpAllocator {
+    using value_type = T;
+
+    std::byte* buffer;
+    size_t* used;
+    size_t capacity;
+
+    BumpAllocator(std::byte* buffer, size_t* used, size_t capacity)
+        : buffer(buffer), used(used), capacity(capacity) {}
+    template <class U>
+    BumpAllocator(const BumpAllocator<U>& other)
+        : buffer(other.buffer), used(other.used), capacity(other.capacity) {}
+
+    T* allocate(size_t n) {
+        size_t offset = (*used + alignof(T) - 1) / alignof(T) * alignof(T);
+        *used = offset + n * sizeof(T);
+        if (*used > capacity) throw std::bad_alloc();
+        return reinterpret_cast<T*>(buffer + offset);
+    }
+    void deallocate(T*, size_t) {}
+
+    template <class U>
+    bool operator==(const BumpAllocator<U>& other) const { return buffer == other.buffer; }
+};
+
+class WorldTest : public ::testing::Test {
+protected:
+    struct Arena {
+        std::vector<std::byte> memory = std::vector<std::byte>(1 << 22);
+        size_t used = 0;
+    };
+
+    set_t makeWorld(Arena& arena, size_t count, unsigned seed) {
+        set_t world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        BumpAllocator<std::byte> alloc(arena.memory.data(), &arena.used, arena.memory.size());
+        for (size_t i = 0; i < count; ++i) {
+            int type = rnd_type(gen);
+            int x = rnd_coord(gen);
+            int y = rnd_coord(gen);
+            std::string name = "npc_" + std::to_string(i);
+            switch (type) {
+                case 0: world.insert(std::allocate_shared<Toad>(alloc, name, x, y)); break;
+                case 1: world.insert(std::allocate_shared<Dragon>(alloc, name, x, y)); break;
+                default: world.insert(std::allocate_shared<Knight>(alloc, name, x, y)); break;
+            }
+        }
+        return world;
+    }
+
+    static std::vector<std::string> names(const set_t& npcs) {
+        std::vector<std::string> result;
+        for (const auto& n : npcs) result.emplace_back(n->getName());
+        return result;
+    }
+
+    class CountingObserver : public IFFightObserver {
+    public:
+        std::vector<std::string> events;
+        void onFight(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender, bool success) override {
+            events.push_back(std::string(attacker->getName()) + ">" + std::string(defender->getName()) + (success ? "+" : "-"));
+        }
+    };
+};
+
+TEST_F(WorldTest, GridFightMatchesBruteForce) {
+    std::ostringstream sink;
+    std::streambuf* old_cout = std::cout.rdbuf(sink.rdbuf());
+    for (size_t range : {0u, 5u, 20u, 35u, 95u, 800u}) {
+        Arena arenaA, arenaB;
+        set_t a = makeWorld(arenaA, 400, 11);
+        set_t b = makeWorld(arenaB, 400, 11);
+        ASSERT_EQ(names(a), names(b));
+
+        auto observerA = std::make_shared<CountingObserver>();
+        auto observerB = std::make_shared<CountingObserver>();
+        set_t killedA = fight(a, range, observerA);
+        set_t killedB = fightBruteForce(b, range, observerB);
+
+        EXPECT_EQ(names(killedA), names(killedB)) << "range " << range;
+        EXPECT_EQ(observerA->events, observerB->events) << "range " << range;
+    }
+    std::cout.rdbuf(old_cout);
+}
+
+TEST_F(WorldTest, FightKillsInRangeOnly) {
+    std::ostringstream sink;
+    std::streambuf* old_cout = std::cout.rdbuf(sink.rdbuf());
+    set_t world;
+    auto toad = std::make_shared<Toad>("T", 0, 0);
+    auto near = std::make_shared<Knight>("Near", 3, 4);
+    auto far = std::make_shared<Dragon>("Far", 300, 300);
+    world.insert(toad);
+    world.insert(near);
+    world.insert(far);
+
+    set_t killed = fight(world, 5);
+    std::cout.rdbuf(old_cout);
+
+    EXPECT_EQ(killed.size(), 1u);
+    EXPECT_TRUE(killed.count(near));
+    EXPECT_TRUE(toad->isAlive());
+    EXPECT_TRUE(far->isAlive());
+}
+
+TEST_F(WorldTest, FightEmptyWorld) {
+    set_t world;
+    EXPECT_TRUE(fight(world, 20).empty());
+}
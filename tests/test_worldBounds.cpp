@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "battle.h"
+#include "npc.h"
+#include "npcWorld.h"
+#include "rangeKernel.h"
+#include "rangeSweep.h"
+#include "spatialGrid.h"
+#include "toad.h"
+#include "variantWorld.h"
+#include "world.h"
+#include "worldBounds.h"
+
+class WorldBoundsTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        WorldBounds::install(defaultWorldBounds);
+    }
+
+    class CountingObserver : public IFFightObserver {
+    public:
+        size_t events = 0;
+        void onFight(const std::shared_ptr<NPC>&, const std::shared_ptr<NPC>&, bool) override { ++events; }
+    };
+};
+
+TEST_F(WorldBoundsTest, DefaultIsClassicMap) {
+    EXPECT_EQ(WorldBounds::current(), defaultWorldBounds);
+    EXPECT_EQ(defaultWorldBounds.describe(), "0-500");
+    EXPECT_TRUE(defaultWorldBounds.contains(500, 0));
+    EXPECT_FALSE(defaultWorldBounds.contains(501, 0));
+    EXPECT_EQ(WorldBounds({-5, 0, 5, 10}).describe(), "x -5-5, y 0-10");
+}
+
+TEST_F(WorldBoundsTest, InstallChangesNpcCheck) {
+    EXPECT_THROW(Toad("Far", 100000, 5), std::runtime_error);
+    WorldBounds::install({-1000000, -1000000, 1000000, 1000000});
+    Toad far("Far", 100000, -5);
+    EXPECT_EQ(far.getX(), 100000);
+    EXPECT_THROW(WorldBounds::install({10, 0, 5, 5}), std::runtime_error);
+}
+
+TEST_F(WorldBoundsTest, DistanceDoesNotOverflow) {
+    WorldBounds::install({std::numeric_limits<int>::min(), 0, std::numeric_limits<int>::max(), 0});
+    auto west = std::make_shared<Toad>("West", std::numeric_limits<int>::min(), 0);
+    auto east = std::make_shared<Toad>("East", std::numeric_limits<int>::max(), 0);
+    EXPECT_DOUBLE_EQ(west->distance(east), 4294967295.0);
+}
+
+TEST_F(WorldBoundsTest, WorldKeepsOwnBounds) {
+    NpcWorld world(WorldBounds{-100000, -100000, 100000, 100000});
+    world.add(NpcType::Toad, "A", -100000, 100000);
+    EXPECT_THROW(world.add(NpcType::Toad, "B", 100001, 0), std::runtime_error);
+    EXPECT_THROW(world.move(0, 0, -100001), std::runtime_error);
+    // сужать можно, только если все остаются внутри
+    EXPECT_THROW(world.setBounds(defaultWorldBounds), std::runtime_error);
+    world.move(0, 7, 8);
+    world.setBounds(defaultWorldBounds);
+    EXPECT_EQ(world.getBounds(), defaultWorldBounds);
+    world.clear();
+    EXPECT_EQ(world.getBounds(), defaultWorldBounds);
+}
+
+// объекты для наблюдателя строятся по границам мира, а не по WorldBounds::current()
+TEST_F(WorldBoundsTest, ObservedFightOnOwnBounds) {
+    const WorldBounds wide{-1000, -1000, 1000, 1000};
+    NpcWorld world(wide);
+    world.add(NpcType::Knight, "K", -1000, 1000);
+    world.add(NpcType::Dragon, "D", -995, 1000);
+    world.add(NpcType::Toad, "T", 900, -900);
+
+    auto log = std::make_shared<CountingObserver>();
+    NpcWorld sequential = world;
+    EXPECT_EQ(fight(sequential, 10, log).size(), 1u);
+    EXPECT_EQ(log->events, 1u);
+    NpcWorld parallel = world;
+    EXPECT_FALSE(Battle(BattleOptions{BattleMode::Parallel, 2, 1}).round(parallel, 10, log).empty());
+
+    set_t npcs = world.toSet();
+    ASSERT_EQ(npcs.size(), 3u);
+    EXPECT_EQ(world.materialize(0)->getX(), -1000);
+
+    VariantWorld values(wide);
+    values.add(NpcType::Knight, "K", -1000, 1000);
+    values.add(NpcType::Dragon, "D", -995, 1000);
+    EXPECT_THROW(values.add(NpcType::Toad, "far", 1001, 0), std::runtime_error);
+    EXPECT_EQ(fight(values, 10, log).size(), 1u);
+    EXPECT_EQ(values.toSet().size(), 2u);
+}
+
+TEST_F(WorldBoundsTest, FightOnHugeSparseMap) {
+    const int far = 1000000000;
+    NpcWorld world(WorldBounds{-far, -far, far, far});
+    world.add(NpcType::Knight, "K", -far, -far);
+    world.add(NpcType::Dragon, "D", -far + 30, -far + 40);  // ровно 50
+    world.add(NpcType::Knight, "K2", far, far);
+    world.add(NpcType::Dragon, "D2", far - 51, far);          // на 51 - вне радиуса
+    auto killed = fight(world, 50);
+    ASSERT_EQ(killed.size(), 1u);
+    EXPECT_EQ(killed[0], 1u);
+    EXPECT_TRUE(world.isAlive(3));
+}
+
+// радиус больше 2^24 - бои на дальних дистанциях не теряются
+TEST_F(WorldBoundsTest, FightBeyondSixteenMillion) {
+    const int far = 1000000000;
+    const WorldBounds huge{-far, -far, far, far};
+    NpcWorld world(huge);
+    world.add(NpcType::Knight, "K", -far, 0);
+    world.add(NpcType::Dragon, "D", -far + 20000000, 0);
+    world.add(NpcType::Knight, "K2", far - 40000000, 0);
+    world.add(NpcType::Dragon, "D2", far, 0);          // 40M - вне радиуса 30M
+    NpcWorld copy = world;
+    auto killed = fight(world, 30000000);
+    EXPECT_EQ(killed, (std::vector<size_t>{1}));
+
+    RangeSweepResult sweep = RangeSweep::run(copy, {30000000, 40000000});
+    EXPECT_EQ(sweep.killed[0], (std::vector<size_t>{1}));
+    EXPECT_EQ(sweep.killed[1], (std::vector<size_t>{3}));
+
+    WorldBounds::install(huge);
+    set_t npcs = copy.toSet();
+    set_t dead = fight(npcs, 30000000);
+    // кто ударит первым, зависит от порядка множества, но бьется только ближняя пара
+    ASSERT_EQ(dead.size(), 1u);
+    std::string_view victim = (*dead.begin())->getName();
+    EXPECT_TRUE(victim == "K" || victim == "D") << victim;
+
+    // радиус больше WIDE_RANGE_LIMIT: точные дальние пары, как у fightBruteForce
+    const int edge = 2000000000;
+    const WorldBounds full{-edge, -edge, edge, edge};
+    WorldBounds::install(full);
+    NpcWorld line(full);
+    line.add(NpcType::Knight, "K", -edge, 0);
+    line.add(NpcType::Dragon, "D", edge, 0);                // 4e9
+    line.add(NpcType::Knight, "K3", -edge, -edge);
+    line.add(NpcType::Dragon, "D3", edge, edge);             // 4e9 * sqrt(2) ~ 5.66e9
+    const size_t ranges[] = {3000000000, 4200000000, 5000000000, 5700000000, 7000000000};
+    for (size_t range : ranges) {
+        NpcWorld round = line;
+        std::vector<size_t> grid = fight(round, range);
+        std::sort(grid.begin(), grid.end());
+        set_t brute = fightBruteForce(line.toSet(), range);
+        EXPECT_EQ(grid.size(), brute.size()) << range;
+        EXPECT_EQ(fight(line.toSet(), range).size(), brute.size()) << range;
+        RangeSweepResult sweep = RangeSweep::run(line, {1000, range});
+        EXPECT_EQ(sweep.killed[1], grid) << range;
+    }
+    // K-D 4e9, K3-D и D3-K ~4.47e9, K3-D3 ~5.66e9
+    NpcWorld none = line;
+    EXPECT_TRUE(fight(none, 3000000000).empty());
+    NpcWorld one = line;
+    EXPECT_EQ(fight(one, 4200000000), (std::vector<size_t>{1}));
+    NpcWorld all = line;
+    EXPECT_EQ(fight(all, 7000000000).size(), 2u);
+}
+
+TEST_F(WorldBoundsTest, GridRangeUpToWideLimit) {
+    const int far = 1000000000;
+    std::vector<int> xs{-far, far, far};
+    std::vector<int> ys{0, 0, -far};
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), xs.size(), 1000);
+    std::vector<uint32_t> found;
+    grid.forEachInRange(-far, 0, static_cast<size_t>(WIDE_RANGE_LIMIT), [&](uint32_t i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    // (far, -far) дальше 2^31 - 2, (far, 0) ровно в 2e9
+    EXPECT_EQ(found, (std::vector<uint32_t>{0, 1}));
+    // за пределом - точное сравнение в 128 битах: (far, -far) в ~2.236e9
+    for (size_t range : {size_t{2230000000}, size_t{2240000000}, std::numeric_limits<size_t>::max()}) {
+        found.clear();
+        grid.forEachInRange(-far, 0, range, [&](uint32_t i) { found.push_back(i); });
+        EXPECT_EQ(found.size(), range < 2240000000 ? 2u : 3u) << range;
+    }
+}
+
+TEST_F(WorldBoundsTest, GridFindsNeighboursAcrossWideMap) {
+    const int far = 2000000000;
+    std::vector<int> xs{-far, -far + 3, 0, far - 4, far};
+    std::vector<int> ys{0, 4, 0, 3, 0};
+    SpatialGrid grid;
+    grid.build(xs.data(), ys.data(), xs.size(), 5);
+    std::vector<uint32_t> found;
+    grid.forEachInRange(far, 0, 5, [&](uint32_t i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, (std::vector<uint32_t>{3, 4}));
+    found.clear();
+    grid.forEachInRange(-far, 0, 5, [&](uint32_t i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, (std::vector<uint32_t>{0, 1}));
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "worldFile.h"
+
+class WorldFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        world.add(NpcType::Toad, "Toad_1", 10, 20);
+        world.add(NpcType::Dragon, "Dragon_with_a_long_name", 300, 400);
+        world.add(NpcType::Knight, "K", 500, 0);
+        world.add(NpcType::Toad, "", 0, 500);
+        world.kill(1);
+    }
+
+    void TearDown() override {
+        std::remove(filename.c_str());
+        std::remove("test_world_text.txt");
+    }
+
+    void writeRaw(const std::string& bytes) {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::string readRaw() {
+        std::ifstream file(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    NpcWorld world;
+    const std::string filename = "test_world.bin";
+};
+
+TEST_F(WorldFileTest, RoundTrip) {
+    WorldFile::saveBinary(world, filename);
+    EXPECT_TRUE(WorldFile::isBinary(filename));
+
+    NpcWorld loaded = WorldFile::loadBinary(filename);
+    ASSERT_EQ(loaded.size(), world.size());
+    for (size_t i = 0; i < world.size(); ++i) {
+        EXPECT_EQ(loaded.getType(i), world.getType(i));
+        EXPECT_EQ(loaded.getName(i), world.getName(i));
+        EXPECT_EQ(loaded.getX(i), world.getX(i));
+        EXPECT_EQ(loaded.getY(i), world.getY(i));
+        EXPECT_EQ(loaded.isAlive(i), world.isAlive(i));
+    }
+}
+
+TEST_F(WorldFileTest, EmptyWorld) {
+    WorldFile::saveBinary(NpcWorld(), filename);
+    EXPECT_TRUE(WorldFile::loadBinary(filename).empty());
+}
+
+TEST_F(WorldFileTest, FixedLayout) {
+    WorldFile::saveBinary(world, filename);
+    std::string bytes = readRaw();
+    size_t names = 6 + 23 + 1 + 0;
+    EXPECT_EQ(bytes.size(), sizeof(WorldFileHeader) + sizeof(WorldFileBounds) + world.size() * sizeof(WorldFileRecord) + names);
+    EXPECT_EQ(bytes.substr(0, 4), "DNGW");
+    EXPECT_EQ(bytes.substr(bytes.size() - names), "Toad_1Dragon_with_a_long_nameK");
+}
+
+TEST_F(WorldFileTest, TextFileIsNotBinary) {
+    std::ofstream text("test_world_text.txt");
+    text << "Toad T 1 2\n";
+    text.close();
+    EXPECT_FALSE(WorldFile::isBinary("test_world_text.txt"));
+    EXPECT_THROW(WorldFile::loadBinary("test_world_text.txt"), std::runtime_error);
+}
+
+TEST_F(WorldFileTest, RejectsDamagedFiles) {
+    WorldFile::saveBinary(world, filename);
+    std::string good = readRaw();
+
+    writeRaw(good.substr(0, good.size() - 1));
+    EXPECT_THROW(WorldFile::loadBinary(filename), std::runtime_error);
+
+    writeRaw(good.substr(0, 10));
+    EXPECT_THROW(WorldFile::loadBinary(filename), std::runtime_error);
+
+    std::string badVersion = good;
+    badVersion[4] = 99;
+    writeRaw(badVersion);
+    EXPECT_THROW(WorldFile::loadBinary(filename), std::runtime_error);
+
+    std::string badType = good;
+    badType[sizeof(WorldFileHeader) + sizeof(WorldFileBounds)] = 7;
+    writeRaw(badType);
+    EXPECT_THROW(WorldFile::loadBinary(filename), std::runtime_error);
+
+    std::string badCoordinate = good;
+    badCoordinate[sizeof(WorldFileHeader) + sizeof(WorldFileBounds) + 5] = 0x7f;  // x далеко за 500
+    writeRaw(badCoordinate);
+    EXPECT_THROW(WorldFile::loadBinary(filename), std::runtime_error);
+
+    std::string badBounds = good;
+    badBounds.replace(sizeof(WorldFileHeader) + 8, 4, 4, '\xff');  // maxX = -1 < minX
+    writeRaw(badBounds);
+    EXPECT_THROW(WorldFile::loadBinary(filename), std::runtime_error);
+
+    EXPECT_THROW(WorldFile::loadBinary("no_such_world.bin"), std::runtime_error);
+}
+
+TEST_F(WorldFileTest, KeepsBounds) {
+    NpcWorld wide(WorldBounds{-1000000, -5, 2000000, 70000});
+    wide.add(NpcType::Toad, "West", -1000000, -5);
+    wide.add(NpcType::Knight, "East", 2000000, 70000);
+    WorldFile::saveBinary(wide, filename);
+    NpcWorld loaded = WorldFile::loadBinary(filename);
+    EXPECT_EQ(loaded.getBounds(), wide.getBounds());
+    EXPECT_EQ(loaded.getX(0), -1000000);
+    EXPECT_EQ(loaded.getY(1), 70000);
+}
+
+TEST_F(WorldFileTest, ReadsVersion1) {
+    WorldFile::saveBinary(world, filename);
+    std::string v2 = readRaw();
+    // версия 1 - тот же файл без блока границ
+    std::string v1 = v2.substr(0, sizeof(WorldFileHeader)) + v2.substr(sizeof(WorldFileHeader) + sizeof(WorldFileBounds));
+    v1[4] = 1;
+    writeRaw(v1);
+    NpcWorld loaded = WorldFile::loadBinary(filename);
+    EXPECT_EQ(loaded.getBounds(), defaultWorldBounds);
+    ASSERT_EQ(loaded.size(), world.size());
+    EXPECT_EQ(loaded.getName(1), world.getName(1));
+}
+
+TEST_F(WorldFileTest, TextBoundsLine) {
+    NpcWorld wide(WorldBounds{-100, -100, 100000, 100000});
+    wide.add(NpcType::Toad, "Far", 99999, -100);
+    saveNPC(wide, "test_world_text.txt");
+    NpcWorld loaded;
+    ASSERT_TRUE(WorldFile::loadText("test_world_text.txt", loaded));
+    EXPECT_EQ(loaded.getBounds(), wide.getBounds());
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded.getX(0), 99999);
+
+    ThreadPool pool(2);
+    NpcWorld parallel;
+    ASSERT_TRUE(WorldFile::loadTextParallel("test_world_text.txt", parallel, pool, nullptr, 4));
+    EXPECT_EQ(parallel.getBounds(), wide.getBounds());
+    EXPECT_EQ(parallel.size(), 1u);
+
+    // непустой мир на карте по умолчанию такие координаты не примет
+    NpcWorld small;
+    small.add(NpcType::Toad, "Home", 1, 1);
+    EXPECT_THROW(WorldFile::loadText("test_world_text.txt", small), std::runtime_error);
+
+    // файл на карте по умолчанию строки #bounds не содержит
+    saveNPC(world, "test_world_text.txt");
+    std::ifstream text("test_world_text.txt");
+    std::string first;
+    std::getline(text, first);
+    EXPECT_NE(first.rfind("#bounds", 0), 0u);
+}
+
+
+TEST_F(WorldFileTest, LoadTextSkipsBadLinesLikeLoadNPC) {
+    std::ofstream text("test_world_text.txt", std::ios::binary);
+    text << "Toad ValidToad1 10 20\n"
+         << "InvalidType WrongNPC 30 40\n"
+         << "Dragon ValidDragon1 50 60\r\n"
+         << "Knight OnlyName\n"
+         << "\n"
+         << "Knight ValidKnight1 90 100";   // без перевода строки в конце
+    text.close();
+
+    NpcWorld loaded;
+    ASSERT_TRUE(WorldFile::loadText("test_world_text.txt", loaded));
+    ASSERT_EQ(loaded.size(), 3u);
+    EXPECT_EQ(loaded.getName(0), "ValidToad1");
+    EXPECT_EQ(loaded.getName(1), "ValidDragon1");
+    EXPECT_EQ(loaded.getY(1), 60);
+    EXPECT_EQ(loaded.getName(2), "ValidKnight1");
+    EXPECT_EQ(loaded.getY(2), 100);
+
+    size_t lines = 0;
+    ASSERT_TRUE(WorldFile::scanText("test_world_text.txt", [&](NpcType, std::string_view, int, int) { ++lines; }));
+    EXPECT_EQ(lines, 3u);
+}
+
+TEST_F(WorldFileTest, LoadTextMissingAndEmptyFiles) {
+    NpcWorld loaded;
+    EXPECT_FALSE(WorldFile::loadText("no_such_world.txt", loaded));
+
+    std::ofstream("test_world_text.txt").close();
+    EXPECT_TRUE(WorldFile::loadText("test_world_text.txt", loaded));
+    EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(WorldFileTest, LoadTextRejectsOutOfMapCoordinates) {
+    std::ofstream text("test_world_text.txt");
+    text << "Toad T 10 20\nKnight K 600 300\n";
+    text.close();
+
+    NpcWorld loaded;
+    EXPECT_THROW(WorldFile::loadText("test_world_text.txt", loaded), std::runtime_error);
+}
+
+TEST_F(WorldFileTest, ParallelLoadMatchesSequential) {
+    std::ofstream text("test_world_text.txt", std::ios::binary);
+    for (int i = 0; i < 500; ++i) {
+        switch (i % 7) {
+            case 3: text << "Goblin G" << i << " 1 2\n"; break;
+            case 5: text << "Knight K" << i << "\r\n"; break;
+            default: text << npcTypeName(static_cast<NpcType>(i % 3)) << " N" << i << ' ' << i % 501 << ' ' << (i * 7) % 501 << '\n';
+        }
+    }
+    text << "Toad Last 1 1";
+    text.close();
+
+    NpcWorld sequential;
+    TextLoadStats sequentialStats;
+    ASSERT_TRUE(WorldFile::loadText("test_world_text.txt", sequential, &sequentialStats));
+
+    ThreadPool pool(4);
+    for (size_t chunkBytes : {size_t{1}, size_t{7}, size_t{100}, size_t{1} << 20}) {
+        NpcWorld parallel;
+        parallel.add(NpcType::Dragon, "Existing", 0, 0);
+        TextLoadStats stats;
+        ASSERT_TRUE(WorldFile::loadTextParallel("test_world_text.txt", parallel, pool, &stats, chunkBytes));
+
+        ASSERT_EQ(parallel.size(), sequential.size() + 1) << chunkBytes;
+        EXPECT_EQ(parallel.getName(0), "Existing");
+        for (size_t i = 0; i < sequential.size(); ++i) {
+            EXPECT_EQ(parallel.getName(i + 1), sequential.getName(i));
+            EXPECT_EQ(parallel.getType(i + 1), sequential.getType(i));
+            EXPECT_EQ(parallel.getX(i + 1), sequential.getX(i));
+            EXPECT_EQ(parallel.getY(i + 1), sequential.getY(i));
+        }
+        EXPECT_EQ(stats.lines, 501u);
+        EXPECT_EQ(stats.loaded, sequentialStats.loaded);
+        EXPECT_EQ(stats.skipped, sequentialStats.skipped);
+        EXPECT_EQ(stats.bytes, sequentialStats.bytes);
+    }
+    EXPECT_EQ(sequentialStats.skipped, 142u);
+}
+
+TEST_F(WorldFileTest, ParallelLoadStopsAtBadCoordinates) {
+    std::ofstream text("test_world_text.txt");
+    for (int i = 0; i < 100; ++i) text << "Toad T" << i << " 1 1\n";
+    text << "Knight Bad 600 1\n";
+    for (int i = 0; i < 100; ++i) text << "Toad After" << i << " 1 1\n";
+    text.close();
+
+    ThreadPool pool(3);
+    NpcWorld loaded;
+    EXPECT_THROW(WorldFile::loadTextParallel("test_world_text.txt", loaded, pool, nullptr, 64), std::runtime_error);
+    ASSERT_EQ(loaded.size(), 100u);
+    EXPECT_EQ(loaded.getName(99), "T99");
+
+    NpcWorld missing;
+    EXPECT_FALSE(WorldFile::loadTextParallel("no_such_world.txt", missing, pool));
+}
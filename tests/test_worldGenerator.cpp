@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "npcWorld.h"
+#include "worldFile.h"
+#include "worldGenerator.h"
+
+class WorldGeneratorTest : public ::testing::Test {
+protected:
+    std::string tempFile = "test_generated_world.txt";
+
+    void TearDown() override {
+        std::remove(tempFile.c_str());
+    }
+
+    static WorldGeneratorOptions options(size_t count, size_t threads, size_t chunkSize) {
+        WorldGeneratorOptions o;
+        o.count = count;
+        o.seed = 42;
+        o.threads = threads;
+        o.chunkSize = chunkSize;
+        return o;
+    }
+
+    static void expectSame(const NpcWorld& actual, const NpcWorld& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        EXPECT_EQ(actual.getBounds(), expected.getBounds());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_EQ(actual.getX(i), expected.getX(i)) << i;
+            ASSERT_EQ(actual.getY(i), expected.getY(i)) << i;
+            ASSERT_EQ(actual.getType(i), expected.getType(i)) << i;
+            ASSERT_EQ(actual.getName(i), expected.getName(i)) << i;
+            ASSERT_EQ(actual.isAlive(i), expected.isAlive(i)) << i;
+        }
+    }
+};
+
+TEST_F(WorldGeneratorTest, SameSeedSameWorldForAnyThreads) {
+    NpcWorld one = WorldGenerator(options(10000, 1, 10000)).generate();
+    NpcWorld many = WorldGenerator(options(10000, 4, 333)).generate();
+    expectSame(many, one);
+
+    WorldGeneratorOptions other = options(10000, 1, 10000);
+    other.seed = 43;
+    NpcWorld different = WorldGenerator(other).generate();
+    size_t same = 0;
+    for (size_t i = 0; i < one.size(); ++i) {
+        if (one.getX(i) == different.getX(i) && one.getY(i) == different.getY(i)) ++same;
+    }
+    EXPECT_LT(same, 100u);
+}
+
+TEST_F(WorldGeneratorTest, MatchesNpcAt) {
+    WorldGenerator generator(options(1000, 2, 64));
+    NpcWorld world = generator.generate();
+    ASSERT_EQ(world.size(), 1000u);
+    EXPECT_EQ(world.aliveCount(), 1000u);
+    for (size_t i = 0; i < world.size(); ++i) {
+        NpcType type;
+        int x, y;
+        generator.npcAt(i, type, x, y);
+        EXPECT_EQ(world.getType(i), type);
+        EXPECT_EQ(world.getX(i), x);
+        EXPECT_EQ(world.getY(i), y);
+        EXPECT_EQ(world.getName(i), generateName(npcTypeName(type), static_cast<int>(i)));
+    }
+}
+
+TEST_F(WorldGeneratorTest, FollowsTypeWeights) {
+    WorldGeneratorOptions o = options(30000, 2, 1000);
+    o.typeWeights = {1, 0, 2};
+    NpcWorld world = WorldGenerator(o).generate();
+    std::array<size_t, NPC_TYPE_COUNT> counts{};
+    for (size_t i = 0; i < world.size(); ++i) ++counts[static_cast<size_t>(world.getType(i))];
+    EXPECT_EQ(counts[static_cast<size_t>(NpcType::Dragon)], 0u);
+    EXPECT_NEAR(static_cast<double>(counts[static_cast<size_t>(NpcType::Toad)]), 10000.0, 500.0);
+    EXPECT_NEAR(static_cast<double>(counts[static_cast<size_t>(NpcType::Knight)]), 20000.0, 500.0);
+}
+
+TEST_F(WorldGeneratorTest, LayoutsStayInBounds) {
+    const WorldBounds bounds{-2147483647 - 1, -1000, 2147483647, 1000};
+    for (SpawnLayout layout : {SpawnLayout::Uniform, SpawnLayout::Clustered, SpawnLayout::SingleCell}) {
+        WorldGeneratorOptions o = options(5000, 2, 512);
+        o.bounds = bounds;
+        o.layout = layout;
+        o.clusters = 4;
+        o.clusterRadius = 2000;
+        NpcWorld world = WorldGenerator(o).generate();
+        EXPECT_EQ(world.getBounds(), bounds);
+        for (size_t i = 0; i < world.size(); ++i) {
+            ASSERT_TRUE(bounds.contains(world.getX(i), world.getY(i))) << i;
+        }
+    }
+}
+
+// кучки у края int32 прижимаются к краю, а не переходят через переполнение на другой
+TEST_F(WorldGeneratorTest, ClustersClampAtInt32Edge) {
+    const int top = std::numeric_limits<int>::max();
+    const int bottom = std::numeric_limits<int>::min();
+    WorldGeneratorOptions o = options(3000, 1, 3000);
+    o.bounds = WorldBounds{top - 100, bottom, top, bottom + 100};
+    o.layout = SpawnLayout::Clustered;
+    o.clusters = 2;
+    o.clusterRadius = 1000;
+    NpcWorld world = WorldGenerator(o).generate();
+    size_t atMaxX = 0, atMinY = 0;
+    for (size_t i = 0; i < world.size(); ++i) {
+        ASSERT_TRUE(o.bounds.contains(world.getX(i), world.getY(i))) << world.getX(i) << " " << world.getY(i);
+        atMaxX += world.getX(i) == top;
+        atMinY += world.getY(i) == bottom;
+    }
+    // центр не дальше 100 от края, так что почти половина кучки за краем
+    EXPECT_GT(atMaxX, world.size() / 4);
+    EXPECT_GT(atMinY, world.size() / 4);
+}
+
+TEST_F(WorldGeneratorTest, SingleCellPacksEveryone) {
+    WorldGeneratorOptions o = options(2000, 1, 2000);
+    o.layout = SpawnLayout::SingleCell;
+    o.cellSize = 10;
+    NpcWorld world = WorldGenerator(o).generate();
+    for (size_t i = 0; i < world.size(); ++i) {
+        ASSERT_GE(world.getX(i), 245);
+        ASSERT_LE(world.getX(i), 254);
+        ASSERT_GE(world.getY(i), 245);
+        ASSERT_LE(world.getY(i), 254);
+    }
+}
+
+TEST_F(WorldGeneratorTest, ClustersAreTight) {
+    WorldGeneratorOptions o = options(4000, 1, 4000);
+    o.layout = SpawnLayout::Clustered;
+    o.clusters = 1;
+    o.clusterRadius = 5;
+    NpcWorld world = WorldGenerator(o).generate();
+    int minX = world.getX(0), maxX = minX;
+    for (size_t i = 0; i < world.size(); ++i) {
+        minX = std::min(minX, world.getX(i));
+        maxX = std::max(maxX, world.getX(i));
+    }
+    EXPECT_LE(maxX - minX, 10);
+}
+
+TEST_F(WorldGeneratorTest, AppendsToExistingWorld) {
+    NpcWorld world;
+    world.add(NpcType::Toad, "first", 1, 1);
+    WorldGenerator generator(options(100, 1, 30));
+    generator.generate(world);
+    ASSERT_EQ(world.size(), 101u);
+    EXPECT_EQ(world.getName(0), "first");
+    NpcWorld alone = generator.generate();
+    for (size_t i = 0; i < alone.size(); ++i) {
+        EXPECT_EQ(world.getX(i + 1), alone.getX(i));
+        // имена нумеруются по индексу в мире - второй generate не повторяет их
+        EXPECT_EQ(world.getName(i + 1), generateName(npcTypeName(alone.getType(i)), static_cast<int>(i + 1)));
+    }
+    generator.generate(world);
+    EXPECT_EQ(world.getName(101), generateName(npcTypeName(world.getType(101)), 101));
+
+    WorldGeneratorOptions wide = options(10, 1, 10);
+    wide.bounds = WorldBounds{0, 0, 5000, 5000};
+    EXPECT_THROW(WorldGenerator(wide).generate(world), std::runtime_error);
+    EXPECT_EQ(world.size(), 201u);
+}
+
+TEST_F(WorldGeneratorTest, FileLoadsAsSameWorld) {
+    WorldGeneratorOptions o = options(5000, 3, 700);
+    o.bounds = WorldBounds{-100, -100, 100000, 100000};
+    WorldGenerator generator(o);
+    generator.generateToFile(tempFile);
+    NpcWorld loaded;
+    ASSERT_TRUE(WorldFile::loadText(tempFile, loaded));
+    expectSame(loaded, generator.generate());
+}
+
+TEST_F(WorldGeneratorTest, RejectsBadOptions) {
+    WorldGeneratorOptions noTypes;
+    noTypes.typeWeights = {0, 0, 0};
+    EXPECT_THROW(WorldGenerator{noTypes}, std::runtime_error);
+    WorldGeneratorOptions badBounds;
+    badBounds.bounds = WorldBounds{10, 0, 0, 10};
+    EXPECT_THROW(WorldGenerator{badBounds}, std::runtime_error);
+    WorldGeneratorOptions badCell;
+    badCell.cellSize = 0;
+    EXPECT_THROW(WorldGenerator{badCell}, std::runtime_error);
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "worldFile.h"
+#include "worldJournal.h"
+
+class WorldJournalTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove(filename.c_str());
+        std::remove((filename + ".journal").c_str());
+        std::remove((filename + ".tmp").c_str());
+    }
+
+    static void expectSameWorld(const NpcWorld& actual, const NpcWorld& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual.getType(i), expected.getType(i));
+            EXPECT_EQ(actual.getName(i), expected.getName(i));
+            EXPECT_EQ(actual.getX(i), expected.getX(i));
+            EXPECT_EQ(actual.getY(i), expected.getY(i));
+            EXPECT_EQ(actual.isAlive(i), expected.isAlive(i));
+        }
+        EXPECT_EQ(WorldJournal::fingerprint(actual), WorldJournal::fingerprint(expected));
+    }
+
+    // создание через журнал и в памяти одновременно
+    static void create(NpcWorld& world, WorldJournal& journal, NpcType type, const std::string& name, int x, int y) {
+        world.add(type, name, x, y);
+        journal.create(type, name, x, y);
+    }
+
+    std::string readJournal() {
+        std::ifstream file(filename + ".journal", std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void writeJournal(const std::string& bytes) {
+        std::ofstream file(filename + ".journal", std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    const std::string filename = "test_journal_world.bin";
+};
+
+TEST_F(WorldJournalTest, ReplaysAllOperations) {
+    NpcWorld world;
+    {
+        WorldJournal journal(filename);
+        JournalRecovery recovery = journal.open(world);
+        EXPECT_EQ(recovery.snapshotNpcs, 0u);
+        EXPECT_EQ(recovery.replayed, 0u);
+
+        create(world, journal, NpcType::Toad, "Toad_1", 10, 20);
+        create(world, journal, NpcType::Dragon, "Dragon_with_a_long_name", 300, 400);
+        create(world, journal, NpcType::Knight, "", 500, 0);
+        journal.commit();
+
+        world.move(0, 11, 21);
+        journal.move(0, 11, 21);
+        world.kill(1);
+        journal.kill(1);
+        journal.commit();
+
+        world.removeDead();
+        journal.purge();
+        create(world, journal, NpcType::Toad, "Late", 0, 500);
+        world.kill(0);
+        journal.kill(std::vector<size_t>{0});
+        journal.commit(true);
+        EXPECT_EQ(journal.pendingBytes(), 0u);
+    }
+
+    NpcWorld recovered;
+    WorldJournal journal(filename);
+    JournalRecovery recovery = journal.open(recovered);
+    EXPECT_EQ(recovery.replayed, 8u);
+    EXPECT_EQ(recovery.discardedBytes, 0u);
+    EXPECT_FALSE(recovery.staleJournal);
+    expectSameWorld(recovered, world);
+}
+
+TEST_F(WorldJournalTest, SaveCostFollowsChangeSize) {
+    NpcWorld world;
+    std::mt19937 gen(3);
+    for (int i = 0; i < 10000; ++i) {
+        world.add(static_cast<NpcType>(i % 3), "npc_" + std::to_string(i), gen() % 501, gen() % 501);
+    }
+    WorldJournal journal(filename);
+    journal.compact(world);
+    const size_t snapshotBytes = std::filesystem::file_size(filename);
+    const size_t emptyJournal = journal.journalBytes();
+    EXPECT_EQ(emptyJournal, sizeof(JournalHeader));
+
+    for (size_t i : {17u, 4242u, 9999u}) {
+        world.kill(i);
+        journal.kill(i);
+    }
+    journal.commit();
+
+    // три убитых - три записи, а не весь мир заново
+    EXPECT_EQ(journal.journalBytes() - emptyJournal, 3 * (sizeof(JournalRecord) + sizeof(uint32_t)));
+    EXPECT_LT(journal.journalBytes() * 1000, snapshotBytes);
+
+    NpcWorld recovered;
+    WorldJournal reopened(filename);
+    JournalRecovery recovery = reopened.open(recovered);
+    EXPECT_EQ(recovery.snapshotNpcs, 10000u);
+    EXPECT_EQ(recovery.replayed, 3u);
+    expectSameWorld(recovered, world);
+}
+
+TEST_F(WorldJournalTest, DropsTornTail) {
+    NpcWorld world;
+    WorldJournal journal(filename);
+    journal.open(world);
+    create(world, journal, NpcType::Toad, "A", 1, 1);
+    create(world, journal, NpcType::Knight, "B", 2, 2);
+    journal.commit();
+    NpcWorld beforeCrash = world;
+
+    create(world, journal, NpcType::Dragon, "Torn", 3, 3);
+    journal.commit();
+    // сбой посреди записи последнего Create
+    std::string bytes = readJournal();
+    writeJournal(bytes.substr(0, bytes.size() - 5));
+
+    NpcWorld recovered;
+    WorldJournal reopened(filename);
+    JournalRecovery recovery = reopened.open(recovered);
+    EXPECT_EQ(recovery.replayed, 2u);
+    EXPECT_EQ(recovery.discardedBytes, sizeof(JournalRecord) + 4 + sizeof(uint32_t) - 5);
+    expectSameWorld(recovered, beforeCrash);
+
+    // хвост обрезан, новые записи ложатся сразу за целыми
+    EXPECT_EQ(readJournal().size(), reopened.journalBytes());
+    recovered.kill(0);
+    reopened.kill(0);
+    reopened.commit();
+
+    NpcWorld again;
+    WorldJournal third(filename);
+    EXPECT_EQ(third.open(again).replayed, 3u);
+    expectSameWorld(again, recovered);
+}
+
+TEST_F(WorldJournalTest, StopsAtBadChecksum) {
+    NpcWorld world;
+    WorldJournal journal(filename);
+    journal.open(world);
+    create(world, journal, NpcType::Toad, "A", 1, 1);
+    journal.commit();
+    NpcWorld good = world;
+    create(world, journal, NpcType::Knight, "B", 2, 2);
+    create(world, journal, NpcType::Knight, "C", 3, 3);
+    journal.commit();
+
+    std::string bytes = readJournal();
+    const size_t second = sizeof(JournalHeader) + sizeof(JournalRecord) + 1 + sizeof(uint32_t);
+    bytes[second + sizeof(JournalRecord)] ^= 0x20;  // имя "B" -> "b"
+    writeJournal(bytes);
+
+    NpcWorld recovered;
+    WorldJournal reopened(filename);
+    JournalRecovery recovery = reopened.open(recovered);
+    EXPECT_EQ(recovery.replayed, 1u);
+    EXPECT_GT(recovery.discardedBytes, 0u);
+    expectSameWorld(recovered, good);
+}
+
+TEST_F(WorldJournalTest, CompactionFoldsJournal) {
+    NpcWorld world;
+    WorldJournal journal(filename, 256);
+    journal.open(world);
+    for (int i = 0; i < 20; ++i) {
+        create(world, journal, NpcType::Dragon, "d" + std::to_string(i), i, i);
+    }
+    journal.commit();
+    EXPECT_TRUE(journal.needsCompaction());
+
+    journal.compact(world);
+    EXPECT_FALSE(journal.needsCompaction());
+    EXPECT_EQ(readJournal().size(), sizeof(JournalHeader));
+    EXPECT_FALSE(std::filesystem::exists(filename + ".tmp"));
+
+    world.kill(5);
+    journal.kill(5);
+    journal.commit();
+
+    NpcWorld recovered;
+    WorldJournal reopened(filename);
+    JournalRecovery recovery = reopened.open(recovered);
+    EXPECT_EQ(recovery.snapshotNpcs, 20u);
+    EXPECT_EQ(recovery.replayed, 1u);
+    expectSameWorld(recovered, world);
+}
+
+// сбой между заменой снимка и очисткой журнала: отметка Compact уже в журнале
+TEST_F(WorldJournalTest, IgnoresJournalOfOlderSnapshot) {
+    NpcWorld world;
+    WorldJournal journal(filename);
+    journal.open(world);
+    create(world, journal, NpcType::Toad, "A", 1, 1);
+    create(world, journal, NpcType::Knight, "B", 2, 2);
+    journal.commit();
+
+    // compact() падает после отметки - временный файл не создать,
+    // а снимок будто уже подменен
+    std::filesystem::create_directory(filename + ".tmp");
+    EXPECT_THROW(journal.compact(world), std::runtime_error);
+    std::filesystem::remove(filename + ".tmp");
+    WorldFile::saveBinary(world, filename);
+
+    NpcWorld recovered;
+    WorldJournal reopened(filename);
+    JournalRecovery recovery = reopened.open(recovered);
+    EXPECT_TRUE(recovery.staleJournal);
+    EXPECT_EQ(recovery.replayed, 0u);
+    expectSameWorld(recovered, world);
+    EXPECT_EQ(readJournal().size(), sizeof(JournalHeader));
+}
+
+TEST_F(WorldJournalTest, ReplaysTailAfterCompactMark) {
+    NpcWorld world;
+    WorldJournal journal(filename);
+    journal.open(world);
+    create(world, journal, NpcType::Toad, "A", 1, 1);
+    journal.commit();
+    std::filesystem::create_directory(filename + ".tmp");
+    EXPECT_THROW(journal.compact(world), std::runtime_error);
+    std::filesystem::remove(filename + ".tmp");
+    const NpcWorld marked = world;
+    // журнал продолжается после неудачного compact()
+    create(world, journal, NpcType::Dragon, "B", 2, 2);
+    world.kill(0);
+    journal.kill(0);
+    journal.commit();
+
+    // снимок не сменился - журнал целиком, отметка мир не меняет
+    {
+        NpcWorld recovered;
+        JournalRecovery recovery = WorldJournal(filename).open(recovered);
+        EXPECT_FALSE(recovery.staleJournal);
+        EXPECT_EQ(recovery.replayed, 4u);
+        expectSameWorld(recovered, world);
+    }
+    // снимок сменился - только то, что после отметки
+    WorldFile::saveBinary(marked, filename);
+    NpcWorld recovered;
+    JournalRecovery recovery = WorldJournal(filename).open(recovered);
+    EXPECT_TRUE(recovery.staleJournal);
+    EXPECT_EQ(recovery.replayed, 2u);
+    expectSameWorld(recovered, world);
+}
+
+// журнал без снимка хранит границы сам: мир открывается с ними, а не с границами world
+TEST_F(WorldJournalTest, JournalOnlyWorldKeepsBounds) {
+    const WorldBounds wide{-1000, -1000, 1000, 1000};
+    NpcWorld world(wide);
+    WorldJournal journal(filename);
+    journal.open(world);
+    create(world, journal, NpcType::Knight, "K", -900, 900);
+    journal.commit();
+    const size_t bytes = readJournal().size();
+
+    NpcWorld recovered;
+    JournalRecovery recovery = WorldJournal(filename).open(recovered);
+    EXPECT_FALSE(recovery.staleJournal);
+    EXPECT_EQ(recovery.replayed, 1u);
+    EXPECT_EQ(recovered.getBounds(), wide);
+    expectSameWorld(recovered, world);
+    EXPECT_EQ(readJournal().size(), bytes);
+}
+
+// снимок потерян после compact(): журнал не от пустого мира - ошибка, файл цел
+TEST_F(WorldJournalTest, RefusesJournalOfMissingSnapshot) {
+    NpcWorld world;
+    WorldJournal journal(filename);
+    journal.open(world);
+    create(world, journal, NpcType::Toad, "A", 1, 1);
+    journal.commit();
+    journal.compact(world);
+    create(world, journal, NpcType::Knight, "B", 2, 2);
+    journal.commit();
+    const std::string bytes = readJournal();
+    std::remove(filename.c_str());
+
+    NpcWorld recovered;
+    EXPECT_THROW(WorldJournal(filename).open(recovered), std::runtime_error);
+    EXPECT_EQ(readJournal(), bytes);
+}
+
+TEST_F(WorldJournalTest, Errors) {
+    WorldJournal journal(filename);
+    journal.create(NpcType::Toad, "A", 1, 1);
+    EXPECT_THROW(journal.commit(), std::runtime_error);
+
+    writeJournal(std::string(sizeof(JournalHeader), 'x'));
+    NpcWorld world;
+    EXPECT_THROW(journal.open(world), std::runtime_error);
+
+    // целая запись с индексом вне мира - порча, а не обрыв
+    writeJournal("");
+    journal.open(world);
+    journal.kill(7);
+    journal.commit();
+    WorldJournal reopened(filename);
+    EXPECT_THROW(reopened.open(world), std::runtime_error);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "npcWorld.h"
+#include "simulation.h"
+#include "worldSnapshot.h"
+
+class WorldSnapshotTest : public ::testing::Test {
+protected:
+    static NpcWorld randomWorld(size_t count, unsigned seed) {
+        NpcWorld world;
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> rnd_type(0, 2);
+        std::uniform_int_distribution<> rnd_coord(0, 500);
+        for (size_t i = 0; i < count; ++i) {
+            world.add(static_cast<NpcType>(rnd_type(gen)), "npc_" + std::to_string(i), rnd_coord(gen), rnd_coord(gen));
+        }
+        return world;
+    }
+
+    static void expectSame(const NpcWorld& actual, const NpcWorld& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        EXPECT_EQ(actual.getBounds(), expected.getBounds());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_EQ(actual.getX(i), expected.getX(i)) << i;
+            ASSERT_EQ(actual.getY(i), expected.getY(i)) << i;
+            ASSERT_EQ(actual.getType(i), expected.getType(i)) << i;
+            ASSERT_EQ(actual.getName(i), expected.getName(i)) << i;
+            ASSERT_EQ(actual.isAlive(i), expected.isAlive(i)) << i;
+        }
+    }
+};
+
+TEST_F(WorldSnapshotTest, ReadsLikeWorld) {
+    NpcWorld world = randomWorld(WorldSnapshot::CHUNK + 10, 1);
+    world.kill(5);
+    WorldSnapshot snapshot = world.snapshot();
+    ASSERT_EQ(snapshot.size(), world.size());
+    EXPECT_EQ(snapshot.chunkCount(), 2u);
+    for (size_t i : {size_t{0}, size_t{5}, WorldSnapshot::CHUNK - 1, WorldSnapshot::CHUNK + 9}) {
+        EXPECT_EQ(snapshot.getX(i), world.getX(i));
+        EXPECT_EQ(snapshot.getY(i), world.getY(i));
+        EXPECT_EQ(snapshot.getType(i), world.getType(i));
+        EXPECT_EQ(snapshot.getName(i), world.getName(i));
+        EXPECT_EQ(snapshot.isAlive(i), world.isAlive(i));
+    }
+    EXPECT_TRUE(WorldSnapshot().empty());
+}
+
+TEST_F(WorldSnapshotTest, WhatIfRangesMatchFreshCopies) {
+    NpcWorld world = randomWorld(10000, 2);
+    const NpcWorld original = world;
+    WorldSnapshot start = world.snapshot();
+    for (size_t range : {10, 25, 60}) {
+        NpcWorld fresh = original;
+        EXPECT_EQ(fight(world, range), fight(fresh, range));
+        expectSame(world, fresh);
+        world.restore(start);
+        expectSame(world, original);
+    }
+}
+
+TEST_F(WorldSnapshotTest, SharesUnchangedChunks) {
+    NpcWorld world = randomWorld(WorldSnapshot::CHUNK * 4, 3);
+    WorldSnapshot first = world.snapshot();
+    EXPECT_EQ(world.snapshot().changedBytes(first), 0u);
+
+    // один убитый - заново только флаги его куска
+    world.kill(WorldSnapshot::CHUNK * 2 + 7);
+    WorldSnapshot second = world.snapshot();
+    EXPECT_EQ(second.changedBytes(first), WorldSnapshot::CHUNK);
+    EXPECT_LT(second.changedBytes(first) * 100, first.memoryUsage());
+    EXPECT_TRUE(first.isAlive(WorldSnapshot::CHUNK * 2 + 7));
+    EXPECT_FALSE(second.isAlive(WorldSnapshot::CHUNK * 2 + 7));
+
+    // сдвиг - только позиции куска
+    world.move(1, 3, 4);
+    WorldSnapshot third = world.snapshot();
+    EXPECT_EQ(third.changedBytes(second), WorldSnapshot::CHUNK * 2 * sizeof(int));
+}
+
+TEST_F(WorldSnapshotTest, RestoresAnySnapshot) {
+    NpcWorld world = randomWorld(9000, 4);
+    const NpcWorld original = world;
+    WorldSnapshot start = world.snapshot();
+
+    fight(world, 30);
+    world.move(0, 1, 1);
+    const NpcWorld afterFight = world;
+    WorldSnapshot middle = world.snapshot();
+
+    world.add(NpcType::Dragon, "Late_Dragon_with_a_long_name", 10, 10);
+    world.removeDead();
+    world.setBounds(WorldBounds{0, 0, 1000, 1000});
+
+    world.restore(middle);
+    expectSame(world, afterFight);
+    world.restore(start);
+    expectSame(world, original);
+    world.restore(middle);
+    expectSame(world, afterFight);
+}
+
+TEST_F(WorldSnapshotTest, AddAfterSnapshotIsRolledBack) {
+    NpcWorld world = randomWorld(WorldSnapshot::CHUNK - 1, 5);
+    const NpcWorld original = world;
+    WorldSnapshot start = world.snapshot();
+    for (int i = 0; i < 5; ++i) world.add(NpcType::Knight, "extra_" + std::to_string(i), i, i);
+    WorldSnapshot grown = world.snapshot();
+    EXPECT_EQ(grown.chunkCount(), 2u);
+    world.restore(start);
+    expectSame(world, original);
+
+    world.add(NpcType::Toad, "another", 1, 2);
+    EXPECT_EQ(world.getName(world.size() - 1), "another");
+    world.restore(grown);
+    EXPECT_EQ(world.getName(world.size() - 1), "extra_4");
+}
+
+TEST_F(WorldSnapshotTest, ForkFromSnapshot) {
+    NpcWorld world = randomWorld(5000, 6);
+    WorldSnapshot start = world.snapshot();
+    NpcWorld fork = NpcWorld::fromSnapshot(start);
+    expectSame(fork, world);
+    fight(fork, 40);
+    // оригинал и снимок не тронуты
+    EXPECT_EQ(world.aliveCount(), world.size());
+    EXPECT_EQ(NpcWorld::fromSnapshot(start).aliveCount(), world.size());
+    // после боя у форка свои только флаги жизни
+    size_t changed = fork.snapshot().changedBytes(start);
+    EXPECT_GT(changed, 0u);
+    EXPECT_LE(changed, world.size());
+}
+
+TEST_F(WorldSnapshotTest, SimulationMovesAreCaptured) {
+    NpcWorld world = randomWorld(3000, 7);
+    WorldSnapshot start = world.snapshot();
+    const NpcWorld original = world;
+    SimulationOptions options;
+    options.range = 5;
+    options.threads = 1;
+    Simulation simulation(world, options);
+    simulation.run(5);
+    NpcWorld moved = world;
+    WorldSnapshot after = world.snapshot();
+    world.restore(start);
+    expectSame(world, original);
+    world.restore(after);
+    expectSame(world, moved);
+}
\ No newline at end of file